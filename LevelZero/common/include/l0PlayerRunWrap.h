@@ -145,6 +145,45 @@ inline void HandleDumpSpv(const ze_module_desc_t* desc) {
                       static_cast<unsigned int>(desc->inputSize));
   }
 }
+
+ze_result_t CreateModule(const ze_context_handle_t& hContext,
+                         const ze_device_handle_t& hDevice,
+                         const ze_module_desc_t* desc,
+                         ze_module_handle_t* phModule,
+                         ze_module_build_log_handle_t* phBuildLog) {
+  auto& moduleCache = SD().moduleCache;
+  const auto cacheKey = moduleCache.GetKey(hDevice, desc);
+  if (cacheKey.empty()) {
+    return drv.zeModuleCreate(hContext, hDevice, desc, phModule, phBuildLog);
+  }
+
+  std::vector<uint8_t> binary;
+  if (moduleCache.Load(cacheKey, binary)) {
+    auto nativeDesc = *desc;
+    nativeDesc.format = ZE_MODULE_FORMAT_NATIVE;
+    nativeDesc.inputSize = binary.size();
+    nativeDesc.pInputModule = binary.data();
+    auto buildLogHandle = *phBuildLog;
+    const auto result =
+        drv.zeModuleCreate(hContext, hDevice, &nativeDesc, phModule, &buildLogHandle);
+    if (result == ZE_RESULT_SUCCESS) {
+      *phBuildLog = buildLogHandle;
+      return result;
+    }
+    LOG_WARNING << "Cached native module binary was rejected by the driver, building the module "
+                   "from its original input.";
+    if (buildLogHandle != nullptr && buildLogHandle != *phBuildLog) {
+      drv.inject.zeModuleBuildLogDestroy(buildLogHandle);
+    }
+    moduleCache.Reject(cacheKey);
+  }
+
+  const auto result = drv.zeModuleCreate(hContext, hDevice, desc, phModule, phBuildLog);
+  if (result == ZE_RESULT_SUCCESS) {
+    moduleCache.Store(cacheKey, *phModule);
+  }
+  return result;
+}
 } // namespace
 
 inline void zeCommandListAppendLaunchKernel_RUNWRAP(Cze_result_t& _return_value,
@@ -285,8 +324,7 @@ inline void zeModuleCreate_RUNWRAP(Cze_result_t& _return_value,
   if (*_phBuildLog != nullptr && **_phBuildLog != nullptr) {
     buildLogHandle = **_phBuildLog;
   }
-  _return_value.Value() =
-      drv.zeModuleCreate(*_hContext, *_hDevice, *_desc, *_phModule, &buildLogHandle);
+  _return_value.Value() = CreateModule(*_hContext, *_hDevice, *_desc, *_phModule, &buildLogHandle);
   zeModuleCreate_SD(nullptr, *_return_value, *_hContext, *_hDevice, *_desc, *_phModule,
                     &buildLogHandle);
   HandleDumpSpv(*_desc);
@@ -320,8 +358,7 @@ inline void zeModuleCreate_V1_RUNWRAP(CFunction* token,
   if (*_phBuildLog != nullptr && **_phBuildLog != nullptr) {
     buildLogHandle = **_phBuildLog;
   }
-  _return_value.Value() =
-      drv.zeModuleCreate(*_hContext, *_hDevice, *_desc, *_phModule, &buildLogHandle);
+  _return_value.Value() = CreateModule(*_hContext, *_hDevice, *_desc, *_phModule, &buildLogHandle);
   zeModuleCreate_SD(token, *_return_value, *_hContext, *_hDevice, *_desc, *_phModule,
                     &buildLogHandle);
   if (_return_value.Value() == ZE_RESULT_ERROR_MODULE_BUILD_FAILURE && buildLogHandle != nullptr) {
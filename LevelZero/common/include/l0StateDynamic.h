@@ -117,6 +117,7 @@ struct CAllocState : public CState {
 
   bool modified = false;
   uint32_t scannedTimes = 0U;
+  bool indirectPointersScanned = false;
   struct ResidencyInfo {
     ResidencyInfo() = default;
     ResidencyInfo(ze_context_handle_t hContext,
@@ -599,6 +600,31 @@ public:
   void RemoveUseOfEvent(const ze_event_handle_t& hEvent);
 };
 
+/**
+ * @brief On-disk cache of native module binaries
+ *
+ * Native binaries of modules built from SPIR-V are stored in files named after the hash
+ * of the module input, build flags, specialization constants and driver and device
+ * identity, so replay can skip the compilation on the next run.
+ */
+class ModuleCache {
+  uint64_t hits = 0U;
+  uint64_t misses = 0U;
+  uint64_t rejected = 0U;
+  uint64_t stored = 0U;
+  std::filesystem::path GetPath(const std::string& key) const;
+
+public:
+  // Returns the cache key of the module, empty if the cache is disabled or the module
+  // can't be cached.
+  std::string GetKey(const ze_device_handle_t& hDevice, const ze_module_desc_t* desc) const;
+  bool Load(const std::string& key, std::vector<uint8_t>& binary);
+  void Store(const std::string& key, const ze_module_handle_t& hModule);
+  // Removes the entry after the driver refused to create a module from it.
+  void Reject(const std::string& key);
+  void LogStatistics() const;
+};
+
 class CStateDynamic {
 private:
   CStateDynamic() = default;
@@ -622,6 +648,7 @@ public:
   LayoutBuilder layoutBuilder;
   GlobalSubmissionTracker gst;
   DeallocationHandler deallocationHandler;
+  ModuleCache moduleCache;
   std::unordered_set<ze_module_handle_t> scanningGlobalPointersMode;
   bool nomenclatureCounting = true;
   bool stateRestoreFinished = false;
@@ -17,6 +17,11 @@
 #include "l0Header.h"
 #include "l0Tools.h"
 #include "l0Arguments.h"
+#include "tools.h"
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
 #include <string>
 
 #ifdef WITH_OCLOC
@@ -43,6 +48,7 @@ CStateDynamic* CStateDynamic::InstancePtr() {
 CStateDynamic::~CStateDynamic() {
   try {
     layoutBuilder.SaveLayoutToJsonFile();
+    moduleCache.LogStatistics();
   } catch (...) {
     topmost_exception_handler("CStateDynamic::~CStateDynamic");
   }
@@ -904,5 +910,119 @@ void DeallocationHandler::RemoveUseOfEvent(const ze_event_handle_t& hEvent) {
 void DeallocationHandler::DeallocationInfo::Deallocate() {
   usmPtrResource->FreeHostMemory();
 }
+
+std::filesystem::path ModuleCache::GetPath(const std::string& key) const {
+  return Configurator::Get().levelzero.player.moduleCacheDir / (key + ".bin");
+}
+
+std::string ModuleCache::GetKey(const ze_device_handle_t& hDevice,
+                                const ze_module_desc_t* desc) const {
+  if (!Configurator::IsPlayer() || Configurator::Get().levelzero.player.moduleCacheDir.empty()) {
+    return std::string();
+  }
+  // Linked module programs and modules built from native binaries are not cached.
+  if (desc == nullptr || desc->format != ZE_MODULE_FORMAT_IL_SPIRV || desc->pNext != nullptr ||
+      desc->pInputModule == nullptr || desc->inputSize == 0U ||
+      !SD().Exists<CDeviceState>(hDevice)) {
+    return std::string();
+  }
+
+  ze_device_properties_t deviceProperties = {};
+  deviceProperties.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
+  ze_driver_properties_t driverProperties = {};
+  driverProperties.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+  const auto& hDriver = SD().Get<CDeviceState>(hDevice, EXCEPTION_MESSAGE).hDriver;
+  if (drv.inject.zeDeviceGetProperties(hDevice, &deviceProperties) != ZE_RESULT_SUCCESS ||
+      drv.inject.zeDriverGetProperties(hDriver, &driverProperties) != ZE_RESULT_SUCCESS) {
+    return std::string();
+  }
+
+  CHashStream hash(THashType::XXH3_128);
+  hash.Update(desc->pInputModule, desc->inputSize);
+  const std::string buildFlags = desc->pBuildFlags != nullptr ? desc->pBuildFlags : "";
+  const uint64_t buildFlagsSize = buildFlags.size();
+  hash.Update(&buildFlagsSize, sizeof(buildFlagsSize));
+  hash.Update(buildFlags.data(), buildFlags.size());
+  const auto* constants = desc->pConstants;
+  const uint32_t numConstants = constants != nullptr ? constants->numConstants : 0U;
+  hash.Update(&numConstants, sizeof(numConstants));
+  for (auto i = 0U; i < numConstants; i++) {
+    // Specialization constant values are recorded as 64-bit values.
+    hash.Update(&constants->pConstantIds[i], sizeof(uint32_t));
+    hash.Update(constants->pConstantValues[i], sizeof(uint64_t));
+  }
+  hash.Update(deviceProperties.uuid.id, sizeof(deviceProperties.uuid.id));
+  hash.Update(driverProperties.uuid.id, sizeof(driverProperties.uuid.id));
+  hash.Update(&driverProperties.driverVersion, sizeof(driverProperties.driverVersion));
+
+  const auto digest = hash.Digest128();
+  std::stringstream key;
+  key << std::hex << std::setfill('0') << std::setw(16) << digest.high << std::setw(16)
+      << digest.low;
+  return key.str();
+}
+
+bool ModuleCache::Load(const std::string& key, std::vector<uint8_t>& binary) {
+  std::ifstream file(GetPath(key), std::ios::binary);
+  if (file) {
+    binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  if (binary.empty()) {
+    misses++;
+    return false;
+  }
+  hits++;
+  return true;
+}
+
+void ModuleCache::Store(const std::string& key, const ze_module_handle_t& hModule) {
+  size_t size = 0U;
+  if (drv.inject.zeModuleGetNativeBinary(hModule, &size, nullptr) != ZE_RESULT_SUCCESS ||
+      size == 0U) {
+    return;
+  }
+  std::vector<uint8_t> binary(size);
+  if (drv.inject.zeModuleGetNativeBinary(hModule, &size, binary.data()) != ZE_RESULT_SUCCESS) {
+    return;
+  }
+
+  // Entry is written under a unique temporary name and renamed, so replays running at
+  // the same time never read a partially written binary.
+  const auto path = GetPath(key);
+  auto tmpPath = path;
+  tmpPath += "." + std::to_string(std::random_device()()) + ".tmp";
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    if (!file) {
+      LOG_WARNING << "Couldn't write module cache entry: " << tmpPath;
+      file.close();
+      std::filesystem::remove(tmpPath, ec);
+      return;
+    }
+  }
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmpPath, ec);
+    return;
+  }
+  stored++;
+}
+
+void ModuleCache::Reject(const std::string& key) {
+  rejected++;
+  std::error_code ec;
+  std::filesystem::remove(GetPath(key), ec);
+}
+
+void ModuleCache::LogStatistics() const {
+  if (hits + misses == 0U) {
+    return;
+  }
+  LOG_INFO << "Module cache: " << hits << " hits, " << misses << " misses, " << rejected
+           << " rejected, " << stored << " stored";
+}
 } // namespace l0
 } // namespace gits
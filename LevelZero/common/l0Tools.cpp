@@ -356,12 +356,19 @@ void DumpReadyArguments(std::vector<CKernelArgumentDump>& readyArgVector,
         }
       }
     }
-    if (!argState.buffer.empty()) {
-      SaveBuffer(path, name, argState.buffer);
-    }
-    if (argState.argType == KernelArgType::image && captureImages) {
-      SaveImage(path, argState.buffer.data(), argState.imageDesc, name);
+    if (argState.buffer.empty()) {
+      continue;
     }
+    // Conversion and file output run on the dump workers, on a snapshot of the read back data.
+    const bool saveImage = argState.argType == KernelArgType::image && captureImages;
+    const auto imageDesc = argState.imageDesc;
+    CGits::Instance().DumpPipeline().Schedule(
+        argState.buffer, [path, name, saveImage, imageDesc](const std::vector<char>& snapshot) {
+          SaveBuffer(path, name, snapshot);
+          if (saveImage) {
+            SaveImage(path, snapshot.data(), imageDesc, name);
+          }
+        });
   }
 }
 
@@ -0,0 +1,87 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+* @file   l0PointerScanner.h
+*
+* @brief Scanning of USM allocations for pointers to other allocations (indirect access).
+*/
+
+#pragma once
+
+#include "l0Drivers.h"
+#include "l0Header.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace gits {
+namespace l0 {
+class CStateDynamic;
+struct CAllocState;
+
+/**
+  * Sorted address ranges of all tracked allocations. Answers whether a value read
+  * from memory points into any of them without walking the whole state map.
+  */
+class CAllocationIndex {
+public:
+  explicit CAllocationIndex(const CStateDynamic& sd);
+  bool Contains(uintptr_t value) const;
+  uintptr_t LowestAddress() const {
+    return _lowest;
+  }
+  uintptr_t HighestAddress() const {
+    return _highest;
+  }
+
+private:
+  std::vector<uintptr_t> _begins;
+  // _maxEnds[i] is the highest end address of allocations _begins[0..i], so that
+  // overlapping allocations are handled correctly.
+  std::vector<uintptr_t> _maxEnds;
+  uintptr_t _lowest = UINTPTR_MAX;
+  uintptr_t _highest = 0U;
+};
+
+/**
+  * Returns offsets of 8-byte values in data[begin, end) pointing into an indexed
+  * allocation. Values may be unaligned; a found pointer is never overlapped by the
+  * next one.
+  */
+std::vector<size_t> ScanForPointers(
+    const char* data, size_t size, size_t begin, size_t end, const CAllocationIndex& index);
+
+struct CPointerScanRequest {
+  void* ptr = nullptr;
+  const CAllocState* allocState = nullptr;
+  ze_command_list_handle_t hCommandList = nullptr;
+  // Byte ranges to scan, empty means the whole allocation.
+  std::vector<std::pair<size_t, size_t>> ranges;
+};
+
+/**
+  * Scans the requested allocations on a pool of at most hardware_concurrency threads.
+  * Device allocations are copied to the host through the request command list first,
+  * those copies are serialized. Returns found pointer offsets per allocation.
+  */
+std::map<void*, std::vector<size_t>> ScanAllocationsForPointers(
+    const std::vector<CPointerScanRequest>& requests,
+    const CAllocationIndex& index,
+    const CDriver& driver);
+
+/**
+  * Returns the ranges of the allocation covered by pages reported as touched by
+  * the memory sniffer, extended so that pointers crossing page boundaries are found.
+  */
+std::vector<std::pair<size_t, size_t>> GetTouchedRanges(const void* ptr,
+                                                        const CAllocState& allocState);
+} // namespace l0
+} // namespace gits
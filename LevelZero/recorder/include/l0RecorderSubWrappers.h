@@ -27,10 +27,10 @@
 #include "l0Tools.h"
 #include "recorder.h"
 #include "l0StateRestore.h"
+#include "l0PointerScanner.h"
 #include <cstdint>
 #include <string>
 #include <vector>
-#include <future>
 
 namespace gits {
 namespace l0 {
@@ -263,49 +263,6 @@ bool ExistsAsKernelArgument(
   return false;
 }
 
-std::vector<size_t> AsyncBruteForce(const CStateDynamic* sd,
-                                    const void* ptr,
-                                    const CAllocState* allocState,
-                                    const CDriver* driver,
-                                    const ze_command_list_handle_t* immediateSyncCommandListHandle,
-                                    uintptr_t smallestPointerValue,
-                                    uintptr_t highestPointerValue) {
-  std::vector<size_t> offsets;
-  uintptr_t potentialPointer = 0U;
-  size_t i = 0U;
-  std::vector<char> buffer;
-  const char* pointerToData = nullptr;
-  if (allocState->memType == UnifiedMemoryType::device) {
-    buffer.resize(allocState->size);
-    const auto ret = driver->inject.zeCommandListAppendMemoryCopy(
-        *immediateSyncCommandListHandle, buffer.data(), ptr, buffer.size(), nullptr, 0, nullptr);
-    if (ret != ZE_RESULT_SUCCESS) {
-      throw EOperationFailed(EXCEPTION_MESSAGE);
-    }
-    pointerToData = buffer.data();
-  } else {
-    pointerToData = reinterpret_cast<const char*>(ptr);
-  }
-  while (allocState->size > i && allocState->size - i + 1 > sizeof(void*)) {
-    std::memcpy(&potentialPointer, pointerToData + i, sizeof(uintptr_t));
-    if (potentialPointer < smallestPointerValue || potentialPointer > highestPointerValue) {
-      i++;
-      continue;
-    }
-    const auto allocInfo = GetAllocFromRegion(reinterpret_cast<void*>(potentialPointer), *sd);
-    if (allocInfo.first != nullptr) {
-      offsets.push_back(i);
-      LOG_TRACEV << "Scanning pointer: " << ToStringHelper(pointerToData)
-                 << " -> Found pointer on offset " << std::to_string(i)
-                 << " pointer: " << ToStringHelper(allocInfo.first)
-                 << ", memory view: " << ToStringHelper(potentialPointer);
-      i += sizeof(void*) - 1;
-    }
-    i++;
-  }
-  return offsets;
-}
-
 void BruteForceScanForIndirectAccess(
     CRecorder& recorder,
     CStateDynamic& sd,
@@ -317,20 +274,8 @@ void BruteForceScanForIndirectAccess(
     return;
   }
   const auto& cfg = Configurator::Get();
-  uintptr_t smallestPointerValue = UINTPTR_MAX;
-  uintptr_t highestPointerValue = 0;
-  for (const auto& allocState : sd.Map<CAllocState>()) {
-    const auto pointerValueMin = reinterpret_cast<uintptr_t>(allocState.first);
-    const auto pointerValueMax =
-        reinterpret_cast<uintptr_t>(GetOffsetPointer(allocState.first, allocState.second->size));
-    if (pointerValueMin < smallestPointerValue) {
-      smallestPointerValue = pointerValueMin;
-    }
-    if (pointerValueMax > highestPointerValue) {
-      highestPointerValue = pointerValueMax;
-    }
-  }
-  std::map<void*, std::future<std::vector<size_t>>> futures;
+  const CAllocationIndex allocationIndex(sd);
+  std::vector<CPointerScanRequest> requests;
   for (const auto& allocState : sd.Map<CAllocState>()) {
     if (!IsMemoryTypeIncluded(cfg.levelzero.recorder.bruteForceScanForIndirectPointers.memoryType,
                               allocState.second->memType)) {
@@ -343,26 +288,47 @@ void BruteForceScanForIndirectAccess(
     if ((static_cast<unsigned>(allocState.second->memType) & indirectTypes && modifiedAllocation) ||
         allocState.second->residencyInfo ||
         ExistsAsKernelArgument(allocState.first, executedKernels)) {
+      CPointerScanRequest request;
+      request.ptr = allocState.first;
+      request.allocState = allocState.second.get();
+      if (allocState.second->indirectPointersScanned && !allocState.second->modified &&
+          allocState.second->sniffedRegionHandle != nullptr &&
+          *allocState.second->sniffedRegionHandle != nullptr &&
+          (**allocState.second->sniffedRegionHandle).Protected()) {
+        // CPU writes to a protected region are tracked, only touched pages may hold new
+        // pointers. GPU writes are not visible to the sniffer, so modified allocations are
+        // scanned whole.
+        request.ranges = GetTouchedRanges(allocState.first, *allocState.second);
+        if (request.ranges.empty()) {
+          continue;
+        }
+      }
       if (BruteForceScanIterations(cfg)) {
         if (allocState.second->scannedTimes >= BruteForceScanIterations(cfg)) {
           continue;
         }
         allocState.second->scannedTimes++;
       }
-      auto immediateCmdList = GetCommandListImmediate(sd, driver, allocState.second->hContext);
-      futures[allocState.first] = std::async(
-          std::launch::async, AsyncBruteForce, &sd, allocState.first, allocState.second.get(),
-          &driver, &immediateCmdList, smallestPointerValue, highestPointerValue);
+      if (allocState.second->memType == UnifiedMemoryType::device) {
+        request.hCommandList = GetCommandListImmediate(sd, driver, allocState.second->hContext);
+      }
+      allocState.second->indirectPointersScanned = true;
+      requests.push_back(std::move(request));
     }
   }
-  for (auto& futureInfo : futures) {
-    std::vector<size_t> offsets = futureInfo.second.get();
-    auto* ptr = futureInfo.first;
-    if (!offsets.empty()) {
-      drv.zeGitsIndirectAllocationOffsets(ptr, offsets.size(), offsets.data());
-      recorder.Schedule(new CzeGitsIndirectAllocationOffsets(ptr, offsets.size(), offsets.data()));
-      zeGitsIndirectAllocationOffsets_SD(ptr, offsets.size(), offsets.data());
+  if (requests.empty()) {
+    return;
+  }
+  for (auto& found : ScanAllocationsForPointers(requests, allocationIndex, driver)) {
+    auto* ptr = found.first;
+    auto& offsets = found.second;
+    for (const auto offset : offsets) {
+      LOG_TRACEV << "Scanning pointer: " << ToStringHelper(ptr) << " -> Found pointer on offset "
+                 << std::to_string(offset);
     }
+    drv.zeGitsIndirectAllocationOffsets(ptr, offsets.size(), offsets.data());
+    recorder.Schedule(new CzeGitsIndirectAllocationOffsets(ptr, offsets.size(), offsets.data()));
+    zeGitsIndirectAllocationOffsets_SD(ptr, offsets.size(), offsets.data());
   }
 }
 
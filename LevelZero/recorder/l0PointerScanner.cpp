@@ -0,0 +1,226 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+* @file   l0PointerScanner.cpp
+*
+* @brief Scanning of USM allocations for pointers to other allocations (indirect access).
+*/
+
+#include "l0PointerScanner.h"
+#include "l0StateDynamic.h"
+#include "l0Tools.h"
+#include "exception.h"
+#include "MemorySniffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+#include <nmmintrin.h>
+#endif
+
+namespace gits {
+namespace l0 {
+CAllocationIndex::CAllocationIndex(const CStateDynamic& sd) {
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  ranges.reserve(sd.Map<CAllocState>().size());
+  for (const auto& allocState : sd.Map<CAllocState>()) {
+    const auto begin = reinterpret_cast<uintptr_t>(allocState.first);
+    ranges.emplace_back(begin, begin + static_cast<uintptr_t>(allocState.second->size));
+  }
+  std::sort(ranges.begin(), ranges.end());
+
+  _begins.reserve(ranges.size());
+  _maxEnds.reserve(ranges.size());
+  uintptr_t maxEnd = 0U;
+  for (const auto& range : ranges) {
+    maxEnd = std::max(maxEnd, range.second);
+    _begins.push_back(range.first);
+    _maxEnds.push_back(maxEnd);
+    _lowest = std::min(_lowest, range.first);
+    _highest = std::max(_highest, range.second);
+  }
+}
+
+bool CAllocationIndex::Contains(uintptr_t value) const {
+  // Same rules as GetAllocFromRegion: allocation start or strictly inside of it.
+  auto it = std::upper_bound(_begins.begin(), _begins.end(), value);
+  if (it == _begins.begin()) {
+    return false;
+  }
+  const auto idx = std::distance(_begins.begin(), it) - 1;
+  return _begins[idx] == value || value < _maxEnds[idx];
+}
+
+std::vector<size_t> ScanForPointers(
+    const char* data, size_t size, size_t begin, size_t end, const CAllocationIndex& index) {
+  std::vector<size_t> offsets;
+  if (size < sizeof(uintptr_t)) {
+    return offsets;
+  }
+  // Last offset an 8-byte value can be read from is size - 8.
+  end = std::min(end, size - sizeof(uintptr_t) + 1);
+  const uintptr_t lowest = index.LowestAddress();
+  const uintptr_t highest = index.HighestAddress();
+  size_t next = begin;
+  auto check = [&](size_t offset) {
+    if (offset < next) {
+      return;
+    }
+    uintptr_t value = 0U;
+    std::memcpy(&value, data + offset, sizeof(value));
+    if (value >= lowest && value <= highest && index.Contains(value)) {
+      offsets.push_back(offset);
+      next = offset + sizeof(uintptr_t);
+    }
+  };
+
+  size_t i = begin;
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+  // Range prefilter on 16 offsets at a time: each unaligned load at i + k provides the
+  // values at offsets i + k and i + k + 8. Unsigned comparison is done on signed lanes
+  // with flipped sign bits.
+  const __m128i signBit = _mm_set1_epi64x(INT64_MIN);
+  const __m128i low = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(lowest)), signBit);
+  const __m128i high = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(highest)), signBit);
+  for (; i + 16 <= end; i += 16) {
+    unsigned mask = 0U;
+    for (unsigned k = 0U; k < 8U; ++k) {
+      const __m128i values = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + k)), signBit);
+      const __m128i outside =
+          _mm_or_si128(_mm_cmpgt_epi64(low, values), _mm_cmpgt_epi64(values, high));
+      const unsigned inside = ~_mm_movemask_pd(_mm_castsi128_pd(outside)) & 3U;
+      mask |= ((inside & 1U) << k) | ((inside >> 1U) << (k + 8U));
+    }
+    while (mask != 0U) {
+      unsigned bit = 0U;
+      while (((mask >> bit) & 1U) == 0U) {
+        ++bit;
+      }
+      mask &= mask - 1U;
+      check(i + bit);
+    }
+  }
+#endif
+  for (; i < end; ++i) {
+    check(i);
+  }
+  return offsets;
+}
+
+namespace {
+std::vector<size_t> ScanAllocation(const CPointerScanRequest& request,
+                                   const CAllocationIndex& index,
+                                   const CDriver& driver,
+                                   std::mutex& copyMutex) {
+  const auto size = request.allocState->size;
+  std::vector<char> buffer;
+  const char* data = nullptr;
+  if (request.allocState->memType == UnifiedMemoryType::device) {
+    buffer.resize(size);
+    std::lock_guard<std::mutex> lock(copyMutex);
+    const auto ret = driver.inject.zeCommandListAppendMemoryCopy(
+        request.hCommandList, buffer.data(), request.ptr, size, nullptr, 0, nullptr);
+    if (ret != ZE_RESULT_SUCCESS) {
+      throw EOperationFailed(EXCEPTION_MESSAGE);
+    }
+    data = buffer.data();
+  } else {
+    data = static_cast<const char*>(request.ptr);
+  }
+
+  if (request.ranges.empty()) {
+    return ScanForPointers(data, size, 0U, size, index);
+  }
+  std::vector<size_t> offsets;
+  for (const auto& range : request.ranges) {
+    const auto found = ScanForPointers(data, size, range.first, range.second, index);
+    offsets.insert(offsets.end(), found.begin(), found.end());
+  }
+  return offsets;
+}
+} // namespace
+
+std::map<void*, std::vector<size_t>> ScanAllocationsForPointers(
+    const std::vector<CPointerScanRequest>& requests,
+    const CAllocationIndex& index,
+    const CDriver& driver) {
+  std::vector<std::vector<size_t>> results(requests.size());
+  std::atomic<size_t> nextRequest(0U);
+  std::mutex copyMutex;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto worker = [&] {
+    try {
+      for (size_t i = nextRequest++; i < requests.size(); i = nextRequest++) {
+        results[i] = ScanAllocation(requests[i], index, driver, copyMutex);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      error = std::current_exception();
+      nextRequest = requests.size();
+    }
+  };
+
+  const size_t threadCount =
+      std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), requests.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 1U; i < threadCount; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  std::map<void*, std::vector<size_t>> offsets;
+  for (size_t i = 0U; i < requests.size(); ++i) {
+    if (!results[i].empty()) {
+      offsets[requests[i].ptr] = std::move(results[i]);
+    }
+  }
+  return offsets;
+}
+
+std::vector<std::pair<size_t, size_t>> GetTouchedRanges(const void* ptr,
+                                                        const CAllocState& allocState) {
+  std::vector<std::pair<size_t, size_t>> ranges;
+  if (allocState.sniffedRegionHandle == nullptr || *allocState.sniffedRegionHandle == nullptr) {
+    return ranges;
+  }
+  const auto pageSize = static_cast<uintptr_t>(GetVirtualMemoryPageSize());
+  const auto begin = reinterpret_cast<uintptr_t>(ptr);
+  const auto end = begin + allocState.size;
+  for (const auto* page : (**allocState.sniffedRegionHandle).GetTouchedPages()) {
+    const auto pageBegin = std::max(reinterpret_cast<uintptr_t>(page), begin);
+    const auto pageEnd = std::min(reinterpret_cast<uintptr_t>(page) + pageSize, end);
+    if (pageBegin >= pageEnd) {
+      continue;
+    }
+    // Pointers starting up to 7 bytes before the page still have bytes inside of it.
+    const auto rangeBegin =
+        static_cast<size_t>(pageBegin - begin) - std::min<size_t>(pageBegin - begin, 7U);
+    const auto rangeEnd = static_cast<size_t>(pageEnd - begin);
+    if (!ranges.empty() && ranges.back().second >= rangeBegin) {
+      ranges.back().second = std::max(ranges.back().second, rangeEnd);
+    } else {
+      ranges.emplace_back(rangeBegin, rangeEnd);
+    }
+  }
+  return ranges;
+}
+} // namespace l0
+} // namespace gits
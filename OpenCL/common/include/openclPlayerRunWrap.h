@@ -17,6 +17,9 @@
 
 #include "log.h"
 
+#include <functional>
+#include <set>
+
 namespace gits {
 namespace OpenCL {
 namespace {
@@ -78,76 +81,163 @@ cl_event GetGitsUserEvent(const cl_context& context) {
   clRetainEvent_SD(err, event);
   return event;
 }
-void TranslatePointerOffsets(void* bufferPtr, const std::map<size_t, bool>& offsetMap) {
-  for (const auto& offsetInfo : offsetMap) {
-    void* ptrLocation =
-        reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(bufferPtr) + offsetInfo.first);
-    void* ptrToFetch = nullptr;
-    std::memcpy(&ptrToFetch, ptrLocation, sizeof(void*));
-    const auto allocInfo = GetOriginalMappedPtrFromRegion(ptrToFetch);
-    ptrToFetch = GetOffsetPointer(allocInfo.first, allocInfo.second);
-    if (ptrToFetch == nullptr) {
-      LOG_WARNING << "Couldn't translate pointer inside pAlloc: " << bufferPtr
-                  << " offset: " << offsetInfo.first;
-    }
-    std::memcpy(ptrLocation, &ptrToFetch, sizeof(void*));
+void TranslatePointerSlot(char* slot, const void* allocPtr, size_t offset) {
+  void* ptrToFetch = nullptr;
+  std::memcpy(&ptrToFetch, slot, sizeof(void*));
+  const auto allocInfo = GetOriginalMappedPtrFromRegion(ptrToFetch);
+  ptrToFetch = GetOffsetPointer(allocInfo.first, allocInfo.second);
+  if (ptrToFetch == nullptr) {
+    LOG_WARNING << "Couldn't translate pointer inside pAlloc: " << allocPtr
+                << " offset: " << offset;
+  }
+  std::memcpy(slot, &ptrToFetch, sizeof(void*));
+}
+
+// Translation of pointers stored at offsets not yet translated in an allocation which is not
+// accessible from the host.
+struct CPointerPatchJob {
+  cl_command_queue commandQueue = nullptr;
+  char* allocPtr = nullptr;
+  bool isSvm = false;
+  std::vector<size_t> offsets;
+  // Ranges [first, second) of the allocation read to the staging buffer, dirty offsets
+  // close to each other share a range.
+  std::vector<std::pair<size_t, size_t>> ranges;
+  size_t stagingOffset = 0;
+};
+
+void EnqueuePatchCopy(const CPointerPatchJob& job, void* dst, const void* src, size_t size) {
+  const auto ret =
+      job.isSvm ? drvOcl.clEnqueueSVMMemcpy(job.commandQueue, CL_NON_BLOCKING, dst, src, size, 0,
+                                            nullptr, nullptr)
+                : drvOcl.clEnqueueMemcpyINTEL(job.commandQueue, CL_NON_BLOCKING, dst, src, size, 0,
+                                              nullptr, nullptr);
+  if (ret != CL_SUCCESS) {
+    LOG_ERROR << "Injected copy for pointer translation failed: " << ret;
+    throw std::runtime_error(EXCEPTION_MESSAGE);
   }
 }
-void TranslatePointers() {
-  for (auto& allocState : SD()._usmAllocStates) {
-    auto& indirectOffsets = allocState.second->indirectPointersOffsets;
-    if (indirectOffsets.empty() ||
-        indirectOffsets.end() ==
-            std::find_if(indirectOffsets.begin(), indirectOffsets.end(),
-                         [](const std::pair<size_t, bool>& i) { return !i.second; })) {
+
+void FinishQueues(const std::vector<CPointerPatchJob>& jobs) {
+  std::set<cl_command_queue> queues;
+  for (const auto& job : jobs) {
+    queues.insert(job.commandQueue);
+  }
+  for (const auto& queue : queues) {
+    drvOcl.clFinish(queue);
+  }
+}
+
+// Collects offsets not translated yet. Host accessible allocations are patched in place,
+// others are added to device jobs.
+template <class T>
+void CollectPointerPatches(T& allocState,
+                           void* allocPtr,
+                           bool hostAccessible,
+                           const std::function<cl_command_queue()>& getQueue,
+                           bool isSvm,
+                           std::vector<CPointerPatchJob>& jobs) {
+  // Dirty offsets this close to each other are read with a single copy.
+  const size_t maxGap = 256U;
+  CPointerPatchJob job;
+  for (auto& indirectPair : allocState.indirectPointersOffsets) {
+    if (indirectPair.second) {
       continue;
     }
-    if (allocState.second->type == UnifiedMemoryType::device) {
-      auto cq = GetCommandQueue(allocState.second->context, allocState.second->device);
-      const auto size = allocState.second->size;
-      auto* tmpBuffer = new char[size];
-      drvOcl.clEnqueueMemcpyINTEL(cq, CL_BLOCKING, tmpBuffer, allocState.first, size, 0, nullptr,
-                                  nullptr);
-      LOG_TRACEV << "^------------------ injected read to fetch pointers";
-      TranslatePointerOffsets(tmpBuffer, indirectOffsets);
-      drvOcl.clEnqueueMemcpyINTEL(cq, CL_BLOCKING, allocState.first, tmpBuffer, size, 0, nullptr,
-                                  nullptr);
-      LOG_TRACEV << "^------------------ injected write to fetch pointers";
-      delete[] tmpBuffer;
-    } else {
-      TranslatePointerOffsets(allocState.first, indirectOffsets);
+    indirectPair.second = true;
+    const auto offset = indirectPair.first;
+    if (hostAccessible) {
+      TranslatePointerSlot(static_cast<char*>(allocPtr) + offset, allocPtr, offset);
+      continue;
     }
-    for (auto& indirectPair : indirectOffsets) {
-      indirectPair.second = true;
+    job.offsets.push_back(offset);
+    if (!job.ranges.empty() && offset <= job.ranges.back().second + maxGap) {
+      job.ranges.back().second = std::max(job.ranges.back().second, offset + sizeof(void*));
+    } else {
+      job.ranges.emplace_back(offset, offset + sizeof(void*));
     }
   }
+  if (!job.offsets.empty()) {
+    job.commandQueue = getQueue();
+    job.allocPtr = static_cast<char*>(allocPtr);
+    job.isSvm = isSvm;
+    jobs.push_back(std::move(job));
+  }
+}
+
+void TranslatePointers() {
+  std::vector<CPointerPatchJob> jobs;
+  for (auto& allocState : SD()._usmAllocStates) {
+    auto& state = *allocState.second;
+    CollectPointerPatches(
+        state, allocState.first, state.type != UnifiedMemoryType::device,
+        [&] { return GetCommandQueue(state.context, state.device); }, false, jobs);
+  }
   for (auto& svmState : SD()._svmAllocStates) {
-    auto& indirectOffsets = svmState.second->indirectPointersOffsets;
-    if (indirectOffsets.empty() ||
-        indirectOffsets.end() ==
-            std::find_if(indirectOffsets.begin(), indirectOffsets.end(),
-                         [](const std::pair<size_t, bool>& i) { return !i.second; })) {
-      continue;
+    auto& state = *svmState.second;
+    CollectPointerPatches(
+        state, svmState.first, (state.flags & CL_MEM_SVM_FINE_GRAIN_BUFFER) != 0U,
+        [&] { return GetCommandQueue(state.context, GetGpuDevice()); }, true, jobs);
+  }
+  if (jobs.empty()) {
+    return;
+  }
+
+  // Staging memory is reused between kernels, it only grows.
+  static std::vector<char> staging;
+  size_t stagingSize = 0;
+  for (auto& job : jobs) {
+    job.stagingOffset = stagingSize;
+    for (const auto& range : job.ranges) {
+      stagingSize += range.second - range.first;
     }
-    if ((svmState.second->flags & CL_MEM_SVM_FINE_GRAIN_BUFFER) != 0U) {
-      TranslatePointerOffsets(svmState.first, indirectOffsets);
-    } else {
-      auto cq = GetCommandQueue(svmState.second->context, GetGpuDevice());
-      const auto size = svmState.second->size;
-      auto* tmpBuffer = new char[size];
-      drvOcl.clEnqueueSVMMemcpy(cq, CL_BLOCKING, tmpBuffer, svmState.first, size, 0, nullptr,
-                                nullptr);
-      LOG_TRACEV << "^------------------ injected read to fetch pointers";
-      TranslatePointerOffsets(tmpBuffer, indirectOffsets);
-      drvOcl.clEnqueueSVMMemcpy(cq, CL_BLOCKING, svmState.first, tmpBuffer, size, 0, nullptr,
-                                nullptr);
-      LOG_TRACEV << "^------------------ injected write to fetch pointers";
-      delete[] tmpBuffer;
+  }
+  if (staging.size() < stagingSize) {
+    staging.resize(stagingSize);
+  }
+
+  // All reads are in flight at once, queues are synchronized only once.
+  for (const auto& job : jobs) {
+    auto* dst = staging.data() + job.stagingOffset;
+    for (const auto& range : job.ranges) {
+      EnqueuePatchCopy(job, dst, job.allocPtr + range.first, range.second - range.first);
+      dst += range.second - range.first;
+    }
+  }
+  FinishQueues(jobs);
+  LOG_TRACEV << "^------------------ injected reads to fetch pointers";
+
+  // Only the patched slots are written back, adjacent slots with a single copy.
+  for (const auto& job : jobs) {
+    auto range = job.ranges.begin();
+    size_t rangeStaging = job.stagingOffset;
+    size_t runBegin = 0;
+    size_t runEnd = 0;
+    const char* runStaging = nullptr;
+    for (const auto offset : job.offsets) {
+      while (offset >= range->second) {
+        rangeStaging += range->second - range->first;
+        ++range;
+      }
+      char* slot = staging.data() + rangeStaging + (offset - range->first);
+      TranslatePointerSlot(slot, job.allocPtr, offset);
+      if (runStaging != nullptr && offset == runEnd) {
+        runEnd += sizeof(void*);
+        continue;
+      }
+      if (runStaging != nullptr) {
+        EnqueuePatchCopy(job, job.allocPtr + runBegin, runStaging, runEnd - runBegin);
+      }
+      runBegin = offset;
+      runEnd = offset + sizeof(void*);
+      runStaging = slot;
     }
-    for (auto& indirectPair : indirectOffsets) {
-      indirectPair.second = true;
+    if (runStaging != nullptr) {
+      EnqueuePatchCopy(job, job.allocPtr + runBegin, runStaging, runEnd - runBegin);
     }
   }
+  FinishQueues(jobs);
+  LOG_TRACEV << "^------------------ injected writes of translated pointers";
 }
 } // namespace
 
@@ -279,10 +279,11 @@ std::array<size_t, 3> GetSimplifiedImageSizes(const cl_image_desc& desc) {
   }
 }
 
-void SaveImage(char* image,
-               const cl_image_format& format,
-               const cl_image_desc& desc,
-               const std::string& name) {
+namespace {
+void WriteImageFiles(const char* image,
+                     const cl_image_format& format,
+                     const cl_image_desc& desc,
+                     const std::string& name) {
   auto& cfg = Configurator::Get();
   const unsigned rgba8TexelSize = 4;
   const auto dumpPath = GetDumpPath(cfg);
@@ -313,26 +314,44 @@ void SaveImage(char* image,
   }
 }
 
-void SaveBuffer(const std::string& name, const std::vector<char>& data) {
+void WriteBufferFile(const std::string& name, const char* data, size_t size) {
   auto& cfg = Configurator::Get();
   std::string filename = name + ".dat";
   const auto dumpPath = GetDumpPath(cfg);
   std::filesystem::path path = dumpPath / filename;
   std::filesystem::create_directories(path.parent_path());
   std::ofstream binStream(path, std::ofstream::binary);
-  binStream.write(data.data(), data.size());
+  binStream.write(data, size);
   binStream.close();
 }
+} // namespace
+
+// Dumps are converted and written on the dump workers, from a snapshot of the data.
+void SaveImage(char* image,
+               const cl_image_format& format,
+               const cl_image_desc& desc,
+               const std::string& name) {
+  std::vector<char> snapshot(image, image + CountImageSize(format, desc));
+  CGits::Instance().DumpPipeline().Schedule(
+      std::move(snapshot), [format, desc, name](const std::vector<char>& data) {
+        WriteImageFiles(data.data(), format, desc, name);
+      });
+}
+
+void SaveBuffer(const std::string& name, const std::vector<char>& data) {
+  CGits::Instance().DumpPipeline().Schedule(data, [name](const std::vector<char>& snapshot) {
+    WriteBufferFile(name, snapshot.data(), snapshot.size());
+  });
+}
 
 void SaveBuffer(const std::string& name, const CBinaryResource& data) {
-  auto& cfg = Configurator::Get();
-  std::string filename = name + ".dat";
-  const auto dumpPath = GetDumpPath(cfg);
-  std::filesystem::path path = dumpPath / filename;
-  std::filesystem::create_directories(path.parent_path());
-  std::ofstream binStream(path, std::ofstream::binary);
-  binStream.write((const char*)data.Data(), data.Data().Size());
-  binStream.close();
+  const auto proxy = data.Data();
+  const char* begin = proxy;
+  std::vector<char> snapshot(begin, begin + proxy.Size());
+  CGits::Instance().DumpPipeline().Schedule(
+      std::move(snapshot), [name](const std::vector<char>& snapshot) {
+        WriteBufferFile(name, snapshot.data(), snapshot.size());
+      });
 }
 
 void D3DWarning() {
@@ -3002,7 +3002,7 @@ function(name='glConvolutionParameterxvOES', enabled=False, function_type=FuncTy
     ],
 )
 
-function(name='glCopyBufferSubData', enabled=True, function_type=FuncType.COPY,
+function(name='glCopyBufferSubData', enabled=True, function_type=FuncType.COPY, state_track=True,
     return_value=ReturnValue(type='void'),
     args=[
         Argument(name='readTarget', type='GLenum'),
@@ -3168,7 +3168,7 @@ function(name='glCopyMultiTexSubImage3DEXT', enabled=True, function_type=FuncTyp
     ],
 )
 
-function(name='glCopyNamedBufferSubData', enabled=True, function_type=FuncType.COPY,
+function(name='glCopyNamedBufferSubData', enabled=True, function_type=FuncType.COPY, state_track=True,
     return_value=ReturnValue(type='void'),
     args=[
         Argument(name='readBuffer', type='GLuint', wrap_type='CGLBuffer'),
@@ -13692,7 +13692,7 @@ function(name='glNamedBufferSubData', enabled=True, function_type=FuncType.RESOU
 
 function(name='glNamedBufferSubDataEXT', enabled=True, function_type=FuncType.RESOURCE, inherit_from='glNamedBufferSubData')
 
-function(name='glNamedCopyBufferSubDataEXT', enabled=True, function_type=FuncType.COPY,
+function(name='glNamedCopyBufferSubDataEXT', enabled=True, function_type=FuncType.COPY, state_track='glCopyNamedBufferSubData',
     return_value=ReturnValue(type='void'),
     args=[
         Argument(name='readBuffer', type='GLuint', wrap_type='CGLBuffer'),
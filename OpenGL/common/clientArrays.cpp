@@ -8,6 +8,62 @@
 
 #include "clientArrays.h"
 
+#include <unordered_map>
+
+namespace {
+using namespace gits::OpenGL;
+
+// Identifies index data analyzed for a draw sourcing indices from a buffer object.
+struct IndexRangeKey {
+  GLuint buffer;
+  uint64_t generation;
+  uint64_t offset;
+  GLuint count;
+  GLenum type;
+  GLuint basevertex;
+  GLuint restartIndex;
+  GLuint stripIndex;
+  bool operator==(const IndexRangeKey& other) const = default;
+};
+
+struct IndexRangeKeyHash {
+  size_t operator()(const IndexRangeKey& key) const {
+    uint64_t hash = key.generation;
+    for (uint64_t value : {uint64_t(key.buffer), key.offset, uint64_t(key.count),
+                           uint64_t(key.type), uint64_t(key.basevertex),
+                           uint64_t(key.restartIndex), uint64_t(key.stripIndex)}) {
+      hash = (hash ^ value) * 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+};
+
+// Used vertex ranges of static index buffers, so that they are not mapped and scanned again
+// on every draw. Buffer generation changes with every tracked modification of its contents.
+class CIndexRangeCache {
+  static const size_t maxEntries = 4096;
+  std::unordered_map<IndexRangeKey, TIndexRanges, IndexRangeKeyHash> _ranges;
+
+public:
+  const TIndexRanges* Find(const IndexRangeKey& key) const {
+    auto iter = _ranges.find(key);
+    return iter != _ranges.end() ? &iter->second : nullptr;
+  }
+  void Insert(const IndexRangeKey& key, const TIndexRanges& ranges) {
+    // Entries of old buffer generations are never hit again, drop everything when full.
+    if (_ranges.size() >= maxEntries) {
+      _ranges.clear();
+    }
+    _ranges[key] = ranges;
+  }
+};
+
+CIndexRangeCache& IndexRangeCache() {
+  static CIndexRangeCache cache;
+  return cache;
+}
+} // namespace
+
 /* ************************* ClientArraysUpdate *********************************** */
 gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLuint index) {
   // VAO check
@@ -79,11 +135,11 @@ gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLenum type,
     return;
   }
 
-  // Dump indices and get sorted list of indices
-  std::set<GLuint> indicesSorted;
+  // Dump indices and get ranges of used indices
+  TIndexRanges indicesRanges;
   for (unsigned i = 0; i < primcount; i++) {
     if (count[i] > 0) {
-      DumpIndicesUpdate(buff, type, count[i], indices[i], 0, indicesSorted);
+      DumpIndicesUpdate(buff, type, count[i], indices[i], 0, indicesRanges);
     }
   }
 
@@ -93,7 +149,8 @@ gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLenum type,
   }
 
   // Dump attribs updates in optimized ranges
-  DumpAttribsUpdateOptimized(std::move(indicesSorted), 0, 0);
+  MergeIndexRanges(indicesRanges);
+  DumpAttribsUpdateOptimized(indicesRanges, 0, 0);
 }
 
 gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLsizei count,
@@ -126,9 +183,9 @@ gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLsizei count,
     return;
   }
 
-  // Dump indices and get sorted list of indices
-  std::set<GLuint> indicesSorted;
-  DumpIndicesUpdate(buff, type, count, indices, basevertex, indicesSorted);
+  // Dump indices and get ranges of used indices
+  TIndexRanges indicesRanges;
+  DumpIndicesUpdate(buff, type, count, indices, basevertex, indicesRanges);
 
   // return if attribs stored in buffers
   if (!clientAttribs) {
@@ -136,7 +193,7 @@ gits::OpenGL::ClientArraysUpdate::ClientArraysUpdate(GLsizei count,
   }
 
   // Dump attribs updates in optimized ranges
-  DumpAttribsUpdateOptimized(std::move(indicesSorted), instances, baseinstance);
+  DumpAttribsUpdateOptimized(indicesRanges, instances, baseinstance);
 }
 
 void gits::OpenGL::ClientArraysUpdate::DumpIndicesUpdate(GLuint buff,
@@ -144,17 +201,7 @@ void gits::OpenGL::ClientArraysUpdate::DumpIndicesUpdate(GLuint buff,
                                                          GLuint count,
                                                          const GLvoid* indices,
                                                          GLuint basevertex,
-                                                         std::set<GLuint>& sorted) {
-  // Get pointer to indices data from client side or mapped buffer
-  const GLvoid* indicesPtr;
-  std::shared_ptr<MapBuffer> buffMap;
-  if (buff != 0) {
-    buffMap.reset(new MapBuffer(GL_ELEMENT_ARRAY_BUFFER, buff));
-    indicesPtr = (GLvoid*)((uintptr_t)buffMap->Data() + (uintptr_t)indices);
-  } else {
-    indicesPtr = indices;
-  }
-
+                                                         TIndexRanges& ranges) {
   // Support for GL_PRIMITIVE_RESTART and STRIP INDEX options
   GLuint stripIndex = Configurator::Get().opengl.recorder.stripIndicesValues;
   GLuint restartIndex = 4294967295u;
@@ -162,56 +209,40 @@ void gits::OpenGL::ClientArraysUpdate::DumpIndicesUpdate(GLuint buff,
     restartIndex = SD().GetCurrentContextStateData().restartIndexValue;
   }
 
-  // Read indices
-  uint64_t indicesDataSize;
-  switch (type) {
-  case GL_UNSIGNED_BYTE: {
-    indicesDataSize = sizeof(GLubyte) * count;
-
-    auto indexPtr = (GLubyte*)indicesPtr;
-    for (unsigned i = 0; i < count; i++, indexPtr++) {
-      GLubyte index = *indexPtr + (GLubyte)basevertex;
-      if ((GLubyte)restartIndex == index || (GLubyte)stripIndex == index) {
-        continue;
+  // Indices from a buffer - reuse ranges analyzed earlier if buffer contents didn't change
+  if (buff != 0) {
+    CBufferStateObj* bufferState = SD().GetCurrentSharedStateData().Buffers().Get(buff);
+    const bool cacheable = bufferState != nullptr && bufferState->ContentsTracked();
+    IndexRangeKey key = {};
+    if (cacheable) {
+      key = {buff, bufferState->ContentsGeneration(), (uint64_t)indices, count, type,
+             basevertex, restartIndex, stripIndex};
+      const TIndexRanges* cached = IndexRangeCache().Find(key);
+      if (cached != nullptr) {
+        ranges.insert(ranges.end(), cached->begin(), cached->end());
+        return;
       }
-      sorted.insert((GLuint)index);
     }
-    break;
-  }
-  case GL_UNSIGNED_SHORT: {
-    indicesDataSize = sizeof(GLushort) * count;
 
-    auto indexPtr = (GLushort*)indicesPtr;
-    for (unsigned i = 0; i < count; i++, indexPtr++) {
-      GLushort index = *indexPtr + (GLushort)basevertex;
-      if ((GLushort)restartIndex == index || (GLushort)stripIndex == index) {
-        continue;
-      }
-      sorted.insert((GLuint)index);
+    MapBuffer buffMap(GL_ELEMENT_ARRAY_BUFFER, buff);
+    const GLvoid* indicesPtr = (GLvoid*)((uintptr_t)buffMap.Data() + (uintptr_t)indices);
+    TIndexRanges found =
+        AnalyzeIndexRanges(type, indicesPtr, count, basevertex, restartIndex, stripIndex);
+    if (cacheable) {
+      IndexRangeCache().Insert(key, found);
     }
-    break;
+    ranges.insert(ranges.end(), found.begin(), found.end());
+    return;
   }
-  case GL_UNSIGNED_INT: {
-    indicesDataSize = sizeof(GLuint) * count;
 
-    auto indexPtr = (GLuint*)indicesPtr;
-    for (unsigned i = 0; i < count; i++, indexPtr++) {
-      GLuint index = *indexPtr + basevertex;
-      if ((GLuint)restartIndex == index || (GLuint)stripIndex == index) {
-        continue;
-      }
-      sorted.insert((GLuint)index);
-    }
-    break;
-  }
-  default:
-    throw std::runtime_error(EXCEPTION_MESSAGE);
-  }
+  // Indices from client side memory
+  TIndexRanges found =
+      AnalyzeIndexRanges(type, indices, count, basevertex, restartIndex, stripIndex);
+  ranges.insert(ranges.end(), found.begin(), found.end());
 
   // Dump indices data diff
-  if (buff == 0) {
-    _update.Diff((uint64_t)indicesPtr, (uint64_t)indicesPtr, indicesDataSize);
-  }
+  const uint64_t indicesDataSize = static_cast<uint64_t>(DataTypeSize(type)) * count;
+  _update.Diff((uint64_t)indices, (uint64_t)indices, indicesDataSize);
 }
 
 // Returns true if any attrib comes from client side
@@ -438,29 +469,11 @@ void gits::OpenGL::ClientArraysUpdate::DumpAttribsUpdate(GLuint frontindex,
 }
 
 // Dump attribs data memory updates optimized
-void gits::OpenGL::ClientArraysUpdate::DumpAttribsUpdateOptimized(std::set<GLuint> indices,
+void gits::OpenGL::ClientArraysUpdate::DumpAttribsUpdateOptimized(const TIndexRanges& ranges,
                                                                   GLuint instances,
                                                                   GLuint baseinstance) {
-  // Get continuous indices ranges and dump attribs data diff for those ranges
-  GLuint rangeBegin = 0;
-  GLuint rangeEnd = 0;
-  for (auto index = indices.begin(); index != indices.end(); index++) {
-    if (index == indices.begin()) {
-      rangeBegin = *index;
-      rangeEnd = *index;
-    } else {
-      // Check range end - dump indices data
-      if (rangeEnd < *index - 1) {
-        DumpAttribsUpdate(rangeBegin, rangeEnd, instances, baseinstance);
-        rangeBegin = *index;
-      }
-
-      // Check indices end - dump attribs data
-      if (*index == *indices.rbegin()) {
-        DumpAttribsUpdate(rangeBegin, *index, instances, baseinstance);
-      }
-
-      rangeEnd = *index;
-    }
+  // Dump attribs data diff for each continuous indices range
+  for (const auto& range : ranges) {
+    DumpAttribsUpdate(range.first, range.second, instances, baseinstance);
   }
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "openglArguments.h"
+#include "indexRanges.h"
 
 namespace gits {
 /**
@@ -26,16 +27,18 @@ class ClientArraysUpdate : public CArgument {
                          GLuint backindex,
                          GLuint instances,
                          GLuint baseinstance);
-  // Dumps indices data memory updates
+  // Dumps indices data memory updates and appends ranges of used vertex indices
   void DumpIndicesUpdate(GLuint buff,
                          GLenum type,
                          GLuint count,
                          const GLvoid* indices,
                          GLuint basevertex,
-                         std::set<GLuint>& sorted);
+                         TIndexRanges& ranges);
   // Dumps indices attribs data memory in continous indices ranges. It uses
   // DumpAttribsUpdate under the hood.
-  void DumpAttribsUpdateOptimized(std::set<GLuint> indices, GLuint instances, GLuint baseinstance);
+  void DumpAttribsUpdateOptimized(const TIndexRanges& ranges,
+                                  GLuint instances,
+                                  GLuint baseinstance);
 
 public:
   ClientArraysUpdate() {}
@@ -0,0 +1,46 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   indexRanges.h
+ *
+ * @brief Analysis of index data used by indexed draws with client side attribs.
+ *
+ */
+
+#pragma once
+
+#include "openglTypes.h"
+
+#include <utility>
+#include <vector>
+
+namespace gits {
+namespace OpenGL {
+
+// Inclusive range of vertex indices [first, second].
+typedef std::pair<GLuint, GLuint> TIndexRange;
+typedef std::vector<TIndexRange> TIndexRanges;
+
+/**
+  * Returns sorted, disjoint and non-adjacent ranges of vertex indices referenced by count
+  * indices of given type. Basevertex is added with wraparound in the index type, values equal
+  * to restartIndex or stripIndex (after the addition, cast to the index type) are skipped.
+  */
+TIndexRanges AnalyzeIndexRanges(GLenum type,
+                                const void* indices,
+                                GLuint count,
+                                GLuint basevertex,
+                                GLuint restartIndex,
+                                GLuint stripIndex);
+
+// Merges ranges in place so that they are sorted, disjoint and non-adjacent.
+void MergeIndexRanges(TIndexRanges& ranges);
+
+} // namespace OpenGL
+} // namespace gits
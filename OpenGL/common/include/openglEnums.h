@@ -13789,6 +13789,9 @@
 #ifndef GL_QUERY_BUFFER_AMD
 #define GL_QUERY_BUFFER_AMD 0x9192
 #endif
+#ifndef GL_QUERY_BUFFER
+#define GL_QUERY_BUFFER 0x9192
+#endif
 #ifndef GL_QUERY_BUFFER_BINDING_AMD
 #define GL_QUERY_BUFFER_BINDING_AMD 0x9193
 #endif
@@ -815,6 +815,10 @@ struct CBufferStateData {
     bool immutable;
     GLbitfield flags;
     bool coherentMapping;
+    // Changes whenever buffer contents may have changed, unique across all buffers.
+    uint64_t contentsGeneration;
+    // Buffer was bound to a target the GPU writes to, contents can't be tracked.
+    bool gpuWritable;
     Tracked(GLuint tname, GLenum ttarget = 0)
         : name(tname),
           target(ttarget),
@@ -823,7 +827,9 @@ struct CBufferStateData {
           initializedData(true),
           immutable(false),
           flags(0),
-          coherentMapping(false) {}
+          coherentMapping(false),
+          contentsGeneration(0),
+          gpuWritable(false) {}
   } track;
 
   struct Restored {
@@ -900,6 +906,15 @@ public:
   bool Immutable() const {
     return _data.track.immutable;
   }
+  uint64_t ContentsGeneration() const {
+    return _data.track.contentsGeneration;
+  }
+  void ContentsModified();
+  void GpuWritableSet() {
+    _data.track.gpuWritable = true;
+  }
+  // Returns true if all changes of buffer contents are visible to the state tracking.
+  bool ContentsTracked() const;
   std::vector<GLubyte>& Buffer() {
     return _data.restore.buffer;
   }
@@ -943,6 +958,7 @@ public:
                           GLsizeiptr& size,
                           const GLvoid* ptr);
   void RemoveMapping() {
+    ContentsModified();
     _data.restore.mapped = false;
     _data.restore.mapAccess = 0;
     _data.restore.mapLength = -1;
@@ -1790,6 +1790,32 @@ inline void glBufferSubData_SD(
   }
 }
 
+inline void glCopyNamedBufferSubData_SD(GLuint readBuffer,
+                                        GLuint writeBuffer,
+                                        GLintptr readOffset,
+                                        GLintptr writeOffset,
+                                        GLsizeiptr size,
+                                        GLboolean recording = 0) {
+  if (Configurator::IsRecorder()) {
+    CBufferStateObj* bufferState = SD().GetCurrentSharedStateData().Buffers().Get(writeBuffer);
+    if (bufferState != nullptr) {
+      bufferState->ContentsModified();
+    }
+  }
+}
+
+inline void glCopyBufferSubData_SD(GLenum readTarget,
+                                   GLenum writeTarget,
+                                   GLintptr readOffset,
+                                   GLintptr writeOffset,
+                                   GLsizeiptr size,
+                                   GLboolean recording = 0) {
+  if (Configurator::IsRecorder()) {
+    glCopyNamedBufferSubData_SD(boundBuff(readTarget), boundBuff(writeTarget), readOffset,
+                                writeOffset, size, recording);
+  }
+}
+
 inline void glClearBufferSubData_SD(GLenum target,
                                     GLenum internalformat,
                                     GLintptr offset,
@@ -3170,6 +3196,12 @@ inline void glTexBuffer_SD(GLenum target,
     }
     texStateObj->Data().track.texbuffer_internalformat = internalformat;
     texStateObj->Data().track.texbuffer_buffer = buffer;
+
+    // Buffer textures may be written by image stores.
+    CBufferStateObj* bufferState = SD().GetCurrentSharedStateData().Buffers().Get(buffer);
+    if (bufferState != nullptr) {
+      bufferState->GpuWritableSet();
+    }
   }
 }
 
@@ -3190,6 +3222,12 @@ inline void glTextureBuffer_SD(GLuint texture,
     }
     texStateObj->Data().track.texbuffer_internalformat = internalformat;
     texStateObj->Data().track.texbuffer_buffer = buffer;
+
+    // Buffer textures may be written by image stores.
+    CBufferStateObj* bufferState = SD().GetCurrentSharedStateData().Buffers().Get(buffer);
+    if (bufferState != nullptr) {
+      bufferState->GpuWritableSet();
+    }
   }
 }
 } // namespace OpenGL
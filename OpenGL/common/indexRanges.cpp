@@ -0,0 +1,279 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   indexRanges.cpp
+ *
+ * @brief Analysis of index data used by indexed draws with client side attribs.
+ *
+ */
+
+#include "indexRanges.h"
+#include "openglEnums.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+#include <smmintrin.h>
+#endif
+
+namespace gits {
+namespace OpenGL {
+namespace {
+// Index spans up to this size are always marked in a bitmap. Wider spans use the bitmap
+// only if it is not bigger than bitmapBitsPerIndex bits per index, otherwise the indices
+// are sorted.
+const uint64_t minBitmapSpan = 1U << 16;
+const uint64_t bitmapBitsPerIndex = 32;
+
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+template <class T>
+struct SimdOps;
+
+template <>
+struct SimdOps<GLubyte> {
+  static __m128i Set1(GLubyte value) {
+    return _mm_set1_epi8(static_cast<char>(value));
+  }
+  static __m128i Add(__m128i a, __m128i b) {
+    return _mm_add_epi8(a, b);
+  }
+  static __m128i CmpEq(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi8(a, b);
+  }
+  static __m128i Min(__m128i a, __m128i b) {
+    return _mm_min_epu8(a, b);
+  }
+  static __m128i Max(__m128i a, __m128i b) {
+    return _mm_max_epu8(a, b);
+  }
+};
+
+template <>
+struct SimdOps<GLushort> {
+  static __m128i Set1(GLushort value) {
+    return _mm_set1_epi16(static_cast<short>(value));
+  }
+  static __m128i Add(__m128i a, __m128i b) {
+    return _mm_add_epi16(a, b);
+  }
+  static __m128i CmpEq(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi16(a, b);
+  }
+  static __m128i Min(__m128i a, __m128i b) {
+    return _mm_min_epu16(a, b);
+  }
+  static __m128i Max(__m128i a, __m128i b) {
+    return _mm_max_epu16(a, b);
+  }
+};
+
+template <>
+struct SimdOps<GLuint> {
+  static __m128i Set1(GLuint value) {
+    return _mm_set1_epi32(static_cast<int>(value));
+  }
+  static __m128i Add(__m128i a, __m128i b) {
+    return _mm_add_epi32(a, b);
+  }
+  static __m128i CmpEq(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi32(a, b);
+  }
+  static __m128i Min(__m128i a, __m128i b) {
+    return _mm_min_epu32(a, b);
+  }
+  static __m128i Max(__m128i a, __m128i b) {
+    return _mm_max_epu32(a, b);
+  }
+};
+#endif
+
+// Finds the lowest and highest used index. Returns false if all indices are skipped.
+template <class T>
+bool FindIndexBounds(
+    const T* indices, size_t count, T basevertex, T restart, T strip, T& lowest, T& highest) {
+  T low = std::numeric_limits<T>::max();
+  T high = 0;
+  size_t i = 0;
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+  typedef SimdOps<T> Ops;
+  const size_t lanes = sizeof(__m128i) / sizeof(T);
+  if (count >= lanes) {
+    const __m128i base = Ops::Set1(basevertex);
+    const __m128i restartValue = Ops::Set1(restart);
+    const __m128i stripValue = Ops::Set1(strip);
+    __m128i lowValues = _mm_set1_epi8(-1);
+    __m128i highValues = _mm_setzero_si128();
+    for (; i + lanes <= count; i += lanes) {
+      const __m128i values =
+          Ops::Add(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)), base);
+      const __m128i skipped =
+          _mm_or_si128(Ops::CmpEq(values, restartValue), Ops::CmpEq(values, stripValue));
+      // Skipped lanes become all ones for the minimum and zero for the maximum.
+      lowValues = Ops::Min(lowValues, _mm_or_si128(values, skipped));
+      highValues = Ops::Max(highValues, _mm_andnot_si128(skipped, values));
+    }
+    T lowLanes[sizeof(__m128i) / sizeof(T)];
+    T highLanes[sizeof(__m128i) / sizeof(T)];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lowLanes), lowValues);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(highLanes), highValues);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      low = std::min(low, lowLanes[lane]);
+      high = std::max(high, highLanes[lane]);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    const T value = static_cast<T>(indices[i] + basevertex);
+    if (value == restart || value == strip) {
+      continue;
+    }
+    low = std::min(low, value);
+    high = std::max(high, value);
+  }
+  // Any used index v gives low <= v <= high, so low > high only if there were none.
+  lowest = low;
+  highest = high;
+  return low <= high;
+}
+
+template <class T>
+void AnalyzeWithBitmap(const T* indices,
+                       size_t count,
+                       T basevertex,
+                       T restart,
+                       T strip,
+                       T lowest,
+                       uint64_t span,
+                       TIndexRanges& ranges) {
+  std::vector<uint64_t> bits(static_cast<size_t>((span + 63) / 64), 0);
+  for (size_t i = 0; i < count; ++i) {
+    const T value = static_cast<T>(indices[i] + basevertex);
+    if (value == restart || value == strip) {
+      continue;
+    }
+    const size_t bit = static_cast<size_t>(value - lowest);
+    bits[bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+
+  // Walk words looking only for transitions between used and unused indices, words which
+  // continue the current state are skipped as a whole.
+  bool inRange = false;
+  uint64_t rangeBegin = 0;
+  for (size_t word = 0; word < bits.size(); ++word) {
+    const uint64_t value = bits[word];
+    if (value == (inRange ? ~uint64_t(0) : uint64_t(0))) {
+      continue;
+    }
+    unsigned bit = 0;
+    while (bit < 64) {
+      const uint64_t pending = (inRange ? ~value : value) & (~uint64_t(0) << bit);
+      if (pending == 0) {
+        break;
+      }
+      bit = static_cast<unsigned>(std::countr_zero(pending));
+      const uint64_t position = uint64_t(word) * 64 + bit;
+      if (inRange) {
+        ranges.emplace_back(static_cast<GLuint>(lowest + rangeBegin),
+                            static_cast<GLuint>(lowest + position - 1));
+      } else {
+        rangeBegin = position;
+      }
+      inRange = !inRange;
+    }
+  }
+  if (inRange) {
+    ranges.emplace_back(static_cast<GLuint>(lowest + rangeBegin),
+                        static_cast<GLuint>(lowest + bits.size() * 64 - 1));
+  }
+}
+
+template <class T>
+void AnalyzeWithSort(
+    const T* indices, size_t count, T basevertex, T restart, T strip, TIndexRanges& ranges) {
+  std::vector<T> sorted;
+  sorted.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const T value = static_cast<T>(indices[i] + basevertex);
+    if (value != restart && value != strip) {
+      sorted.push_back(value);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+  for (const T value : sorted) {
+    if (!ranges.empty() && uint64_t(value) <= uint64_t(ranges.back().second) + 1) {
+      ranges.back().second = std::max<GLuint>(ranges.back().second, value);
+    } else {
+      ranges.emplace_back(value, value);
+    }
+  }
+}
+
+template <class T>
+TIndexRanges Analyze(
+    const void* data, GLuint count, GLuint basevertex, GLuint restartIndex, GLuint stripIndex) {
+  const T* indices = static_cast<const T*>(data);
+  const T base = static_cast<T>(basevertex);
+  const T restart = static_cast<T>(restartIndex);
+  const T strip = static_cast<T>(stripIndex);
+
+  TIndexRanges ranges;
+  T lowest = 0;
+  T highest = 0;
+  if (!FindIndexBounds(indices, count, base, restart, strip, lowest, highest)) {
+    return ranges;
+  }
+  const uint64_t span = uint64_t(highest) - lowest + 1;
+  if (span <= std::max(minBitmapSpan, uint64_t(count) * bitmapBitsPerIndex)) {
+    AnalyzeWithBitmap(indices, count, base, restart, strip, lowest, span, ranges);
+  } else {
+    AnalyzeWithSort(indices, count, base, restart, strip, ranges);
+  }
+  return ranges;
+}
+} // namespace
+
+TIndexRanges AnalyzeIndexRanges(GLenum type,
+                                const void* indices,
+                                GLuint count,
+                                GLuint basevertex,
+                                GLuint restartIndex,
+                                GLuint stripIndex) {
+  switch (type) {
+  case GL_UNSIGNED_BYTE:
+    return Analyze<GLubyte>(indices, count, basevertex, restartIndex, stripIndex);
+  case GL_UNSIGNED_SHORT:
+    return Analyze<GLushort>(indices, count, basevertex, restartIndex, stripIndex);
+  case GL_UNSIGNED_INT:
+    return Analyze<GLuint>(indices, count, basevertex, restartIndex, stripIndex);
+  default:
+    throw std::runtime_error(EXCEPTION_MESSAGE);
+  }
+}
+
+void MergeIndexRanges(TIndexRanges& ranges) {
+  if (ranges.size() < 2) {
+    return;
+  }
+  std::sort(ranges.begin(), ranges.end());
+  size_t last = 0;
+  for (size_t i = 1; i < ranges.size(); ++i) {
+    if (uint64_t(ranges[i].first) <= uint64_t(ranges[last].second) + 1) {
+      ranges[last].second = std::max(ranges[last].second, ranges[i].second);
+    } else {
+      ranges[++last] = ranges[i];
+    }
+  }
+  ranges.resize(last + 1);
+}
+
+} // namespace OpenGL
+} // namespace gits
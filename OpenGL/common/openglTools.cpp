@@ -239,7 +239,8 @@ void capture_drawbuffer(
 
     if (!Configurator::Get().common.player.captureFrames.empty() &&
         Configurator::Get().opengl.player.captureFramesHashes) {
-      LOG_INFO << file_name + suffix.str() << " CRC: " << HwCrc32ishHash(&data[0], data.size(), 0);
+      LOG_INFO << file_name + suffix.str()
+               << " hash: " << ComputeHash(&data[0], data.size(), THashType::XXH3_64);
     } else {
       CGits::Instance().WriteImage(path_color.string(), capture_dims[2], capture_dims[3],
                                    !curctx::IsOgl(), data);
@@ -1481,7 +1482,7 @@ std::map<GLuint, hash_t> CurrentAttribsBuffersHash() {
       ptr = func_map(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
     }
 
-    hashes[buffer] = ComputeHash(ptr, size, THashType::XX);
+    hashes[buffer] = ComputeHash(ptr, size, THashType::XXH3_64);
     func_unmap(GL_ARRAY_BUFFER);
   }
 
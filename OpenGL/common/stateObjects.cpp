@@ -18,6 +18,8 @@
 #include "stateDynamic.h"
 #include "tools.h"
 
+#include <atomic>
+
 namespace gits {
 namespace OpenGL {
 
@@ -254,6 +256,17 @@ CBufferStateObj::CBufferStateObj(GLuint buffer, GLenum target) : _data(buffer, t
   _data.restore.mapAccess = 0;
   _data.restore.mapOffset = -1;
   _data.restore.named = false;
+  ContentsModified();
+}
+
+void CBufferStateObj::ContentsModified() {
+  static std::atomic<uint64_t> nextGeneration(1);
+  _data.track.contentsGeneration = nextGeneration++;
+}
+
+bool CBufferStateObj::ContentsTracked() const {
+  return !_data.track.gpuWritable && !_data.track.coherentMapping && !_data.restore.mapped &&
+         (_data.track.flags & GL_MAP_PERSISTENT_BIT) == 0;
 }
 
 void CBufferStateObj::SetBufferMapPlay(GLbitfield access, bool named, GLint length, GLint offset) {
@@ -317,6 +330,7 @@ void CBufferStateObj::SetBufferMapRec(GLbitfield access, bool named, GLint lengt
   _data.restore.mapFlushRangeLength = 0;
   _data.restore.mapped = true;
   _data.restore.named = named;
+  ContentsModified();
 
   if (!_data.track.coherentMapping &&
       ((access & GL_MAP_COHERENT_BIT) ||
@@ -361,6 +375,7 @@ void CBufferStateObj::InitBufferMapRecEXT(GLbitfield access,
 }
 
 void CBufferStateObj::FlushMappedBufferRange(GLintptr offset, GLsizeiptr length) {
+  ContentsModified();
   auto& origLength = _data.restore.mapFlushRangeLength;
   auto& origOffset = _data.restore.mapFlushRangeOffset;
   if (origOffset == 0 && origLength == 0) {
@@ -38,6 +38,22 @@ void gits::OpenGL::setTargetForBuff(GLenum target, GLuint buffer) {
   } else {
     // In compatibility context, this may be the case
     SD().GetCurrentSharedStateData().Buffers().Add(CBufferStateObj(buffer, target));
+    bufferStateObj = SD().GetCurrentSharedStateData().Buffers().Get(buffer);
+  }
+
+  switch (target) {
+  case GL_TRANSFORM_FEEDBACK_BUFFER:
+  case GL_SHADER_STORAGE_BUFFER:
+  case GL_ATOMIC_COUNTER_BUFFER:
+  case GL_PIXEL_PACK_BUFFER:
+  case GL_TEXTURE_BUFFER:
+  case GL_QUERY_BUFFER:
+    if (bufferStateObj != nullptr) {
+      bufferStateObj->GpuWritableSet();
+    }
+    break;
+  default:
+    break;
   }
 }
 
@@ -144,14 +160,17 @@ void gits::OpenGL::OptionalBufferDataTrack(
   if (buffer == 0) {
     return;
   }
+  auto* bufferState = SD().GetCurrentSharedStateData().Buffers().Get(buffer);
+  if (bufferState != nullptr) {
+    bufferState->ContentsModified();
+  }
   //For OpenGL ES we need to track buffer data by default.
   //In case of optimizeBuffersz option we need to track buffer changes during recording for mapped memory changes detection performance.
   if ((!curctx::IsOgl() && ESBufferState() != TBuffersState::RESTORE &&
        !IsGlGetTexAndCompressedTexImagePresentOnGLES()) ||
       (recording && Configurator::Get().opengl.recorder.optimizeBufferSize)) {
-    auto* bufferStateData = SD().GetCurrentSharedStateData().Buffers().Get(buffer);
-    if (bufferStateData != nullptr) {
-      bufferStateData->TrackBufferData(offset, size, data);
+    if (bufferState != nullptr) {
+      bufferState->TrackBufferData(offset, size, data);
     }
   }
 }
@@ -28,6 +28,8 @@
 
 namespace gits {
 namespace OpenGL {
+class CStateReadback;
+
 /**
      * @brief OpenGL library current context share group getter class
      *
@@ -1317,11 +1319,17 @@ class CVariableTextureInfo : public gits::CComponentState::CVariable {
   class CTexture {
     GLint _target;
     GLuint _id;
+    CStateReadback* _readback;
 
   protected:
     static unsigned MipmapCount(GLuint textureId);
     static unsigned TexelSize(GLenum format, GLenum type);
 
+    // Read texture level data into hash, through the readback ring if it is available.
+    void GetLevelData(
+        GLenum target, GLint level, GLenum format, GLenum type, size_t size, hash_t& hash);
+    void GetCompressedLevelData(GLenum target, GLint level, size_t size, hash_t& hash);
+
     void GetTextureGenericData(GLenum target);
     void ScheduleTextureGenericData(GLenum target,
                                     CScheduler& scheduler,
@@ -1363,7 +1371,7 @@ class CVariableTextureInfo : public gits::CComponentState::CVariable {
     GLint Target() const;
     GLuint TextureId() const;
 
-    void Get();
+    void Get(CStateReadback* readback);
     void Schedule(CScheduler& scheduler, const CTextureData& defaultTexture) const;
     virtual ~CTexture() {}
   };
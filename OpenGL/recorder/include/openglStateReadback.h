@@ -0,0 +1,94 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   openglStateReadback.h
+ *
+ * @brief Asynchronous readback of texture and buffer contents during OpenGL state capture.
+ *
+ */
+
+#pragma once
+
+#include "openglTypes.h"
+#include "resource_manager.h"
+#include "tools_lite.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace gits {
+namespace OpenGL {
+
+/**
+   * @brief Pixel pack buffer readback ring
+   *
+   * Texture levels and buffer contents are copied into a ring of pixel pack buffers
+   * and a fence is inserted after each copy. Copies whose fences are signaled are
+   * mapped and handed to their callbacks while later copies are still executed by
+   * the GPU. The oldest copy is waited for only when the ring is full.
+   *
+   * Pixel pack buffer binding is reset to 0 after each call, copy buffer bindings are
+   * restored when the object is destroyed. Callbacks are called on the GL thread with
+   * the buffer mapped, so they must copy the data they need.
+   */
+class CStateReadback : private gits::noncopyable {
+public:
+  typedef std::function<void(const char* data, size_t size)> TCallback;
+
+private:
+  struct CSlot {
+    GLuint buffer;
+    size_t capacity;
+  };
+  struct CPending {
+    unsigned slot;
+    GLsync fence;
+    size_t size;
+    TCallback callback;
+  };
+
+  std::vector<CSlot> _slots;
+  std::vector<unsigned> _freeSlots;
+  std::deque<CPending> _pending;
+  GLint _origCopyReadBuffer;
+  GLint _origCopyWriteBuffer;
+
+  unsigned AcquireSlot(size_t size);
+  void Submit(unsigned slot, size_t size, TCallback callback);
+  void Complete(bool wait);
+
+public:
+  explicit CStateReadback(unsigned slotCount);
+  ~CStateReadback();
+
+  // Returns true if the current context supports pixel pack buffers, sync objects and
+  // buffer copies.
+  static bool Supported();
+
+  void ReadTexImage(
+      GLenum target, GLint level, GLenum format, GLenum type, size_t size, TCallback callback);
+  void ReadCompressedTexImage(GLenum target, GLint level, size_t size, TCallback callback);
+  void ReadBufferData(GLuint buffer, size_t size, TCallback callback);
+  // Waits for all queued readbacks and calls their callbacks.
+  void Finish();
+
+  // Starts the state capture resource writer. Resources put with PutResource are
+  // written on its worker threads until EndCapture.
+  static void BeginCapture();
+  // Waits for all resources to be written and logs readback statistics.
+  static void EndCapture();
+  // Writes the resource and sets hash to its hash once it is written. Hash must stay
+  // valid until EndCapture.
+  static void PutResource(TResourceType type, std::vector<char> data, hash_t& hash);
+};
+
+} // namespace OpenGL
+} // namespace gits
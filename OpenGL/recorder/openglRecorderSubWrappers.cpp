@@ -20,11 +20,13 @@ void gits::OpenGL::RestoreDisplayListState(CRecorder& recorder) {
       GL_COLOR_ARRAY,  GL_EDGE_FLAG_ARRAY,       GL_FOG_COORD_ARRAY,     GL_INDEX_ARRAY,
       GL_NORMAL_ARRAY, GL_SECONDARY_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY, GL_VERTEX_ARRAY};
   unsigned int clientStateValuesSize = sizeof(clientStateValues) / sizeof(GLenum);
-  CScheduler& scheduler = recorder.Scheduler();
   for (unsigned i = 0; i < clientStateValuesSize; i++) {
     recorder.Schedule(new CglDisableClientState(clientStateValues[i]), true);
   }
 
+  // Taken after scheduling the tokens above, so that they precede the ones below.
+  CScheduler& scheduler = recorder.Scheduler();
+
   for (unsigned i = 0; i < clientStateValuesSize; i++) {
     std::shared_ptr<CVariableClientCapability> variableClientCapability(
         new CVariableClientCapability(clientStateValues[i]));
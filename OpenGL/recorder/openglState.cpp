@@ -21,12 +21,14 @@
 #include "openglLibrary.h"
 #include "stateDynamic.h"
 #include "openglState.h"
+#include "openglStateReadback.h"
 #include "openglFunction.h"
 #include "gits.h"
 #include "scheduler.h"
 #include "streams.h"
 #include "log.h"
 #include "tools.h"
+#include "timer.h"
 #include "windowContextState.h"
 
 #include "wglFunctions.h"
@@ -443,6 +445,12 @@ void gits::OpenGL::CState::ScheduleCurrentContext(CScheduler& scheduler, void* c
 
 // Get state per context
 void gits::OpenGL::CState::Get() {
+  // Texture and buffer contents are written on worker threads, hashes of resources are set
+  // before EndCapture returns, so they are ready for Schedule.
+  CStateReadback::BeginCapture();
+  Timer phaseTimer(true);
+  int64_t sharedStateTime = 0;
+  int64_t contextStateTime = 0;
 
   _originalContext = GetCurrentContextAPI();
   for (auto context : SD().GetContextVector()) {
@@ -450,16 +458,24 @@ void gits::OpenGL::CState::Get() {
       _contextStateDataMap.insert(std::make_pair(context, CStateData()));
 
       if (SD().IsCurrentContextSharedDataOwner()) {
+        phaseTimer.Restart();
         _contextStateDataMap[context].sharedState.reset(new CSharedState);
         _contextStateDataMap[context].sharedState->Get();
+        sharedStateTime += phaseTimer.Get();
       }
 
+      phaseTimer.Restart();
       _contextStateDataMap[context].contextState.reset(new CContextState);
       _contextStateDataMap[context].contextState->Get();
+      contextStateTime += phaseTimer.Get();
     }
   }
   // Set original context
   SetCurrentContext(_originalContext);
+
+  LOG_INFO << "State capture: shared state " << sharedStateTime / 1000000 << " ms, context state "
+           << contextStateTime / 1000000 << " ms";
+  CStateReadback::EndCapture();
 }
 
 void gits::OpenGL::CState::Schedule(CScheduler& scheduler) const {
@@ -2159,6 +2175,12 @@ void gits::OpenGL::CVariableBufferInfo::Get() {
 
   BufferStateStash bufferStateStash;
 
+  std::unique_ptr<CStateReadback> readback;
+  const unsigned readbackBuffers = Configurator::Get().opengl.recorder.stateReadbackBuffers;
+  if (readbackBuffers > 0 && CStateReadback::Supported()) {
+    readback = std::make_unique<CStateReadback>(readbackBuffers);
+  }
+
   // get data of every known buffer
   auto iter = SD().GetCurrentSharedStateData().Buffers().List().begin();
   auto end = SD().GetCurrentSharedStateData().Buffers().List().end();
@@ -2188,6 +2210,11 @@ void gits::OpenGL::CVariableBufferInfo::Get() {
         void* ptr = drv.gl.glMapBufferOES(iter->Target(), GL_WRITE_ONLY);
         memcpy(&buffer[0], ptr, iter->Size());
         drv.gl.glUnmapBufferOES(iter->Target());
+      } else if (readback) {
+        readback->ReadBufferData(iter->Name(), iter->Size(),
+                                 [&buffer](const char* data, size_t size) {
+                                   memcpy(buffer.data(), data, size);
+                                 });
       } else {
         drv.gl.glGetBufferSubData(iter->Target(), 0, iter->Size(), &buffer[0]);
       }
@@ -2197,6 +2224,7 @@ void gits::OpenGL::CVariableBufferInfo::Get() {
       memcpy(static_cast<void*>(&buffer[0]), data_pointer, iter->Size());
     }
   }
+  readback.reset();
   bufferStateStash.Restore();
 }
 
@@ -2501,18 +2529,15 @@ void gits::OpenGL::CVariableTextureInfo::CTexture1D::GetTextureLevelsDataGL() {
   for (unsigned i = 0; i < MipmapData().size(); ++i) {
     const TMipmapTextureData& currMip = MipmapData().at(i);
 
-    std::vector<char> pixels;
     if (currMip.compressed == GL_TRUE) {
-      pixels.resize(currMip.compressedImageSize);
-      drv.gl.glGetCompressedTexImage(Target(), i, &pixels[0]);
+      GetCompressedLevelData(Target(), i, currMip.compressedImageSize,
+                             Texture1DData().pixels.at(i));
     } else {
-      pixels.resize(TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
-                    currMip.depth);
-      drv.gl.glGetTexImage(Target(), i, currMip.format, currMip.type, &pixels[0]);
+      GetLevelData(Target(), i, currMip.format, currMip.type,
+                   TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
+                       currMip.depth,
+                   Texture1DData().pixels.at(i));
     }
-
-    Texture1DData().pixels.at(i) =
-        CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &pixels[0], pixels.size());
   }
 }
 
@@ -2546,10 +2571,9 @@ void gits::OpenGL::CVariableTextureInfo::CTexture2D::GetTextureLevelsDataGL() {
   for (unsigned i = 0; i < MipmapData().size(); ++i) {
     const TMipmapTextureData& currMip = MipmapData().at(i);
 
-    std::vector<char> data;
     if (currMip.compressed == GL_TRUE && currMip.compressedImageSize > 0) {
-      data.resize(currMip.compressedImageSize);
-      drv.gl.glGetCompressedTexImage(Target(), i, &data[0]);
+      GetCompressedLevelData(Target(), i, currMip.compressedImageSize,
+                             Texture2DData().pixels.at(i));
     } else {
       auto format = currMip.format;
 #ifdef GITS_PLATFORM_WINDOWS
@@ -2561,12 +2585,9 @@ void gits::OpenGL::CVariableTextureInfo::CTexture2D::GetTextureLevelsDataGL() {
 #endif
 
       int size = TexelSize(format, currMip.type) * currMip.width * currMip.height * currMip.depth;
-      data.resize((size > 0) ? size : 1);
-      drv.gl.glGetTexImage(Target(), i, format, currMip.type, &data[0]);
+      GetLevelData(Target(), i, format, currMip.type, (size > 0) ? size : 1,
+                   Texture2DData().pixels.at(i));
     }
-
-    Texture2DData().pixels.at(i) =
-        CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &data[0], data.size());
   }
 }
 
@@ -2788,18 +2809,15 @@ void gits::OpenGL::CVariableTextureInfo::CTexture1DArray::GetTextureLevelsDataGL
   for (unsigned i = 0; i < MipmapData().size(); ++i) {
     const TMipmapTextureData& currMip = MipmapData().at(i);
 
-    std::vector<char> pixels;
     if (currMip.compressed == GL_TRUE) {
-      pixels.resize(currMip.compressedImageSize);
-      drv.gl.glGetCompressedTexImage(Target(), i, &pixels[0]);
+      GetCompressedLevelData(Target(), i, currMip.compressedImageSize,
+                             Texture1DArrayData().pixels.at(i));
     } else {
-      pixels.resize(TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
-                    currMip.depth);
-      drv.gl.glGetTexImage(Target(), i, currMip.format, currMip.type, &pixels[0]);
+      GetLevelData(Target(), i, currMip.format, currMip.type,
+                   TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
+                       currMip.depth,
+                   Texture1DArrayData().pixels.at(i));
     }
-
-    Texture1DArrayData().pixels.at(i) =
-        CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &pixels[0], pixels.size());
   }
 }
 
@@ -2850,18 +2868,15 @@ void gits::OpenGL::CVariableTextureInfo::CTexture2DArray::GetTextureLevelsDataGL
   for (unsigned i = 0; i < MipmapData().size(); ++i) {
     const TMipmapTextureData& currMip = MipmapData().at(i);
 
-    std::vector<char> pixels;
     if (currMip.compressed == GL_TRUE) {
-      pixels.resize(currMip.compressedImageSize);
-      drv.gl.glGetCompressedTexImage(Target(), i, &pixels[0]);
+      GetCompressedLevelData(Target(), i, currMip.compressedImageSize,
+                             Texture2DArrayData().pixels.at(i));
     } else {
-      pixels.resize(TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
-                    currMip.depth);
-      drv.gl.glGetTexImage(Target(), i, currMip.format, currMip.type, &pixels[0]);
+      GetLevelData(Target(), i, currMip.format, currMip.type,
+                   TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
+                       currMip.depth,
+                   Texture2DArrayData().pixels.at(i));
     }
-
-    Texture2DArrayData().pixels.at(i) =
-        CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &pixels[0], pixels.size());
   }
 }
 
@@ -2895,19 +2910,16 @@ void gits::OpenGL::CVariableTextureInfo::CTexture3D::GetTextureLevelsDataGL() {
   for (unsigned i = 0; i < MipmapData().size(); ++i) {
     const TMipmapTextureData& currMip = MipmapData().at(i);
 
-    std::vector<char> pixels;
     if (currMip.compressed == GL_TRUE) {
-      pixels.resize(currMip.compressedImageSize);
-      drv.gl.glGetCompressedTexImage(Target(), i, &pixels[0]);
+      GetCompressedLevelData(Target(), i, currMip.compressedImageSize,
+                             Texture3DData().pixels.at(i));
     } else {
-      pixels.resize(std::max(TexelSize(currMip.format, currMip.type) * currMip.width *
-                                 currMip.height * currMip.depth,
-                             1u));
-      drv.gl.glGetTexImage(Target(), i, currMip.format, currMip.type, &pixels[0]);
+      GetLevelData(Target(), i, currMip.format, currMip.type,
+                   std::max(TexelSize(currMip.format, currMip.type) * currMip.width *
+                                currMip.height * currMip.depth,
+                            1u),
+                   Texture3DData().pixels.at(i));
     }
-
-    Texture3DData().pixels.at(i) =
-        CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &pixels[0], pixels.size());
   }
 }
 
@@ -2947,19 +2959,15 @@ void gits::OpenGL::CVariableTextureInfo::CTextureCube::GetTextureLevelsDataGL()
 
       // Do not proceed with faulty textures
       if (currMip.width != 0) {
-        std::vector<char> pixels;
         if (currMip.compressed == GL_TRUE) {
-          pixels.resize(currMip.compressedImageSize);
-          drv.gl.glGetCompressedTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, i, &pixels[0]);
+          GetCompressedLevelData(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, i,
+                                 currMip.compressedImageSize, TextureCubeData().pixels[j].at(i));
         } else {
-          pixels.resize(TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
-                        currMip.depth);
-          drv.gl.glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, i, currMip.format, currMip.type,
-                               &pixels[0]);
+          GetLevelData(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, i, currMip.format, currMip.type,
+                       TexelSize(currMip.format, currMip.type) * currMip.width * currMip.height *
+                           currMip.depth,
+                       TextureCubeData().pixels[j].at(i));
         }
-
-        TextureCubeData().pixels[j].at(i) =
-            CGits::Instance().ResourceManager2().put(RESOURCE_TEXTURE, &pixels[0], pixels.size());
       }
     }
   }
@@ -3187,7 +3195,7 @@ unsigned gits::OpenGL::CVariableTextureInfo::CTexture::MipmapCount(GLenum target
 }
 
 gits::OpenGL::CVariableTextureInfo::CTexture::CTexture(GLint target, GLint id)
-    : _target(target), _id(id) {}
+    : _target(target), _id(id), _readback(nullptr) {}
 
 GLint gits::OpenGL::CVariableTextureInfo::CTexture::Target() const {
   return _target;
@@ -3343,7 +3351,43 @@ bool gits::OpenGL::CVariableTextureInfo::CTexture::AreESPixelsReadable(GLenum fo
   }
 }
 
-void gits::OpenGL::CVariableTextureInfo::CTexture::Get() {
+void gits::OpenGL::CVariableTextureInfo::CTexture::GetLevelData(
+    GLenum target, GLint level, GLenum format, GLenum type, size_t size, hash_t& hash) {
+  if (_readback != nullptr) {
+    _readback->ReadTexImage(target, level, format, type, size,
+                            [&hash](const char* data, size_t dataSize) {
+                              CStateReadback::PutResource(
+                                  RESOURCE_TEXTURE, std::vector<char>(data, data + dataSize), hash);
+                            });
+  } else {
+    std::vector<char> pixels(size);
+    drv.gl.glGetTexImage(target, level, format, type, pixels.data());
+    CStateReadback::PutResource(RESOURCE_TEXTURE, std::move(pixels), hash);
+  }
+}
+
+void gits::OpenGL::CVariableTextureInfo::CTexture::GetCompressedLevelData(GLenum target,
+                                                                          GLint level,
+                                                                          size_t size,
+                                                                          hash_t& hash) {
+  if (size == 0) {
+    hash = CResourceManager2::EmptyHash;
+  } else if (_readback != nullptr) {
+    _readback->ReadCompressedTexImage(target, level, size,
+                                      [&hash](const char* data, size_t dataSize) {
+                                        CStateReadback::PutResource(
+                                            RESOURCE_TEXTURE,
+                                            std::vector<char>(data, data + dataSize), hash);
+                                      });
+  } else {
+    std::vector<char> pixels(size);
+    drv.gl.glGetCompressedTexImage(target, level, pixels.data());
+    CStateReadback::PutResource(RESOURCE_TEXTURE, std::move(pixels), hash);
+  }
+}
+
+void gits::OpenGL::CVariableTextureInfo::CTexture::Get(CStateReadback* readback) {
+  _readback = readback;
   drv.gl.glBindTexture(Target(), TextureId());
   GetTextureGenericData(Target());
   // Textures content restoration works for OGL and in case of GL_TEXTURE_2D and
@@ -3357,6 +3401,7 @@ void gits::OpenGL::CVariableTextureInfo::CTexture::Get() {
               Target() == GL_TEXTURE_2D)) {
     GetTextureLevelsDataGLES();
   }
+  _readback = nullptr;
 }
 
 void gits::OpenGL::CVariableTextureInfo::CTexture::Schedule(
@@ -3442,6 +3487,12 @@ void gits::OpenGL::CVariableTextureInfo::Get() {
     }
   }
 
+  std::unique_ptr<CStateReadback> readback;
+  const unsigned readbackBuffers = Configurator::Get().opengl.recorder.stateReadbackBuffers;
+  if (readbackBuffers > 0 && CStateReadback::Supported()) {
+    readback = std::make_unique<CStateReadback>(readbackBuffers);
+  }
+
   for (; it != itEnd; ++it) {
     // if texture was bound with failed result it won't be reported by
     // glIsTexture - in such case we need to just skip this texture
@@ -3504,8 +3555,9 @@ void gits::OpenGL::CVariableTextureInfo::Get() {
     }
     // obtain data
     _textures.insert(texture);
-    texture->Get();
+    texture->Get(readback.get());
   }
+  readback.reset();
 
   if (origPbo != 0) {
     drv.gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, origPbo);
@@ -0,0 +1,209 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   openglStateReadback.cpp
+ *
+ * @brief Asynchronous readback of texture and buffer contents during OpenGL state capture.
+ *
+ */
+
+#include "openglStateReadback.h"
+#include "openglLibrary.h"
+#include "stateDynamic.h"
+#include "dump_pipeline.h"
+#include "gits.h"
+#include "log.h"
+#include "timer.h"
+
+#include <memory>
+
+namespace gits {
+namespace OpenGL {
+
+namespace {
+// Timeout of a single glClientWaitSync call, waits are repeated until the fence is signaled.
+const GLuint64 ReadbackWaitTimeout = 1000000000;
+
+struct TReadbackStats {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  int64_t waitTime = 0;
+};
+
+TReadbackStats readbackStats;
+std::unique_ptr<CDumpPipeline> resourceWriter;
+} // namespace
+
+CStateReadback::CStateReadback(unsigned slotCount)
+    : _origCopyReadBuffer(0), _origCopyWriteBuffer(0) {
+  drv.gl.glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &_origCopyReadBuffer);
+  drv.gl.glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &_origCopyWriteBuffer);
+
+  std::vector<GLuint> buffers(std::max(slotCount, 1u));
+  drv.gl.glGenBuffers((GLsizei)buffers.size(), buffers.data());
+  for (unsigned i = 0; i < buffers.size(); ++i) {
+    _slots.push_back({buffers[i], 0});
+    _freeSlots.push_back(i);
+  }
+}
+
+CStateReadback::~CStateReadback() {
+  try {
+    Finish();
+  } catch (...) {
+    topmost_exception_handler("CStateReadback::~CStateReadback");
+  }
+  for (auto& slot : _slots) {
+    drv.gl.glDeleteBuffers(1, &slot.buffer);
+  }
+  drv.gl.glBindBuffer(GL_COPY_READ_BUFFER, _origCopyReadBuffer);
+  drv.gl.glBindBuffer(GL_COPY_WRITE_BUFFER, _origCopyWriteBuffer);
+}
+
+bool CStateReadback::Supported() {
+  if (!curctx::IsOgl()) {
+    return false;
+  }
+  return curctx::Version() >= 320 ||
+         (drv.gl.HasExtension("GL_ARB_sync") &&
+          drv.gl.HasExtension("GL_ARB_pixel_buffer_object") &&
+          drv.gl.HasExtension("GL_ARB_copy_buffer") &&
+          drv.gl.HasExtension("GL_ARB_map_buffer_range"));
+}
+
+unsigned CStateReadback::AcquireSlot(size_t size) {
+  while (_freeSlots.empty()) {
+    Complete(true);
+  }
+  const unsigned slot = _freeSlots.back();
+  _freeSlots.pop_back();
+  if (_slots[slot].capacity < size) {
+    drv.gl.glBindBuffer(GL_COPY_WRITE_BUFFER, _slots[slot].buffer);
+    drv.gl.glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_READ);
+    _slots[slot].capacity = size;
+  }
+  return slot;
+}
+
+void CStateReadback::Submit(unsigned slot, size_t size, TCallback callback) {
+  GLsync fence = drv.gl.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  _pending.push_back({slot, fence, size, std::move(callback)});
+  readbackStats.count++;
+  readbackStats.bytes += size;
+
+  // Pick up copies finished in the meantime without blocking.
+  Complete(false);
+}
+
+void CStateReadback::Complete(bool wait) {
+  while (!_pending.empty()) {
+    CPending& pending = _pending.front();
+    if (wait) {
+      Timer waitTimer;
+      GLenum status = GL_TIMEOUT_EXPIRED;
+      while (status == GL_TIMEOUT_EXPIRED) {
+        status = drv.gl.glClientWaitSync(pending.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                         ReadbackWaitTimeout);
+      }
+      readbackStats.waitTime += waitTimer.Get();
+      if (status == GL_WAIT_FAILED) {
+        LOG_WARNING << "Waiting for state readback fence failed.";
+      }
+      // Only the oldest copy is waited for, the following ones are taken if already finished.
+      wait = false;
+    } else if (drv.gl.glClientWaitSync(pending.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) ==
+               GL_TIMEOUT_EXPIRED) {
+      // The flush submits the queued copies, otherwise they might not start before the
+      // ring is full and the oldest one is waited for.
+      return;
+    }
+    drv.gl.glDeleteSync(pending.fence);
+
+    drv.gl.glBindBuffer(GL_COPY_READ_BUFFER, _slots[pending.slot].buffer);
+    const void* data =
+        drv.gl.glMapBufferRange(GL_COPY_READ_BUFFER, 0, (GLsizeiptr)pending.size, GL_MAP_READ_BIT);
+    if (data != nullptr) {
+      pending.callback((const char*)data, pending.size);
+      drv.gl.glUnmapBuffer(GL_COPY_READ_BUFFER);
+    } else {
+      LOG_ERROR << "Mapping state readback buffer failed, resource content will not be restored.";
+    }
+
+    _freeSlots.push_back(pending.slot);
+    _pending.pop_front();
+  }
+}
+
+void CStateReadback::ReadTexImage(
+    GLenum target, GLint level, GLenum format, GLenum type, size_t size, TCallback callback) {
+  const unsigned slot = AcquireSlot(size);
+  drv.gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, _slots[slot].buffer);
+  drv.gl.glGetTexImage(target, level, format, type, nullptr);
+  drv.gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  Submit(slot, size, std::move(callback));
+}
+
+void CStateReadback::ReadCompressedTexImage(GLenum target,
+                                            GLint level,
+                                            size_t size,
+                                            TCallback callback) {
+  const unsigned slot = AcquireSlot(size);
+  drv.gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, _slots[slot].buffer);
+  drv.gl.glGetCompressedTexImage(target, level, nullptr);
+  drv.gl.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  Submit(slot, size, std::move(callback));
+}
+
+void CStateReadback::ReadBufferData(GLuint buffer, size_t size, TCallback callback) {
+  const unsigned slot = AcquireSlot(size);
+  drv.gl.glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+  drv.gl.glBindBuffer(GL_COPY_WRITE_BUFFER, _slots[slot].buffer);
+  drv.gl.glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)size);
+  Submit(slot, size, std::move(callback));
+}
+
+void CStateReadback::Finish() {
+  while (!_pending.empty()) {
+    Complete(true);
+  }
+}
+
+void CStateReadback::BeginCapture() {
+  readbackStats = TReadbackStats();
+  // A single writer puts resources in the order they were read back, so streams recorded
+  // from the same state are identical.
+  resourceWriter = std::make_unique<CDumpPipeline>(1);
+}
+
+void CStateReadback::EndCapture() {
+  if (!resourceWriter) {
+    return;
+  }
+  Timer writeTimer;
+  resourceWriter->Finish();
+  resourceWriter.reset();
+
+  LOG_INFO << "State capture readback: " << readbackStats.count << " copies, "
+           << readbackStats.bytes / (1024 * 1024) << " MB, waited for GPU "
+           << readbackStats.waitTime / 1000000 << " ms, waited for resource writes "
+           << writeTimer.Get() / 1000000 << " ms";
+}
+
+void CStateReadback::PutResource(TResourceType type, std::vector<char> data, hash_t& hash) {
+  if (!resourceWriter) {
+    hash = CGits::Instance().ResourceManager2().put(type, data.data(), data.size());
+    return;
+  }
+  resourceWriter->Schedule(std::move(data), [type, &hash](const std::vector<char>& snapshot) {
+    hash = CGits::Instance().ResourceManager2().put(type, snapshot.data(), snapshot.size());
+  });
+}
+
+} // namespace OpenGL
+} // namespace gits
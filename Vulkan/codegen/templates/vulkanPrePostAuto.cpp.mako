@@ -39,8 +39,7 @@ namespace {
 
   // Global thread synchronization
   std::recursive_mutex globalMutex;
-  std::condition_variable_any globalConditionVariable;
-  std::unordered_map<VkSemaphore, uint64_t> globalSemaphoreConditionMap;
+  CTimelineWaitRegistry<VkSemaphore> globalTimelineWaitRegistry;
 } // namespace
 
 void PrePostDisableVulkan() {
@@ -81,6 +80,23 @@ void CloseRecorderIfRequired() {
 #define GITS_MUTEX std::unique_lock<std::recursive_mutex> lock(globalMutex);
 #define GITS_ENTRY_VK GITS_MUTEX GITS_ENTRY
 
+#define GITS_ENTRY_VK_UNLOCKED                                      ${'\\'}
+  ++recursionDepth;                                                 ${'\\'}
+  IRecorderWrapper& wrapper = CGitsPluginVulkan::RecorderWrapper();
+
+// With per thread token buffers, command buffer recording functions call the driver
+// without the global mutex, only state tracking and token creation are serialized.
+// Vulkan requires external synchronization of command buffers, so the driver calls
+// of different threads touch different command buffers anyway.
+namespace {
+bool UnlockedCommandRecording() {
+  static const bool unlocked =
+      CGitsPluginVulkan::Configuration().common.recorder.perThreadTokenBuffers &&
+      !CGitsPluginVulkan::Configuration().common.recorder.highIntegrity;
+  return unlocked;
+}
+} // namespace
+
 extern "C" {
 % for token in vk_functions:
 <%
@@ -101,6 +117,15 @@ extern "C" {
 
     call: str = f'{store_return_value}{call_prefix}{token.name}({normal_args});'
 
+    unlocked_driver_call: bool = (
+        token.name.startswith('vkCmd')
+        and not token.recorder_exec_wrap
+        and not token.exec_post_recorder_wrap
+        and not token.wait_operation
+        and not token.signal_operation
+        and not token.end_frame_tag
+    )
+
     wrapper_call_args: str
     if token.exec_post_recorder_wrap:
         if token.return_value.type == 'VkResult':
@@ -118,6 +143,23 @@ VKATTRIB VISIBLE ${token.return_value.type} VKAPI_CALL ${token.name}(${params})
   % if token.level == FuncLevel.GLOBAL:
   CGitsPluginVulkan::Initialize();
   % endif
+  % if unlocked_driver_call:
+  if (UnlockedCommandRecording()) {
+    GITS_ENTRY_VK_UNLOCKED
+    ${call}
+    GITS_MUTEX
+    thread_tracker();
+    GITS_WRAPPER_PRE
+    wrapper.${token.name}(${wrapper_call_args});
+    GITS_WRAPPER_POST
+  } else {
+    GITS_ENTRY_VK
+    ${call}
+    GITS_WRAPPER_PRE
+    wrapper.${token.name}(${wrapper_call_args});
+    GITS_WRAPPER_POST
+  }
+  % else:
   GITS_ENTRY_VK
   % if token.wait_operation:
   waitOperation_${token.name}(${normal_args}, lock);
@@ -137,6 +179,7 @@ VKATTRIB VISIBLE ${token.return_value.type} VKAPI_CALL ${token.name}(${params})
   % if token.signal_operation:
   signalOperation_${token.name}(${normal_args});
   % endif
+  % endif
   % if has_retval:
   return return_value;
   % endif
@@ -11,6 +11,7 @@
 #include "argument.h"
 #include "vulkanHeader.h"
 #include "vectorMapper.h"
+#include "handleMap.h"
 
 namespace gits {
 namespace Vulkan {
@@ -19,7 +20,7 @@ namespace Vulkan {
 template <typename T, typename TTypeTag>
 class CVulkanObj : public CArgument {
 protected:
-  typedef std::unordered_map<T, T> name_map_t;
+  typedef HandleRemapper<T> name_map_t;
   typedef VectorMapper<T, 100000> name_vec_map_t;
   T key_;
   typedef typename std::vector<T>::size_type size_type;
@@ -37,7 +38,7 @@ public:
     if (useVectorMapper()) {
       get_vector_mapper()[(size_type)key] = value;
     } else {
-      get_map()[key] = value;
+      get_map().Add(key, value);
     }
   }
 
@@ -59,7 +60,7 @@ public:
     if (useVectorMapper()) {
       get_vector_mapper().Unmap((size_type)key);
     } else {
-      get_map().erase(key);
+      get_map().Remove(key);
     }
   }
 
@@ -81,8 +82,8 @@ public:
       }
       return val;
     } else {
-      auto iter = get_map().find(key);
-      if (iter == get_map().end()) {
+      T value;
+      if (!get_map().Get(key, value)) {
         if (Configurator::IsPlayer()) {
           LOG_ERROR << "Couldn't map Vulkan object name " << key;
           throw std::runtime_error(EXCEPTION_MESSAGE);
@@ -90,22 +91,32 @@ public:
           return key;
         }
       }
-      return iter->second;
+      return value;
     }
   }
 
   static void GetMapping(const T* keys, T* values, size_t num) {
-    for (size_t i = 0; i < num; ++i) {
-      values[i] = GetMapping(keys[i]);
+    if (useVectorMapper()) {
+      for (size_t i = 0; i < num; ++i) {
+        values[i] = GetMapping(keys[i]);
+      }
+      return;
+    }
+    // Batch lookup; unmapped (or null) names go through the regular path,
+    // which handles errors, and the batch continues after them.
+    size_t done = 0;
+    while (done < num) {
+      done += get_map().FindBatch(keys + done, values + done, num - done);
+      if (done < num) {
+        values[done] = GetMapping(keys[done]);
+        done++;
+      }
     }
   }
 
   static std::vector<T> GetMapping(const T* keys, size_t num) {
-    std::vector<T> v;
-    v.reserve(num);
-    for (size_t i = 0; i < num; ++i) {
-      v.push_back(GetMapping(keys[i]));
-    }
+    std::vector<T> v(num);
+    GetMapping(keys, v.data(), num);
     return v;
   }
 
@@ -118,8 +129,7 @@ public:
         return true;
       }
     } else {
-      auto& the_map = get_map();
-      return the_map.find(key) != the_map.end();
+      return get_map().Find(key) != nullptr;
     }
   }
 
@@ -136,12 +146,12 @@ public:
       }
       return &vector_mapper[(size_type)key_];
     } else {
-      auto& map = get_map();
-      if (map.find(key_) == map.end()) {
+      T* value = get_map().Find(key_);
+      if (value == nullptr) {
         LOG_ERROR << "Couldn't map Vulkan object name " << key_;
         throw std::runtime_error(EXCEPTION_MESSAGE);
       }
-      return &map[key_];
+      return value;
     }
   }
 
@@ -192,7 +202,7 @@ private:
     INIT_NEW_STATIC_OBJ(objects_map, name_map_t)
     static bool initialized = false;
     if (!initialized) {
-      objects_map[0] = 0;
+      objects_map.Add((T)0, (T)0);
       initialized = true;
     }
     return objects_map;
@@ -12,6 +12,8 @@
 #include "dynamic_linker.h"
 
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <cstdint>
 
@@ -92,6 +94,14 @@ public:
   template <typename HANDLE>
   CVkInstanceDispatchTable& GetInstanceDispatchTable(HANDLE handle) {
     auto dispatchMapKey = GetDispatchKey(handle);
+    {
+      std::shared_lock<std::shared_mutex> lock(DispatchTablesMutex);
+      auto iterator = InstanceDispatchTables.find(dispatchMapKey);
+      if (iterator != InstanceDispatchTables.end()) {
+        return *iterator->second;
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(DispatchTablesMutex);
     auto iterator = InstanceDispatchTables.find(dispatchMapKey);
     if (iterator == InstanceDispatchTables.end()) {
       auto insert_result = InstanceDispatchTables.insert(
@@ -105,6 +115,14 @@ public:
   template <typename HANDLE>
   CVkDeviceDispatchTable& GetDeviceDispatchTable(HANDLE handle) {
     auto dispatchMapKey = GetDispatchKey(handle);
+    {
+      std::shared_lock<std::shared_mutex> lock(DispatchTablesMutex);
+      auto iterator = DeviceDispatchTables.find(dispatchMapKey);
+      if (iterator != DeviceDispatchTables.end()) {
+        return *iterator->second;
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(DispatchTablesMutex);
     auto iterator = DeviceDispatchTables.find(dispatchMapKey);
     if (iterator == DeviceDispatchTables.end()) {
       auto insert_result = DeviceDispatchTables.insert(
@@ -136,6 +154,8 @@ private:
   CVkGlobalDispatchTable GlobalDispatchTable;
   std::unordered_map<void*, std::unique_ptr<CVkInstanceDispatchTable>> InstanceDispatchTables;
   std::unordered_map<void*, std::unique_ptr<CVkDeviceDispatchTable>> DeviceDispatchTables;
+  // Command buffer level functions are called without the recorder's global mutex.
+  std::shared_mutex DispatchTablesMutex;
 };
 
 extern CVkDriver drvVk;
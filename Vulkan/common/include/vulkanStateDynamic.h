@@ -20,6 +20,7 @@
 #include "intervalSet.h"
 
 #include <array>
+#include <functional>
 #include <unordered_set>
 
 #include "configurationLib.h"
@@ -152,6 +153,42 @@ public:
       VkBuffer buffer);
 };
 
+// Object dependency graph
+
+// Keeps, per Vulkan handle, the list of handles its state depends on. Edge lists
+// are resolved once per state object (identified by its unique state ID) and
+// reused until the object is invalidated (rebinding, descriptor updates) or
+// removed. Closures are computed with epoch-based visited marking, so each
+// reachable object is expanded exactly once per query.
+class CObjectDependencyGraph {
+public:
+  // Returns unique state ID of the object (0 if no state exists for a given handle).
+  // When dependencies is not null, it is filled with handles the object depends on.
+  typedef std::function<uint64_t(uint64_t object, std::vector<uint64_t>* dependencies)>
+      TDependencyResolver;
+
+private:
+  struct Node {
+    uint64_t stateID;
+    uint64_t visitedEpoch;
+    bool valid;
+    std::vector<uint64_t> dependencies;
+
+    Node() : stateID(0), visitedEpoch(0), valid(false) {}
+  };
+
+  std::unordered_map<uint64_t, Node> _nodes;
+  uint64_t _epoch;
+
+public:
+  CObjectDependencyGraph() : _epoch(0) {}
+  void Invalidate(uint64_t object);
+  void Remove(uint64_t object);
+  void Clear();
+  std::set<uint64_t> GetClosure(const std::set<uint64_t>& roots,
+                                const TDependencyResolver& resolver);
+};
+
 // Creation function
 
 enum class CreationFunction {
@@ -1931,9 +1968,14 @@ public:
       bindingBuffers;
   std::unordered_map<VkCommandBuffer, std::unordered_set<std::shared_ptr<CImageState>>>
       bindingImages;
+  // Host-visible memory bound to bindingBuffers and bindingImages of a command buffer. Gathered
+  // once per recording, submits only check which of these memory objects are mapped.
+  std::unordered_map<VkCommandBuffer, std::vector<std::shared_ptr<CDeviceMemoryState>>>
+      mappableMemoryInCmdBuffer;
   std::unordered_map<VkCommandBuffer, CMemoryUpdateState> updatedMemoryInCmdBuffer;
   std::shared_ptr<CQueueSubmitState> lastQueueSubmit;
   std::set<uint64_t> objectsUsedInQueueSubmit;
+  CObjectDependencyGraph objectDependencyGraph;
   CInternalResources internalResources;
   std::unordered_set<VkImage> nonDeterministicImages;
   std::unordered_map<VkImage, uint64_t> imageCounter;
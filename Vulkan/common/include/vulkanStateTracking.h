@@ -654,6 +654,7 @@ inline void vkDestroyCommandPool_SD(VkDevice device,
       if (updateOnlyUsedMemory() || isSubcaptureBeforeRestorationPhase()) {
         SD().bindingBuffers.erase(commandBufferState->commandBufferHandle);
         SD().bindingImages.erase(commandBufferState->commandBufferHandle);
+        SD().mappableMemoryInCmdBuffer.erase(commandBufferState->commandBufferHandle);
       }
 
       if (Configurator::Get().vulkan.recorder.memorySegmentSize ||
@@ -862,6 +863,7 @@ inline void vkFreeMemory_SD(VkDevice device,
              << " MB; CPU_GPU_Shared: " << SD().currentlyAllocatedMemoryCPU_GPU / 1000000
              << " MB; Currently mapped memory: " << SD().currentlyMappedMemory / 1000000 << " MB";
   }
+  SD().objectDependencyGraph.Remove((uint64_t)memory);
   SD()._devicememorystates.erase(memory); // Stardust
 }
 
@@ -891,6 +893,7 @@ inline void vkDestroyImage_SD(VkDevice device,
     }
   }
   SD().nonDeterministicImages.erase(image);
+  SD().objectDependencyGraph.Remove((uint64_t)image);
   SD()._imagestates.erase(image); // Stardust ImageView
 }
 
@@ -928,6 +931,7 @@ void BindImageMemory_SDHelper(VkImage image, VkDeviceMemory memory, VkDeviceSize
   auto& imageState = SD()._imagestates[image];
   imageState->binding.reset(new CMemoryBinding(memOffset, imageState->memoryRequirements.size,
                                                SD()._devicememorystates[memory]));
+  SD().objectDependencyGraph.Invalidate((uint64_t)image);
 
   if (Configurator::IsRecorder() && isSubcaptureBeforeRestorationPhase()) {
     imageState->binding->deviceMemoryStateStore->aliasingTracker.AddImage(
@@ -978,6 +982,7 @@ inline void vkCreateImageView_SD(VkResult return_value,
 inline void vkDestroyImageView_SD(VkDevice device,
                                   VkImageView imageView,
                                   const VkAllocationCallbacks* pAllocator) {
+  SD().objectDependencyGraph.Remove((uint64_t)imageView);
   SD()._imageviewstates.erase(imageView); // Stardust UpdateDescription
 }
 
@@ -1051,6 +1056,7 @@ inline void vkDestroyBuffer_SD(VkDevice device,
     // CBufferState::shaderDeviceAddressBuffers.erase(buffer);
   }
 
+  SD().objectDependencyGraph.Remove((uint64_t)buffer);
   SD()._bufferstates.erase(buffer); //SDK
 }
 
@@ -1088,6 +1094,7 @@ void BindBufferMemory_SDHelper(VkBuffer buffer, VkDeviceMemory memory, VkDeviceS
   auto& bufferState = SD()._bufferstates[buffer];
   bufferState->binding.reset(new CMemoryBinding(memOffset, bufferState->memoryRequirements.size,
                                                 SD()._devicememorystates[memory]));
+  SD().objectDependencyGraph.Invalidate((uint64_t)buffer);
 
   if (isBitSet(bufferState->bufferCreateInfoData.Value()->usage,
                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)) {
@@ -1286,6 +1293,7 @@ inline void vkUpdateDescriptorSets_SD(VkDevice device,
 
     for (unsigned int i = 0; i < descriptorWriteCount; i++) {
       auto& descriptorSetState = SD()._descriptorsetstates[pDescriptorWrites[i].dstSet];
+      SD().objectDependencyGraph.Invalidate((uint64_t)pDescriptorWrites[i].dstSet);
 
       uint32_t currentBinding = pDescriptorWrites[i].dstBinding;
       uint32_t currentArrayOffset = pDescriptorWrites[i].dstArrayElement;
@@ -1510,6 +1518,7 @@ inline void vkUpdateDescriptorSets_SD(VkDevice device,
     for (unsigned int i = 0; i < descriptorCopyCount; i++) {
       const auto& srcDescriptorSetState = SD()._descriptorsetstates[pDescriptorCopies[i].srcSet];
       const auto& dstDescriptorSetState = SD()._descriptorsetstates[pDescriptorCopies[i].dstSet];
+      SD().objectDependencyGraph.Invalidate((uint64_t)pDescriptorCopies[i].dstSet);
 
       if (isSubcaptureBeforeRestorationPhase()) {
         uint32_t srcArrayOffset = pDescriptorCopies[i].srcArrayElement;
@@ -1581,6 +1590,7 @@ inline void vkFreeDescriptorSets_SD(VkResult return_value,
       SD()._descriptorpoolstates[descriptorPool]->descriptorSetStateStoreList.erase(
           SD()._descriptorsetstates
               [pDescriptorSets[i]]); // <- check if descriptorSetState is removed correctly
+      SD().objectDependencyGraph.Remove((uint64_t)pDescriptorSets[i]);
       SD()._descriptorsetstates.erase(pDescriptorSets[i]); // Stardust
     }
   }
@@ -1708,6 +1718,7 @@ inline void vkUpdateDescriptorSetWithTemplate_SD(
     CAutoCaller autoCaller(drvVk.vkPauseRecordingGITS, drvVk.vkContinueRecordingGITS);
 
     const auto& descriptorSetState = SD()._descriptorsetstates[descriptorSet];
+    SD().objectDependencyGraph.Invalidate((uint64_t)descriptorSet);
     const auto& descriptorUpdateTemplateState =
         SD()._descriptorupdatetemplatestates[descriptorUpdateTemplate];
     const auto* descriptorUpdateTemplateCreateInfoData =
@@ -2471,11 +2482,13 @@ inline void vkFreeCommandBuffers_SD(VkDevice device,
 
     SD()._commandpoolstates[commandPool]->commandBufferStateStoreList.erase(
         SD()._commandbufferstates[pCommandBuffers[i]]);
+    SD().objectDependencyGraph.Remove((uint64_t)pCommandBuffers[i]);
     SD()._commandbufferstates.erase(pCommandBuffers[i]);
 
     if (Configurator::IsRecorder()) {
       SD().bindingBuffers.erase(pCommandBuffers[i]);
       SD().bindingImages.erase(pCommandBuffers[i]);
+      SD().mappableMemoryInCmdBuffer.erase(pCommandBuffers[i]);
 
       if (Configurator::Get().vulkan.recorder.memorySegmentSize ||
           Configurator::Get().vulkan.recorder.shadowMemory) {
@@ -2490,6 +2503,7 @@ inline void vkResetCommandBuffer_SD(VkResult /* return_value */,
                                     VkCommandBufferResetFlags /* flags */,
                                     bool stateRestore) {
   auto& commandBufferState = SD()._commandbufferstates[cmdBuf];
+  SD().objectDependencyGraph.Invalidate((uint64_t)cmdBuf);
 
   if (!stateRestore) {
     // In stateRestore, these are used for RenderPass mode preparation, so we can't reset them.
@@ -2549,6 +2563,7 @@ inline void vkResetCommandBuffer_SD(VkResult /* return_value */,
   if (Configurator::IsRecorder()) {
     SD().bindingBuffers[cmdBuf].clear();
     SD().bindingImages[cmdBuf].clear();
+    SD().mappableMemoryInCmdBuffer.erase(cmdBuf);
 
     if (Configurator::Get().vulkan.recorder.memorySegmentSize ||
         Configurator::Get().vulkan.recorder.shadowMemory) {
@@ -2606,8 +2621,46 @@ inline void vkBeginCommandBuffer_SD(VkResult /* return_value */,
   }
 }
 
+// Memory bound to resources can't change while the resources are in use, so the list stays
+// valid until the command buffer is reset. Freed memory is unmapped and skipped on submit.
+inline const std::vector<std::shared_ptr<CDeviceMemoryState>>& getMappableMemoryInCmdBuffer(
+    VkCommandBuffer cmdBuf) {
+  auto it = SD().mappableMemoryInCmdBuffer.find(cmdBuf);
+  if (it != SD().mappableMemoryInCmdBuffer.end()) {
+    return it->second;
+  }
+
+  auto& mappableMemory = SD().mappableMemoryInCmdBuffer[cmdBuf];
+  std::unordered_set<VkDeviceMemory> gatheredMemory;
+  auto addBinding = [&](const std::shared_ptr<CMemoryBinding>& binding) {
+    if (!binding || !binding->deviceMemoryStateStore) {
+      return;
+    }
+    const auto& memoryState = binding->deviceMemoryStateStore;
+    if (gatheredMemory.insert(memoryState->deviceMemoryHandle).second &&
+        checkMemoryMappingFeasibility(memoryState->deviceStateStore->deviceHandle,
+                                      memoryState->memoryAllocateInfoData.Value()->memoryTypeIndex,
+                                      false)) {
+      mappableMemory.push_back(memoryState);
+    }
+  };
+  for (const auto& bufferState : SD().bindingBuffers[cmdBuf]) {
+    addBinding(bufferState->binding);
+  }
+  for (const auto& imageState : SD().bindingImages[cmdBuf]) {
+    addBinding(imageState->binding);
+  }
+  return mappableMemory;
+}
+
 inline void vkEndCommandBuffer_SD(VkResult return_value, VkCommandBuffer cmdBuf) {
   SD()._commandbufferstates[cmdBuf]->ended = true;
+  SD().objectDependencyGraph.Invalidate((uint64_t)cmdBuf);
+
+  if (Configurator::IsRecorder() && updateOnlyUsedMemory()) {
+    SD().mappableMemoryInCmdBuffer.erase(cmdBuf);
+    getMappableMemoryInCmdBuffer(cmdBuf);
+  }
 }
 
 // Deferred operation
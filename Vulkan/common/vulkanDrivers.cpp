@@ -603,6 +603,7 @@ void CVkDriver::Destroy(VkInstance instance, const VkAllocationCallbacks* pAlloc
 
   drvVk.GetInstanceDispatchTable(instance).vkDestroyInstance(instance, pAllocator);
 
+  std::unique_lock<std::shared_mutex> lock(DispatchTablesMutex);
   InstanceDispatchTables.erase(dispatchMapKey);
 }
 
@@ -616,6 +617,7 @@ void CVkDriver::Destroy(VkDevice device, const VkAllocationCallbacks* pAllocator
 
   drvVk.GetDeviceDispatchTable(device).vkDestroyDevice(device, pAllocator);
 
+  std::unique_lock<std::shared_mutex> lock(DispatchTablesMutex);
   DeviceDispatchTables.erase(dispatchMapKey);
 }
 
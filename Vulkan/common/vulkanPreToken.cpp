@@ -167,6 +167,7 @@ gits::Vulkan::CGitsVkMemoryUpdate2::CGitsVkMemoryUpdate2(VkDeviceMemory memory,
 
   auto& memoryState = SD()._devicememorystates[memory];
   char* pointer = (char*)memoryState->mapping->pData;
+  std::vector<std::pair<size_t, size_t>> flushRanges;
 
   for (uint32_t i = 0; i < regionCount; ++i) {
     size_t offset = (size_t)pRegions[i].dstOffset;
@@ -190,9 +191,12 @@ gits::Vulkan::CGitsVkMemoryUpdate2::CGitsVkMemoryUpdate2(VkDeviceMemory memory,
       if (CGits::Instance().apis.Iface3D().CfgRec_IsSubcapture()) {
         offset_flush += memoryState->mapping->offset;
       }
-      memoryState->shadowMemory->Flush(offset_flush, length);
+      flushRanges.push_back({offset_flush, length});
     }
   }
+  if (!flushRanges.empty()) {
+    memoryState->shadowMemory->Flush(flushRanges);
+  }
 }
 
 void gits::Vulkan::CGitsVkMemoryUpdate2::Run() {
@@ -246,6 +246,65 @@ CPipelineState::CShaderGroupHandlesManagement::~CShaderGroupHandlesManagement()
   }
 }
 
+//------------------------------- OBJECT DEPENDENCY GRAPH ---------------------------------
+void CObjectDependencyGraph::Invalidate(uint64_t object) {
+  auto it = _nodes.find(object);
+  if (it != _nodes.end()) {
+    it->second.valid = false;
+    it->second.dependencies.clear();
+  }
+}
+
+void CObjectDependencyGraph::Remove(uint64_t object) {
+  _nodes.erase(object);
+}
+
+void CObjectDependencyGraph::Clear() {
+  _nodes.clear();
+}
+
+std::set<uint64_t> CObjectDependencyGraph::GetClosure(const std::set<uint64_t>& roots,
+                                                      const TDependencyResolver& resolver) {
+  std::set<uint64_t> closure;
+  std::vector<uint64_t> stack(roots.begin(), roots.end());
+  ++_epoch;
+
+  while (!stack.empty()) {
+    uint64_t object = stack.back();
+    stack.pop_back();
+    closure.insert(object);
+
+    auto& node = _nodes[object];
+    if (node.visitedEpoch == _epoch) {
+      continue;
+    }
+    node.visitedEpoch = _epoch;
+
+    // Handles may be reused by the driver after destruction, so the cached
+    // edges are valid only for the same state object they were resolved for.
+    uint64_t stateID = resolver(object, nullptr);
+    if (stateID == 0) {
+      node.valid = false;
+      node.dependencies.clear();
+      continue;
+    }
+    if (!node.valid || node.stateID != stateID) {
+      node.dependencies.clear();
+      resolver(object, &node.dependencies);
+      node.stateID = stateID;
+      node.valid = true;
+    }
+
+    for (auto dependency : node.dependencies) {
+      auto found = _nodes.find(dependency);
+      if (found == _nodes.end() || found->second.visitedEpoch != _epoch) {
+        stack.push_back(dependency);
+      }
+    }
+  }
+  return closure;
+}
+
 // Memory aliasing tracker
 
 // Kudos to Piotr Horodecki
@@ -1110,9 +1110,12 @@ bool writeScreenshotUtil(std::string fileName,
         try {
           std::vector<uint8_t> convertedData(width * height * 4);
           bool depthInProperRange = true;
+          // Screenshots are converted one at a time, so large ones can use all hardware threads.
+          const unsigned convertThreads = 0;
           if (target[l][m][a].aspect == VK_IMAGE_ASPECT_COLOR_BIT) {
             convert_texture_data(getTexelToConvertFromImageFormat(imageState->imageFormat),
-                                 screenshotData, texel_type::RGBA8, convertedData, width, height);
+                                 screenshotData, texel_type::RGBA8, convertedData, width, height,
+                                 convertThreads);
           } else if (target[l][m][a].aspect == VK_IMAGE_ASPECT_DEPTH_BIT) {
             auto fmt = imageState->imageFormat;
             std::pair<double, double> minMaxValues(0.0, 0.0);
@@ -1120,15 +1123,15 @@ bool writeScreenshotUtil(std::string fileName,
               minMaxValues = get_min_max_values(texel_type::R32f, screenshotData, width, height);
               normalize_texture_data(texel_type::R32f, screenshotData, width, height);
               convert_texture_data(texel_type::R32f, screenshotData, texel_type::RGBA8,
-                                   convertedData, width, height);
+                                   convertedData, width, height, convertThreads);
             } else if (fmt == VK_FORMAT_D24_UNORM_S8_UINT || fmt == VK_FORMAT_X8_D24_UNORM_PACK32) {
               normalize_texture_data(texel_type::D24, screenshotData, width, height);
               convert_texture_data(texel_type::D24, screenshotData, texel_type::RGBA8,
-                                   convertedData, width, height);
+                                   convertedData, width, height, convertThreads);
             } else if (fmt == VK_FORMAT_D16_UNORM || fmt == VK_FORMAT_D16_UNORM_S8_UINT) {
               normalize_texture_data(texel_type::R16, screenshotData, width, height);
               convert_texture_data(texel_type::R16, screenshotData, texel_type::RGBA8,
-                                   convertedData, width, height);
+                                   convertedData, width, height, convertThreads);
             }
 
             if ((minMaxValues.first < 0.0 || minMaxValues.second > 1.0) &&
@@ -1143,7 +1146,7 @@ bool writeScreenshotUtil(std::string fileName,
           } else if (target[l][m][a].aspect == VK_IMAGE_ASPECT_STENCIL_BIT) {
             normalize_texture_data(texel_type::R8, screenshotData, width, height);
             convert_texture_data(texel_type::R8, screenshotData, texel_type::RGBA8, convertedData,
-                                 width, height);
+                                 width, height, convertThreads);
           }
           {
             std::stringstream nameSuffix;
@@ -2395,8 +2398,9 @@ void getRangesForMemoryUpdate(VkDeviceMemory memory,
   } else if (Configurator::Get().vulkan.recorder.memoryAccessDetection) {
     std::pair<const void*, size_t> baseRange = {pointer, (size_t)unmapSize};
     auto sniffedRegionHandle = mapping->sniffedRegionHandle;
-    std::vector<std::pair<uint64_t, uint64_t>> pagesMap =
-        GetIntervalSetFromMemoryPages(baseRange, (**sniffedRegionHandle).GetTouchedPagesAndReset());
+    std::vector<std::pair<uint64_t, uint64_t>> pagesMap = GetIntervalSetFromMemoryPages(
+        baseRange, (**sniffedRegionHandle).GetTouchedPagesAndReset(),
+        Configurator::Get().vulkan.recorder.touchedPagesMergeGap);
 
     if (!unmap) {
       if (!MemorySniffer::Get().Protect(sniffedRegionHandle)) {
@@ -2477,11 +2481,10 @@ void flushShadowMemory(VkDeviceMemory memory, bool unmap) {
   uint64_t offset = mapping->offset;
 
   if (Configurator::Get().vulkan.recorder.memoryAccessDetection) {
-    std::pair<const void*, size_t> baseRange;
-    baseRange.first = pointer;
-    baseRange.second = unmapSize;
-    auto subRange = GetSubrangeOverlappingMemoryPages(
-        baseRange, (**mapping->sniffedRegionHandle).GetTouchedPagesAndReset());
+    std::pair<const void*, size_t> baseRange = {pointer, (size_t)unmapSize};
+    std::vector<std::pair<uint64_t, uint64_t>> pagesMap = GetIntervalSetFromMemoryPages(
+        baseRange, (**mapping->sniffedRegionHandle).GetTouchedPagesAndReset(),
+        Configurator::Get().vulkan.recorder.touchedPagesMergeGap);
 
     if (!unmap) {
       if (!MemorySniffer::Get().Protect(mapping->sniffedRegionHandle)) {
@@ -2491,12 +2494,15 @@ void flushShadowMemory(VkDeviceMemory memory, bool unmap) {
       }
     }
 
-    offset += (uint64_t)subRange.first - (uint64_t)pointer;
-    unmapSize = subRange.second;
-
-    if (unmapSize == 0) {
-      return;
+    // Only the touched page runs are flushed, not the range spanning all of them.
+    std::vector<std::pair<size_t, size_t>> flushRanges;
+    flushRanges.reserve(pagesMap.size());
+    for (auto& startEndPtrPair : pagesMap) {
+      flushRanges.push_back({(size_t)(startEndPtrPair.first - (uint64_t)pointer + offset),
+                             (size_t)(startEndPtrPair.second - startEndPtrPair.first)});
     }
+    memoryState->shadowMemory->Flush(flushRanges);
+    return;
   }
 
   if (Configurator::Get().vulkan.recorder.writeWatchDetection) {
@@ -2513,133 +2519,65 @@ void flushShadowMemory(VkDeviceMemory memory, bool unmap) {
   }
 }
 
-std::set<uint64_t> getRelatedPointers(std::set<uint64_t>& originalSet) {
-  std::set<uint64_t> relatedPointers;
-  for (uint64_t obj : originalSet) {
-    if (SD()._instancestates.find((VkInstance)obj) != SD()._instancestates.end()) {
-      for (auto& elem : SD()._instancestates[(VkInstance)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._physicaldevicestates.find((VkPhysicalDevice)obj) !=
-               SD()._physicaldevicestates.end()) {
-      for (auto& elem : SD()._physicaldevicestates[(VkPhysicalDevice)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._surfacekhrstates.find((VkSurfaceKHR)obj) != SD()._surfacekhrstates.end()) {
-      for (auto& elem : SD()._surfacekhrstates[(VkSurfaceKHR)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._devicestates.find((VkDevice)obj) != SD()._devicestates.end()) {
-      for (auto& elem : SD()._devicestates[(VkDevice)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._swapchainkhrstates.find((VkSwapchainKHR)obj) !=
-               SD()._swapchainkhrstates.end()) {
-      for (auto& elem : SD()._swapchainkhrstates[(VkSwapchainKHR)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._descriptorpoolstates.find((VkDescriptorPool)obj) !=
-               SD()._descriptorpoolstates.end()) {
-      for (auto& elem : SD()._descriptorpoolstates[(VkDescriptorPool)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._commandpoolstates.find((VkCommandPool)obj) != SD()._commandpoolstates.end()) {
-      for (auto& elem : SD()._commandpoolstates[(VkCommandPool)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._samplerstates.find((VkSampler)obj) != SD()._samplerstates.end()) {
-      for (auto& elem : SD()._samplerstates[(VkSampler)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._devicememorystates.find((VkDeviceMemory)obj) !=
-               SD()._devicememorystates.end()) {
-      for (auto& elem : SD()._devicememorystates[(VkDeviceMemory)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._imagestates.find((VkImage)obj) != SD()._imagestates.end()) {
-      for (auto& elem : SD()._imagestates[(VkImage)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._imageviewstates.find((VkImageView)obj) != SD()._imageviewstates.end()) {
-      for (auto& elem : SD()._imageviewstates[(VkImageView)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._bufferstates.find((VkBuffer)obj) != SD()._bufferstates.end()) {
-      for (auto& elem : SD()._bufferstates[(VkBuffer)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._bufferviewstates.find((VkBufferView)obj) != SD()._bufferviewstates.end()) {
-      for (auto& elem : SD()._bufferviewstates[(VkBufferView)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._descriptorsetlayoutstates.find((VkDescriptorSetLayout)obj) !=
-               SD()._descriptorsetlayoutstates.end()) {
-      for (auto& elem :
-           SD()._descriptorsetlayoutstates[(VkDescriptorSetLayout)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._descriptorsetstates.find((VkDescriptorSet)obj) !=
-               SD()._descriptorsetstates.end()) {
-      for (auto& elem : SD()._descriptorsetstates[(VkDescriptorSet)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._pipelinelayoutstates.find((VkPipelineLayout)obj) !=
-               SD()._pipelinelayoutstates.end()) {
-      for (auto& elem : SD()._pipelinelayoutstates[(VkPipelineLayout)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._descriptorupdatetemplatestates.find((VkDescriptorUpdateTemplate)obj) !=
-               SD()._descriptorupdatetemplatestates.end()) {
-      for (auto& elem : SD()._descriptorupdatetemplatestates[(VkDescriptorUpdateTemplate)obj]
-                            ->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._pipelinecachestates.find((VkPipelineCache)obj) !=
-               SD()._pipelinecachestates.end()) {
-      for (auto& elem : SD()._pipelinecachestates[(VkPipelineCache)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._shadermodulestates.find((VkShaderModule)obj) !=
-               SD()._shadermodulestates.end()) {
-      for (auto& elem : SD()._shadermodulestates[(VkShaderModule)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._renderpassstates.find((VkRenderPass)obj) != SD()._renderpassstates.end()) {
-      for (auto& elem : SD()._renderpassstates[(VkRenderPass)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._pipelinestates.find((VkPipeline)obj) != SD()._pipelinestates.end()) {
-      for (auto& elem : SD()._pipelinestates[(VkPipeline)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._framebufferstates.find((VkFramebuffer)obj) != SD()._framebufferstates.end()) {
-      for (auto& elem : SD()._framebufferstates[(VkFramebuffer)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._fencestates.find((VkFence)obj) != SD()._fencestates.end()) {
-      for (auto& elem : SD()._fencestates[(VkFence)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._eventstates.find((VkEvent)obj) != SD()._eventstates.end()) {
-      for (auto& elem : SD()._eventstates[(VkEvent)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._semaphorestates.find((VkSemaphore)obj) != SD()._semaphorestates.end()) {
-      for (auto& elem : SD()._semaphorestates[(VkSemaphore)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._querypoolstates.find((VkQueryPool)obj) != SD()._querypoolstates.end()) {
-      for (auto& elem : SD()._querypoolstates[(VkQueryPool)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    } else if (SD()._commandbufferstates.find((VkCommandBuffer)obj) !=
-               SD()._commandbufferstates.end()) {
-      for (auto& elem : SD()._commandbufferstates[(VkCommandBuffer)obj]->GetMappedPointers()) {
-        relatedPointers.insert(elem);
-      }
-    }
+namespace {
+
+template <class STATES>
+bool resolveStateDependencies(STATES& states,
+                              uint64_t object,
+                              uint64_t& stateID,
+                              std::vector<uint64_t>* dependencies) {
+  auto it = states.find((typename STATES::key_type)object);
+  if (it == states.end()) {
+    return false;
+  }
+  stateID = it->second->GetUniqueStateID();
+  if (dependencies != nullptr) {
+    auto pointers = it->second->GetMappedPointers();
+    dependencies->insert(dependencies->end(), pointers.begin(), pointers.end());
   }
-  return relatedPointers;
+  return true;
+}
+
+uint64_t resolveObjectDependencies(uint64_t obj, std::vector<uint64_t>* dependencies) {
+  uint64_t stateID = 0;
+  auto& sd = SD();
+  bool found =
+      resolveStateDependencies(sd._instancestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._physicaldevicestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._surfacekhrstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._devicestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._swapchainkhrstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._descriptorpoolstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._commandpoolstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._samplerstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._devicememorystates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._imagestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._imageviewstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._bufferstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._bufferviewstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._descriptorsetlayoutstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._descriptorsetstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._pipelinelayoutstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._descriptorupdatetemplatestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._pipelinecachestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._shadermodulestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._renderpassstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._pipelinestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._framebufferstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._fencestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._eventstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._semaphorestates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._querypoolstates, obj, stateID, dependencies) ||
+      resolveStateDependencies(sd._commandbufferstates, obj, stateID, dependencies);
+  return found ? stateID : 0;
+}
+
+} // namespace
+
+// Returns transitive closure of objects the given objects depend on (including
+// the objects themselves). Edge lists are cached in SD().objectDependencyGraph.
+std::set<uint64_t> getRelatedPointers(std::set<uint64_t>& originalSet) {
+  return SD().objectDependencyGraph.GetClosure(originalSet, resolveObjectDependencies);
 }
 
 CVkSubmitInfoArrayWrap::CVkSubmitInfoArrayWrap() : submitInfoData(), submitInfo2Data() {}
@@ -2714,15 +2652,7 @@ std::set<uint64_t> getPointersUsedInQueueSubmit(CVkSubmitInfoArrayWrap& submitIn
     }
   }
 
-  std::set<uint64_t> relatedPointers = getRelatedPointers(pointers);
-  std::set<uint64_t> relatedPointers2 = getRelatedPointers(relatedPointers);
-  std::set<uint64_t> relatedPointers3 = getRelatedPointers(relatedPointers2);
-  std::set<uint64_t> relatedPointers4 = getRelatedPointers(relatedPointers3);
-  pointers.insert(relatedPointers.begin(), relatedPointers.end());
-  pointers.insert(relatedPointers2.begin(), relatedPointers2.end());
-  pointers.insert(relatedPointers3.begin(), relatedPointers3.end());
-  pointers.insert(relatedPointers4.begin(), relatedPointers4.end());
-  return pointers;
+  return getRelatedPointers(pointers);
 }
 
 CVkSubmitInfoArrayWrap getSubmitInfoForPrepare(const std::vector<uint32_t>& countersTable,
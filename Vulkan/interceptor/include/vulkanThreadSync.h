@@ -16,17 +16,17 @@
 #pragma once
 
 #include <mutex>
-#include <unordered_map>
 #include "vulkanRecorderWrapper.h"
+#include "vulkanTimelineWaitRegistry.h"
 
 // Global thread synchronization
 // Some apps may first wait on a timeline semaphore on one thread, and later signal that semaphore
-// on another thread. This causes a deadlock which is resolved with a std::condition_variable.
+// on another thread. This causes a deadlock which is resolved with per-wait condition variables.
 //
 // In case of a vkQueueSubmit() the following order of operations is required:
 // - wrapper schedules vkQueueSubmit() to a stream,
 // - drvVk.vkQueueSubmit() is called,
-// - std::condition_variable::notify() is called.
+// - waiters satisfied by the signaled values are notified.
 //
 // For vkWaitSemaphores() the following order of operations is required:
 // - std::condition_variable::wait() is called
@@ -35,8 +35,7 @@
 
 namespace {
 
-extern std::condition_variable_any globalConditionVariable;
-extern std::unordered_map<VkSemaphore, uint64_t> globalSemaphoreConditionMap;
+extern gits::Vulkan::CTimelineWaitRegistry<VkSemaphore> globalTimelineWaitRegistry;
 
 } // namespace
 
@@ -55,10 +54,9 @@ void signalOperation_vkQueueSubmit(VkQueue queue,
             .GetPNextStructure(pSubmits[s].pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO);
     if (pTimelineSemaphoreSubmitInfo && pTimelineSemaphoreSubmitInfo->pSignalSemaphoreValues) {
       for (uint32_t i = 0; i < pSubmits[s].signalSemaphoreCount; ++i) {
-        globalSemaphoreConditionMap[pSubmits[s].pSignalSemaphores[i]] =
-            pTimelineSemaphoreSubmitInfo->pSignalSemaphoreValues[i];
+        globalTimelineWaitRegistry.Signal(pSubmits[s].pSignalSemaphores[i],
+                                          pTimelineSemaphoreSubmitInfo->pSignalSemaphoreValues[i]);
       }
-      globalConditionVariable.notify_one();
     }
   }
 }
@@ -69,10 +67,9 @@ void signalOperation_vkQueueSubmit2(VkQueue queue,
                                     VkFence fence) {
   for (uint32_t s = 0; s < submitCount; ++s) {
     for (uint32_t i = 0; i < pSubmits[s].signalSemaphoreInfoCount; ++i) {
-      globalSemaphoreConditionMap[pSubmits[s].pSignalSemaphoreInfos[i].semaphore] =
-          pSubmits[s].pSignalSemaphoreInfos[i].value;
+      globalTimelineWaitRegistry.Signal(pSubmits[s].pSignalSemaphoreInfos[i].semaphore,
+                                        pSubmits[s].pSignalSemaphoreInfos[i].value);
     }
-    globalConditionVariable.notify_one();
   }
 }
 
@@ -87,8 +84,7 @@ void signalOperation_vkQueueSubmit2KHR(VkQueue queue,
 
 void signalOperation_vkSignalSemaphore(VkDevice device, const VkSemaphoreSignalInfo* pSignalInfo) {
   if (pSignalInfo && pSignalInfo->semaphore) {
-    globalSemaphoreConditionMap[pSignalInfo->semaphore] = pSignalInfo->value;
-    globalConditionVariable.notify_one();
+    globalTimelineWaitRegistry.Signal(pSignalInfo->semaphore, pSignalInfo->value);
   }
 }
 
@@ -104,33 +100,9 @@ void waitOperation_vkWaitSemaphores(VkDevice device,
                                     uint64_t timeout,
                                     std::unique_lock<std::recursive_mutex>& lock) {
   if (pWaitInfo && pWaitInfo->semaphoreCount) {
-    for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; ++i) {
-      auto it = globalSemaphoreConditionMap.find(pWaitInfo->pSemaphores[i]);
-      if (it == globalSemaphoreConditionMap.end()) {
-        globalSemaphoreConditionMap[pWaitInfo->pSemaphores[i]] = 0;
-      }
-    }
-
-    globalConditionVariable.wait(lock, [pWaitInfo] {
-      // Wait any
-      if (isBitSet(pWaitInfo->flags, VK_SEMAPHORE_WAIT_ANY_BIT)) {
-        for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; ++i) {
-          if (globalSemaphoreConditionMap[pWaitInfo->pSemaphores[i]] >= pWaitInfo->pValues[i]) {
-            return true;
-          }
-        }
-        return false;
-      }
-      // Wait all
-      else {
-        for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; ++i) {
-          if (globalSemaphoreConditionMap[pWaitInfo->pSemaphores[i]] < pWaitInfo->pValues[i]) {
-            return false;
-          }
-        }
-        return true;
-      }
-    });
+    globalTimelineWaitRegistry.Wait(lock, pWaitInfo->semaphoreCount, pWaitInfo->pSemaphores,
+                                    pWaitInfo->pValues,
+                                    isBitSet(pWaitInfo->flags, VK_SEMAPHORE_WAIT_ANY_BIT));
   }
 }
 
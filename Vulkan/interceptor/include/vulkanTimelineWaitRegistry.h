@@ -0,0 +1,105 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   vulkanTimelineWaitRegistry.h
+ *
+ * @brief Timeline semaphore waiters of the Vulkan recorder.
+ *
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace gits {
+namespace Vulkan {
+
+// Timeline values signaled so far and threads waiting for them. Each waiter registers its
+// thresholds with the semaphores it waits on and has its own condition variable, so a signal
+// wakes exactly the waiters it satisfies. All methods are called with the global mutex held.
+// Semaphore handle type is a parameter, so the registry doesn't depend on Vulkan headers.
+template <class SEMAPHORE>
+class CTimelineWaitRegistry {
+  struct CWaiter {
+    std::condition_variable_any conditionVariable;
+    uint32_t pending = 0;
+  };
+  struct CRegistration {
+    CWaiter* waiter;
+    bool signaled;
+  };
+  struct CSemaphoreState {
+    uint64_t value = 0;
+    std::multimap<uint64_t, CRegistration*> waiters;
+  };
+  std::unordered_map<SEMAPHORE, CSemaphoreState> _semaphores;
+
+public:
+  void Signal(SEMAPHORE semaphore, uint64_t value) {
+    auto& state = _semaphores[semaphore];
+    state.value = value;
+    const auto end = state.waiters.upper_bound(value);
+    for (auto it = state.waiters.begin(); it != end; ++it) {
+      CRegistration* registration = it->second;
+      registration->signaled = true;
+      // Waiting for any semaphore is satisfied by the first one.
+      CWaiter* waiter = registration->waiter;
+      if (waiter->pending > 0 && --waiter->pending == 0) {
+        waiter->conditionVariable.notify_one();
+      }
+    }
+    state.waiters.erase(state.waiters.begin(), end);
+  }
+
+  void Wait(std::unique_lock<std::recursive_mutex>& lock,
+            uint32_t count,
+            const SEMAPHORE* semaphores,
+            const uint64_t* values,
+            bool waitAny) {
+    std::vector<CSemaphoreState*> states(count);
+    uint32_t satisfied = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      states[i] = &_semaphores[semaphores[i]];
+      if (states[i]->value >= values[i]) {
+        ++satisfied;
+      }
+    }
+    if (satisfied == count || (waitAny && satisfied > 0)) {
+      return;
+    }
+
+    CWaiter waiter;
+    waiter.pending = waitAny ? 1 : count - satisfied;
+    std::vector<CRegistration> registrations(count, CRegistration{&waiter, true});
+    std::vector<typename std::multimap<uint64_t, CRegistration*>::iterator> entries(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      if (states[i]->value < values[i]) {
+        registrations[i].signaled = false;
+        entries[i] = states[i]->waiters.emplace(values[i], &registrations[i]);
+      }
+    }
+
+    waiter.conditionVariable.wait(lock, [&waiter] { return waiter.pending == 0; });
+
+    // Thresholds that were not reached are still registered.
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!registrations[i].signaled) {
+        states[i]->waiters.erase(entries[i]);
+      }
+    }
+  }
+};
+
+} // namespace Vulkan
+} // namespace gits
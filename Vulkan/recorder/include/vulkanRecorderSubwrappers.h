@@ -576,42 +576,12 @@ inline void vkQueueSubmit_RECWRAP(VkResult return_value,
   std::unordered_set<VkDeviceMemory> _memoryToUpdate;
 
   if (updateOnlyUsedMemory()) {
-    std::unordered_set<VkBuffer> updatedBuffers;
-    std::unordered_set<VkImage> updatedImages;
-
     for (uint32_t i = 0; i < submitCount; i++) {
       for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; j++) {
         const auto cmdBuf = pSubmits[i].pCommandBuffers[j];
-
-        // Process memory bound to buffers
-        for (auto& bufferState : SD().bindingBuffers[cmdBuf]) {
-          if (updatedBuffers.find(bufferState->bufferHandle) == updatedBuffers.end()) {
-            auto& bufferBinding = bufferState->binding;
-
-            if (bufferBinding &&
-                (SD()._devicememorystates.find(
-                     bufferBinding->deviceMemoryStateStore->deviceMemoryHandle) !=
-                 SD()._devicememorystates.end()) &&
-                bufferBinding->deviceMemoryStateStore->IsMapped()) {
-              _memoryToUpdate.insert(bufferBinding->deviceMemoryStateStore->deviceMemoryHandle);
-            }
-            updatedBuffers.insert(bufferState->bufferHandle);
-          }
-        }
-
-        // Process memory bound to images
-        for (auto& imageState : SD().bindingImages[cmdBuf]) {
-          if (updatedImages.find(imageState->imageHandle) == updatedImages.end()) {
-            auto& imageBinding = imageState->binding;
-
-            if (imageBinding &&
-                (SD()._devicememorystates.find(
-                     imageBinding->deviceMemoryStateStore->deviceMemoryHandle) !=
-                 SD()._devicememorystates.end()) &&
-                imageBinding->deviceMemoryStateStore->IsMapped()) {
-              _memoryToUpdate.insert(imageBinding->deviceMemoryStateStore->deviceMemoryHandle);
-            }
-            updatedImages.insert(imageState->imageHandle);
+        for (const auto& memoryState : getMappableMemoryInCmdBuffer(cmdBuf)) {
+          if (memoryState->IsMapped()) {
+            _memoryToUpdate.insert(memoryState->deviceMemoryHandle);
           }
         }
       }
@@ -721,42 +691,12 @@ inline void vkQueueSubmit2_RECWRAP(VkResult return_value,
   std::unordered_set<VkDeviceMemory> _memoryToUpdate;
 
   if (updateOnlyUsedMemory()) {
-    std::unordered_set<VkBuffer> updatedBuffers;
-    std::unordered_set<VkImage> updatedImages;
-
     for (uint32_t i = 0; i < submitCount; i++) {
       for (uint32_t j = 0; j < pSubmits[i].commandBufferInfoCount; j++) {
         const auto cmdBuf = pSubmits[i].pCommandBufferInfos[j].commandBuffer;
-
-        // Process memory bound to buffers
-        for (auto& bufferState : SD().bindingBuffers[cmdBuf]) {
-          if (updatedBuffers.find(bufferState->bufferHandle) == updatedBuffers.end()) {
-            auto& bufferBinding = bufferState->binding;
-
-            if (bufferBinding &&
-                (SD()._devicememorystates.find(
-                     bufferBinding->deviceMemoryStateStore->deviceMemoryHandle) !=
-                 SD()._devicememorystates.end()) &&
-                bufferBinding->deviceMemoryStateStore->IsMapped()) {
-              _memoryToUpdate.insert(bufferBinding->deviceMemoryStateStore->deviceMemoryHandle);
-            }
-            updatedBuffers.insert(bufferState->bufferHandle);
-          }
-        }
-
-        // Process memory bound to images
-        for (auto& imageState : SD().bindingImages[cmdBuf]) {
-          if (updatedImages.find(imageState->imageHandle) == updatedImages.end()) {
-            auto& imageBinding = imageState->binding;
-
-            if (imageBinding &&
-                (SD()._devicememorystates.find(
-                     imageBinding->deviceMemoryStateStore->deviceMemoryHandle) !=
-                 SD()._devicememorystates.end()) &&
-                imageBinding->deviceMemoryStateStore->IsMapped()) {
-              _memoryToUpdate.insert(imageBinding->deviceMemoryStateStore->deviceMemoryHandle);
-            }
-            updatedImages.insert(imageState->imageHandle);
+        for (const auto& memoryState : getMappableMemoryInCmdBuffer(cmdBuf)) {
+          if (memoryState->IsMapped()) {
+            _memoryToUpdate.insert(memoryState->deviceMemoryHandle);
           }
         }
       }
@@ -84,6 +84,10 @@ void RestoreAccelerationStructure(CScheduler& scheduler, CStateDynamic& sd);
 void RestoreDescriptorSetLayout(CScheduler& scheduler, CStateDynamic& sd);
 void RestoreAllocatedDescriptorSet(CScheduler& scheduler, CStateDynamic& sd);
 void RestoreDescriptorSetsUpdates(CScheduler& scheduler, CStateDynamic& sd);
+void RestoreDescriptorSetsUpdates(CScheduler& scheduler,
+                                  CStateDynamic& sd,
+                                  CStateDynamic::TDescriptorSetStates::iterator begin,
+                                  CStateDynamic::TDescriptorSetStates::iterator end);
 void RestorePipelineLayout(CScheduler& scheduler, CStateDynamic& sd);
 void DestroyTemporaryDescriptorSetLayouts(CScheduler& scheduler, CStateDynamic& sd);
 void RestoreDescriptorUpdateTemplate(CScheduler& scheduler, CStateDynamic& sd);
@@ -106,6 +110,8 @@ void PrepareVkQueueSubmits(CStateDynamic& sd);
 void PostRestoreVkQueueSubmits(CScheduler& scheduler, CStateDynamic& sd);
 void StateRestoreInfoStart(CScheduler& scheduler, const char* info);
 void StateRestoreInfoEnd(CScheduler& scheduler, const char* info, int index);
+// Restores all objects, generating tokens of independent object types on worker threads.
+void ScheduleStateRestore(CScheduler& scheduler, CStateDynamic& sd);
 
 /**
     * @brief Library state getter class
@@ -119,66 +125,7 @@ public:
   // scheduled in one step in "Schedule" function.
   void Get() {}
   void Schedule(CScheduler& scheduler) const {
-    auto& sd = SD();
-    StateRestoreInfoStart(scheduler, "Restoring resources...");
-    RestoreVkInstances(scheduler, sd);
-    RestoreVkPhysicalDevices(scheduler, sd);
-    RestoreSurfaceKHR(scheduler, sd);
-    RestoreVkDevices(scheduler, sd);
-    RestoreVkQueue(scheduler, sd);
-    PrepareTemporaryResources(scheduler, sd);
-    RestoreSwapchainKHR(scheduler, sd);
-    RestoreVkDescriptorPool(scheduler, sd);
-    RestoreVkCommandPool(scheduler, sd);
-    RestoreSampler(scheduler, sd);
-    RestoreImage(scheduler, sd);
-    RestoreBuffer(scheduler, sd);
-    RestoreMemory(scheduler, sd);
-    RestoreMappedMemory(scheduler, sd);
-    RestoreImageBindings(scheduler, sd);
-    RestoreBufferBindings(scheduler, sd);
-    RestoreImageView(scheduler, sd);
-    RestoreBufferView(scheduler, sd);
-    RestoreDeferredOperations(scheduler, sd);
-    RestoreAccelerationStructure(scheduler, sd);
-    RestoreDescriptorSetLayout(scheduler, sd);
-    RestoreAllocatedDescriptorSet(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Resources restored", 0);
-    StateRestoreInfoStart(scheduler, "Restoring descriptor set bindings...");
-    RestoreDescriptorSetsUpdates(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Descriptor set bindings restored", 1);
-    StateRestoreInfoStart(scheduler, "Restoring shader resources...");
-    RestorePipelineLayout(scheduler, sd);
-    DestroyTemporaryDescriptorSetLayouts(scheduler, sd);
-    RestoreDescriptorUpdateTemplate(scheduler, sd);
-    RestorePipelineCache(scheduler, sd);
-    RestoreShaderModules(scheduler, sd);
-    RestoreRenderPass(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Shader resources restored", 2);
-    StateRestoreInfoStart(scheduler, "Restoring and compiling pipeline objects...");
-    RestorePipelines(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Pipeline objects restored and compiled", 3);
-    StateRestoreInfoStart(scheduler, "Restoring additional resources...");
-    RestoreFramebuffer(scheduler, sd);
-    RestoreFences(scheduler, sd);
-    RestoreEvents(scheduler, sd);
-    RestoreSemaphores(scheduler, sd);
-    RestoreQueryPool(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Additional resources restored", 4);
-    StateRestoreInfoStart(scheduler, "Restoring contents of images...");
-    RestoreImageContents(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Contents of images restored", 5);
-    StateRestoreInfoStart(scheduler, "Restoring contents of buffers...");
-    RestoreBufferContents(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Contents of buffers restored", 6);
-    StateRestoreInfoStart(scheduler, "Restoring contents of acceleration structures...");
-    RestoreAccelerationStructureContents(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Contents of acceleration structures restored", 7);
-    StateRestoreInfoStart(scheduler, "Restoring recorded command buffers...");
-    RestoreAllocatedCommandBuffers(scheduler, sd);
-    RestoreCommandBuffers(scheduler, sd);
-    StateRestoreInfoEnd(scheduler, "Recorded command buffers restored", 8);
-    FinishStateRestore(scheduler, sd);
+    ScheduleStateRestore(scheduler, SD());
   }
 
   void Prepare() const {
@@ -20,6 +20,24 @@
 #include "vulkanStateRestore.h"
 #include "vulkanStateTracking.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <thread>
+
+#ifdef GITS_PLATFORM_WINDOWS
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 void ScheduleTokens(gits::Vulkan::CFunction* token) {
   gits::CRecorder::Instance().Scheduler().Register(token);
 }
@@ -1292,14 +1310,17 @@ bool RestoreTexelBufferDescriptorHelper(
     const gits::Vulkan::CDescriptorSetState::CDescriptorSetBindingData::CDescriptorData&
         descriptorData,
     VkWriteDescriptorSet& descriptorWrite,
+    std::list<VkBufferView>& texelBufferViews,
     const VkDevice device) {
-  if (!descriptorData.pTexelBufferView) {
+  if (!descriptorData.pTexelBufferView || descriptorData.pTexelBufferView->size() == 0) {
     LOG_INFO << "Omitting restore of vkUpdateDescriptorSets for VkDevice because texel buffer "
                 "descriptor info is null.";
     return false;
   }
 
-  const auto texelBufferView = *descriptorData.pTexelBufferView->Value();
+  // Value() of the array rebuilds its data, while arrays copied with vkCopyDescriptorSets
+  // are shared between descriptor sets updated on different threads.
+  const auto texelBufferView = **descriptorData.pTexelBufferView->Vector()[0];
   const auto& bufferViewStateIt = sd._bufferviewstates.find(texelBufferView);
 
   if ((bufferViewStateIt == sd._bufferviewstates.end()) ||
@@ -1321,7 +1342,8 @@ bool RestoreTexelBufferDescriptorHelper(
     return false;
   }
 
-  descriptorWrite.pTexelBufferView = descriptorData.pTexelBufferView->Value();
+  texelBufferViews.push_back(texelBufferView);
+  descriptorWrite.pTexelBufferView = &texelBufferViews.back();
   return true;
 }
 
@@ -1403,7 +1425,16 @@ bool RestoreAccelerationStructureDescriptorHelper(
 } // namespace
 
 void gits::Vulkan::RestoreDescriptorSetsUpdates(CScheduler& scheduler, CStateDynamic& sd) {
-  for (auto& descriptorSetState : sd._descriptorsetstates) {
+  RestoreDescriptorSetsUpdates(scheduler, sd, sd._descriptorsetstates.begin(),
+                               sd._descriptorsetstates.end());
+}
+
+void gits::Vulkan::RestoreDescriptorSetsUpdates(CScheduler& scheduler,
+                                                CStateDynamic& sd,
+                                                CStateDynamic::TDescriptorSetStates::iterator begin,
+                                                CStateDynamic::TDescriptorSetStates::iterator end) {
+  for (auto it = begin; it != end; ++it) {
+    auto& descriptorSetState = *it;
     if (IsObjectToSkip((uint64_t)descriptorSetState.first)) {
       continue;
     }
@@ -1411,6 +1442,7 @@ void gits::Vulkan::RestoreDescriptorSetsUpdates(CScheduler& scheduler, CStateDyn
     std::vector<VkWriteDescriptorSet> descriptorWrites;
     std::vector<VkWriteDescriptorSetInlineUniformBlock> uniformBlocks;
     std::list<VkWriteDescriptorSetAccelerationStructureKHR> accelerationStructureWrites;
+    std::list<VkBufferView> texelBufferViews;
 
     for (auto& descriptorSetBindingIt : descriptorSetState.second->descriptorSetBindings) {
       auto& descriptorSetBinding = descriptorSetBindingIt.second;
@@ -1474,8 +1506,8 @@ void gits::Vulkan::RestoreDescriptorSetsUpdates(CScheduler& scheduler, CStateDyn
             break;
           case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
           case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-            writeDescriptor =
-                RestoreTexelBufferDescriptorHelper(sd, currentBindingData, descriptorWrite, device);
+            writeDescriptor = RestoreTexelBufferDescriptorHelper(
+                sd, currentBindingData, descriptorWrite, texelBufferViews, device);
             break;
           case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
           case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
@@ -4321,3 +4353,284 @@ void gits::Vulkan::StateRestoreInfoStart(CScheduler& scheduler, const char* info
 void gits::Vulkan::StateRestoreInfoEnd(CScheduler& scheduler, const char* info, int index) {
   scheduler.Register(new CGitsVkStateRestoreInfo(info, index));
 }
+
+namespace {
+
+// Number of descriptor sets updated by one state restore job.
+const size_t DescriptorSetsPerJob = 4096;
+
+/**
+    * @brief Runner of state restore token generators
+    *
+    * Consecutive generators added with Parallel() only read the state and register
+    * tokens, so they are run on worker threads, each to its own batch of tokens.
+    * Batches are registered in the order in which generators were added, so the
+    * stream is the same as when generators are called one by one. Generators added
+    * with Serial() call the driver or update data shared between generators and run
+    * on the calling thread after all previously added generators.
+    */
+class CStateRestoreJobs : private gits::noncopyable {
+public:
+  typedef void (*TRestoreFunction)(gits::CScheduler&, gits::Vulkan::CStateDynamic&);
+  typedef std::function<void(gits::CScheduler&)> TGenerator;
+
+private:
+  struct TJob {
+    const char* name;
+    TGenerator generator;
+    std::unique_ptr<gits::CScheduler> batch;
+    int64_t time = 0;
+    std::exception_ptr error;
+  };
+
+  gits::CScheduler& _scheduler;
+  gits::Vulkan::CStateDynamic& _sd;
+  unsigned _threads;
+  bool _verify;
+  unsigned _verifiedJobs = 0;
+  unsigned _verifyFailures = 0;
+  std::vector<TJob> _jobs;
+  // Time spent on each object type, in order of first use.
+  std::vector<std::pair<const char*, int64_t>> _times;
+  Timer _timer;
+
+  void AddTime(const char* name, int64_t time) {
+    auto it = std::find_if(_times.begin(), _times.end(), [name](const auto& entry) {
+      return std::string_view(entry.first) == name;
+    });
+    if (it == _times.end()) {
+      _times.emplace_back(name, time);
+    } else {
+      it->second += time;
+    }
+  }
+
+  static bool FilesEqual(const std::filesystem::path& first, const std::filesystem::path& second) {
+    std::ifstream firstFile(first, std::ios::binary);
+    std::ifstream secondFile(second, std::ios::binary);
+    return std::equal(std::istreambuf_iterator<char>(firstFile), std::istreambuf_iterator<char>(),
+                      std::istreambuf_iterator<char>(secondFile),
+                      std::istreambuf_iterator<char>());
+  }
+
+  // Compares tokens of the job generated on a worker thread with tokens generated on
+  // the calling thread, both written to temporary streams. Tokens of the batch are kept,
+  // so the verified ones are registered.
+  void Verify(TJob& job) {
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string pid = std::to_string(getpid());
+    const auto parallelPath = dir / ("gitsStateRestoreParallel-" + pid + ".bin");
+    const auto serialPath = dir / ("gitsStateRestoreSerial-" + pid + ".bin");
+    {
+      gits::CBinOStream parallelStream(parallelPath);
+      job.batch->WriteBatch(parallelStream, true);
+      gits::CScheduler reference(UINT_MAX);
+      job.generator(reference);
+      gits::CBinOStream serialStream(serialPath);
+      reference.WriteBatch(serialStream);
+    }
+    _verifiedJobs++;
+    if (!FilesEqual(parallelPath, serialPath)) {
+      LOG_ERROR << "State restore tokens of " << job.name
+                << " generated on a worker thread differ from the ones generated on one thread.";
+      _verifyFailures++;
+    }
+    std::filesystem::remove(parallelPath);
+    std::filesystem::remove(serialPath);
+  }
+
+public:
+  CStateRestoreJobs(gits::CScheduler& scheduler, gits::Vulkan::CStateDynamic& sd)
+      : _scheduler(scheduler), _sd(sd) {
+    _threads = gits::Configurator::Get().vulkan.recorder.stateRestoreThreads;
+    if (_threads == 0) {
+      _threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+    _verify = gits::Configurator::Get().vulkan.recorder.stateRestoreVerify;
+  }
+
+  void Serial(const char* name, const TGenerator& generator) {
+    Wait();
+    Timer timer;
+    generator(_scheduler);
+    AddTime(name, timer.Get());
+  }
+  void Serial(const char* name, TRestoreFunction function) {
+    Serial(name, [this, function](gits::CScheduler& scheduler) { function(scheduler, _sd); });
+  }
+
+  void Parallel(const char* name, TGenerator generator) {
+    if (_threads == 1 && !_verify) {
+      Serial(name, generator);
+      return;
+    }
+    TJob job;
+    job.name = name;
+    job.generator = std::move(generator);
+    job.batch = std::make_unique<gits::CScheduler>(UINT_MAX);
+    _jobs.push_back(std::move(job));
+  }
+  void Parallel(const char* name, TRestoreFunction function) {
+    Parallel(name, [this, function](gits::CScheduler& scheduler) { function(scheduler, _sd); });
+  }
+
+  void InfoStart(const char* info) {
+    Wait();
+    gits::Vulkan::StateRestoreInfoStart(_scheduler, info);
+  }
+  void InfoEnd(const char* info, int index) {
+    Wait();
+    gits::Vulkan::StateRestoreInfoEnd(_scheduler, info, index);
+  }
+
+  // Runs pending parallel generators and registers their tokens.
+  void Wait() {
+    if (_jobs.empty()) {
+      return;
+    }
+    std::atomic<size_t> nextJob(0);
+    auto runJobs = [&] {
+      for (size_t i = nextJob++; i < _jobs.size(); i = nextJob++) {
+        auto& job = _jobs[i];
+        Timer timer;
+        try {
+          job.generator(*job.batch);
+        } catch (...) {
+          job.error = std::current_exception();
+        }
+        job.time = timer.Get();
+      }
+    };
+
+    const size_t threadCount = std::min<size_t>(_threads, _jobs.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threadCount; ++i) {
+      workers.emplace_back(runJobs);
+    }
+    runJobs();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    std::vector<TJob> jobs;
+    jobs.swap(_jobs);
+    for (auto& job : jobs) {
+      if (job.error) {
+        std::rethrow_exception(job.error);
+      }
+      if (_verify) {
+        Verify(job);
+      }
+      _scheduler.RegisterBatch(*job.batch);
+      AddTime(job.name, job.time);
+    }
+  }
+
+  void LogTimes() const {
+    LOG_INFO << "State restore tokens generated in " << _timer.Get() / 1000000 << " ms using "
+             << _threads << " thread(s):";
+    for (const auto& [name, time] : _times) {
+      LOG_INFO << "  " << name << ": " << time / 1000000 << " ms";
+    }
+    if (_verify) {
+      LOG_INFO << "State restore verification: " << _verifiedJobs << " parallel jobs compared, "
+               << _verifyFailures << " mismatched.";
+    }
+  }
+};
+
+// Image and buffer infos copied with vkCopyDescriptorSets are shared between descriptor
+// sets and build their value on first use, so they have to be built before descriptor
+// sets are updated on many threads.
+void PrepareSharedDescriptorData(gits::Vulkan::CStateDynamic& sd) {
+  for (auto& descriptorSetState : sd._descriptorsetstates) {
+    for (auto& descriptorSetBinding : descriptorSetState.second->descriptorSetBindings) {
+      for (auto& descriptorData : descriptorSetBinding.second.descriptorData) {
+        if (descriptorData.pImageInfo && descriptorData.pImageInfo.use_count() > 1) {
+          descriptorData.pImageInfo->Value();
+        }
+        if (descriptorData.pBufferInfo && descriptorData.pBufferInfo.use_count() > 1) {
+          descriptorData.pBufferInfo->Value();
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+void gits::Vulkan::ScheduleStateRestore(CScheduler& scheduler, CStateDynamic& sd) {
+  CStateRestoreJobs jobs(scheduler, sd);
+  jobs.InfoStart("Restoring resources...");
+  jobs.Serial("Instances", RestoreVkInstances);
+  jobs.Serial("Physical devices", RestoreVkPhysicalDevices);
+  jobs.Serial("Surfaces", RestoreSurfaceKHR);
+  jobs.Serial("Devices", RestoreVkDevices);
+  jobs.Serial("Queues", RestoreVkQueue);
+  jobs.Serial("Temporary resources", PrepareTemporaryResources);
+  jobs.Serial("Swapchains", RestoreSwapchainKHR);
+  jobs.Parallel("Descriptor pools", RestoreVkDescriptorPool);
+  jobs.Parallel("Command pools", RestoreVkCommandPool);
+  jobs.Parallel("Samplers", RestoreSampler);
+  jobs.Parallel("Images", RestoreImage);
+  jobs.Parallel("Buffers", RestoreBuffer);
+  jobs.Parallel("Memory", RestoreMemory);
+  // Shares memory allocate infos with RestoreMemory.
+  jobs.Serial("Mapped memory", RestoreMappedMemory);
+  jobs.Parallel("Image bindings", RestoreImageBindings);
+  jobs.Parallel("Buffer bindings", RestoreBufferBindings);
+  jobs.Parallel("Image views", RestoreImageView);
+  jobs.Parallel("Buffer views", RestoreBufferView);
+  jobs.Parallel("Deferred operations", RestoreDeferredOperations);
+  jobs.Parallel("Acceleration structures", RestoreAccelerationStructure);
+  jobs.Parallel("Descriptor set layouts", RestoreDescriptorSetLayout);
+  jobs.Serial("Descriptor sets", RestoreAllocatedDescriptorSet);
+  jobs.InfoEnd("Resources restored", 0);
+  jobs.InfoStart("Restoring descriptor set bindings...");
+  jobs.Serial("Descriptor set updates", [&sd](CScheduler&) { PrepareSharedDescriptorData(sd); });
+  auto& descriptorSets = sd._descriptorsetstates;
+  for (auto it = descriptorSets.begin(); it != descriptorSets.end();) {
+    auto begin = it;
+    for (size_t i = 0; i < DescriptorSetsPerJob && it != descriptorSets.end(); ++i) {
+      ++it;
+    }
+    jobs.Parallel("Descriptor set updates", [&sd, begin, end = it](CScheduler& scheduler) {
+      RestoreDescriptorSetsUpdates(scheduler, sd, begin, end);
+    });
+  }
+  jobs.InfoEnd("Descriptor set bindings restored", 1);
+  jobs.InfoStart("Restoring shader resources...");
+  jobs.Serial("Pipeline layouts", RestorePipelineLayout);
+  jobs.Serial("Temporary descriptor set layouts", DestroyTemporaryDescriptorSetLayouts);
+  jobs.Serial("Descriptor update templates", RestoreDescriptorUpdateTemplate);
+  jobs.Serial("Pipeline caches", RestorePipelineCache);
+  jobs.Serial("Shader modules", RestoreShaderModules);
+  jobs.Serial("Render passes", RestoreRenderPass);
+  jobs.InfoEnd("Shader resources restored", 2);
+  jobs.InfoStart("Restoring and compiling pipeline objects...");
+  jobs.Serial("Pipelines", RestorePipelines);
+  jobs.InfoEnd("Pipeline objects restored and compiled", 3);
+  jobs.InfoStart("Restoring additional resources...");
+  jobs.Serial("Framebuffers", RestoreFramebuffer);
+  jobs.Serial("Fences", RestoreFences);
+  jobs.Serial("Events", RestoreEvents);
+  jobs.Serial("Semaphores", RestoreSemaphores);
+  jobs.Serial("Query pools", RestoreQueryPool);
+  jobs.InfoEnd("Additional resources restored", 4);
+  jobs.InfoStart("Restoring contents of images...");
+  jobs.Serial("Image contents", RestoreImageContents);
+  jobs.InfoEnd("Contents of images restored", 5);
+  jobs.InfoStart("Restoring contents of buffers...");
+  jobs.Serial("Buffer contents", RestoreBufferContents);
+  jobs.InfoEnd("Contents of buffers restored", 6);
+  jobs.InfoStart("Restoring contents of acceleration structures...");
+  jobs.Serial("Acceleration structure contents", RestoreAccelerationStructureContents);
+  jobs.InfoEnd("Contents of acceleration structures restored", 7);
+  jobs.InfoStart("Restoring recorded command buffers...");
+  jobs.Serial("Command buffers", RestoreAllocatedCommandBuffers);
+  jobs.Serial("Command buffers",
+              [&sd](CScheduler& scheduler) { RestoreCommandBuffers(scheduler, sd); });
+  jobs.InfoEnd("Recorded command buffers restored", 8);
+  jobs.Serial("Finish", FinishStateRestore);
+  jobs.LogTimes();
+}
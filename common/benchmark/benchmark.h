@@ -0,0 +1,64 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   benchmark.h
+ *
+ * @brief Registration of gitsBenchmark microbenchmarks.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gits {
+namespace benchmark {
+
+const double MB = 1024.0 * 1024.0;
+
+// Work done by a single run of a benchmark, in the units of its result, and its time in
+// nanoseconds. Setup done by the benchmark is not included in the time.
+struct TSample {
+  double work;
+  int64_t time;
+};
+
+struct TContext {
+  std::filesystem::path workDir; // Emptied before every run.
+  uint64_t dataSize;             // Size of synthetic data processed by a run, in bytes.
+};
+
+typedef std::function<TSample(const TContext& context)> TBenchmarkFunc;
+
+struct TBenchmark {
+  std::string name;
+  std::string unit; // Result is the median work per second, e.g. MB/s.
+  TBenchmarkFunc func;
+};
+
+std::vector<TBenchmark>& Benchmarks();
+
+// Benchmarks are registered with static registrar objects.
+class CRegistrar {
+public:
+  CRegistrar(const char* name, const char* unit, TBenchmarkFunc func) {
+    Benchmarks().push_back({name, unit, std::move(func)});
+  }
+};
+
+// Deterministic synthetic data with runs of repeated bytes in between random bytes, it
+// compresses roughly twice, like typical buffer and texture contents.
+std::vector<char> SyntheticData(uint64_t size, uint32_t seed = 1);
+
+} // namespace benchmark
+} // namespace gits
@@ -0,0 +1,251 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   coreBenchmarks.cpp
+ *
+ * @brief Benchmarks of streams, resources, hashing, memory tracking and the scheduler.
+ *
+ */
+
+#include "benchmark.h"
+#include "configurator.h"
+#include "gits.h"
+#include "MemorySniffer.h"
+#include "resource_manager.h"
+#include "runner.h"
+#include "scheduler.h"
+#include "streams.h"
+#include "timer.h"
+#include "token.h"
+#include "tools.h"
+
+#include <sys/mman.h>
+
+#include <thread>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+// Size of single writes to the stream, similar to token arguments with larger payloads.
+const uint64_t StreamWriteSize = 64 * 1024;
+// Size of resources put to the resource manager.
+const uint64_t ResourceSize = 256 * 1024;
+const unsigned SchedulerTokens = 1000000;
+const unsigned ProducedLists = 200000;
+
+void WriteStream(const std::filesystem::path& path, const std::vector<char>& data) {
+  CBinOStream stream(path);
+  for (uint64_t offset = 0; offset < data.size(); offset += StreamWriteSize) {
+    stream.write(data.data() + offset, std::min(StreamWriteSize, data.size() - offset));
+  }
+}
+
+TSample StreamWrite(const TContext& context) {
+  const auto data = SyntheticData(context.dataSize);
+  Timer timer;
+  WriteStream(context.workDir / "stream.bin", data);
+  return {data.size() / MB, timer.Get()};
+}
+
+TSample StreamRead(const TContext& context) {
+  const auto data = SyntheticData(context.dataSize);
+  const auto path = context.workDir / "stream.bin";
+  WriteStream(path, data);
+
+  std::vector<char> buffer(StreamWriteSize);
+  Timer timer;
+  CBinIStream stream(path);
+  for (uint64_t offset = 0; offset < data.size(); offset += StreamWriteSize) {
+    stream.read(buffer.data(), std::min(StreamWriteSize, data.size() - offset));
+  }
+  return {data.size() / MB, timer.Get()};
+}
+
+std::vector<hash_t> PutResources(const TContext& context, const std::vector<char>& data) {
+  CResourceManager2 resources(resource_filenames(context.workDir));
+  std::vector<hash_t> hashes;
+  for (uint64_t offset = 0; offset < data.size(); offset += ResourceSize) {
+    hashes.push_back(resources.put(RESOURCE_BUFFER, data.data() + offset,
+                                   std::min(ResourceSize, data.size() - offset)));
+  }
+  return hashes;
+}
+
+TSample ResourcePut(const TContext& context) {
+  const auto data = SyntheticData(context.dataSize);
+  Timer timer;
+  // Includes writing the index and flushing data files when the manager is destroyed.
+  PutResources(context, data);
+  return {data.size() / MB, timer.Get()};
+}
+
+TSample ResourceGet(const TContext& context) {
+  const auto data = SyntheticData(context.dataSize);
+  const auto hashes = PutResources(context, data);
+
+  Timer timer;
+  CResourceManager2 resources(resource_filenames(context.workDir));
+  uint64_t size = 0;
+  for (auto hash : hashes) {
+    size += resources.get(hash).size();
+  }
+  return {size / MB, timer.Get()};
+}
+
+TSample Hash(const TContext& context, THashType type) {
+  const auto data = SyntheticData(context.dataSize);
+  Timer timer;
+  volatile uint64_t hash = ComputeHash(data.data(), data.size(), type);
+  (void)hash;
+  return {data.size() / MB, timer.Get()};
+}
+
+TSample Hash128(const TContext& context) {
+  const auto data = SyntheticData(context.dataSize);
+  Timer timer;
+  volatile uint64_t hash = ComputeHash128(data.data(), data.size()).low;
+  (void)hash;
+  return {data.size() / MB, timer.Get()};
+}
+
+TSample ChangedMemorySubranges(const TContext& context) {
+  const auto oldData = SyntheticData(context.dataSize);
+  auto newData = oldData;
+  // Sparse updates, one changed 256-byte range in every 64 KiB.
+  for (uint64_t offset = 12345; offset + 256 <= newData.size(); offset += 64 * 1024) {
+    for (uint64_t i = 0; i < 256; ++i) {
+      newData[offset + i] = ~newData[offset + i];
+    }
+  }
+  Timer timer;
+  const auto ranges = GetChangedMemorySubranges(oldData.data(), newData.data(), newData.size(),
+                                                GetVirtualMemoryPageSize());
+  const int64_t time = timer.Get();
+  if (ranges.empty()) {
+    throw std::runtime_error("no changed memory ranges found");
+  }
+  return {newData.size() / MB, time};
+}
+
+// Each page of a protected region is written once, every write is a fault handled by
+// the memory sniffer signal handler.
+TSample MemorySnifferFaults(const TContext& context) {
+  static const bool installed = MemorySniffer::Install();
+  if (!installed) {
+    throw std::runtime_error("couldn't install memory sniffer");
+  }
+  const size_t pageSize = GetVirtualMemoryPageSize();
+  const size_t size = context.dataSize;
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error("couldn't map memory");
+  }
+  auto pages = static_cast<volatile char*>(memory);
+  // Pages are allocated before they are protected, so faults measure the sniffer only.
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    pages[offset] = 0;
+  }
+
+  auto& sniffer = MemorySniffer::Get();
+  auto handle = sniffer.CreateRegion(memory, size);
+  if (handle == nullptr || !sniffer.Protect(handle)) {
+    munmap(memory, size);
+    throw std::runtime_error("couldn't protect memory region");
+  }
+  Timer timer;
+  for (size_t offset = 0; offset < size; offset += pageSize) {
+    pages[offset] = 1;
+  }
+  const int64_t time = timer.Get();
+  sniffer.RemoveRegion(handle);
+  munmap(memory, size);
+  return {static_cast<double>(size / pageSize), time};
+}
+
+TSample ProducerConsumerLists(const TContext& context) {
+  ProducerConsumer<std::vector<uint64_t>> queue;
+  Timer timer;
+  std::thread consumer([&] {
+    std::vector<uint64_t> list;
+    while (queue.consume(list)) {
+    }
+  });
+  for (unsigned i = 0; i < ProducedLists; ++i) {
+    std::vector<uint64_t> list(16, i);
+    queue.produce(list);
+  }
+  queue.break_pipe();
+  consumer.join();
+  return {static_cast<double>(ProducedLists), timer.Get()};
+}
+
+class CNullAction : public CAction {
+public:
+  void Run(CToken& token) override {}
+};
+
+void WriteTokens(const std::filesystem::path& path) {
+  CBinOStream stream(path);
+  {
+    // Scheduler writes bursts on its writer thread, which is joined when it is destroyed.
+    const auto& cfg = Configurator::Get().common.recorder;
+    CScheduler scheduler(cfg.tokenBurst, cfg.tokenBurstNum);
+    scheduler.Stream(&stream);
+    for (unsigned i = 0; i < SchedulerTokens; ++i) {
+      scheduler.Register(new CTokenMarkerUInt64(i));
+    }
+    scheduler.WriteAll();
+  }
+}
+
+TSample SchedulerWrite(const TContext& context) {
+  Timer timer;
+  WriteTokens(context.workDir / "tokens.bin");
+  return {static_cast<double>(SchedulerTokens), timer.Get()};
+}
+
+TSample SchedulerLoad(const TContext& context) {
+  const auto path = context.workDir / "tokens.bin";
+  WriteTokens(path);
+
+  Timer timer;
+  CBinIStream stream(path);
+  const auto& cfg = Configurator::Get().common.player;
+  CScheduler scheduler(cfg.tokenBurst, cfg.tokenBurstNum);
+  scheduler.Stream(&stream);
+  CNullAction action;
+  while (!scheduler.Run(action)) {
+  }
+  return {static_cast<double>(SchedulerTokens), timer.Get()};
+}
+
+const CRegistrar streamWrite("stream/write", "MB/s", StreamWrite);
+const CRegistrar streamRead("stream/read", "MB/s", StreamRead);
+const CRegistrar resourcePut("resource_manager/put", "MB/s", ResourcePut);
+const CRegistrar resourceGet("resource_manager/get", "MB/s", ResourceGet);
+const CRegistrar hashXxh3("hash/xxh3_64", "MB/s", [](const TContext& context) {
+  return Hash(context, THashType::XXH3_64);
+});
+const CRegistrar hashMurmur("hash/murmur", "MB/s", [](const TContext& context) {
+  return Hash(context, THashType::MURMUR);
+});
+const CRegistrar hashCrc32ish("hash/crc32ish", "MB/s", [](const TContext& context) {
+  return Hash(context, THashType::CRC32ISH);
+});
+const CRegistrar hashXxh3_128("hash/xxh3_128", "MB/s", Hash128);
+const CRegistrar changedSubranges("memory/changed_subranges", "MB/s", ChangedMemorySubranges);
+const CRegistrar snifferFaults("memory/sniffer_write_faults", "faults/s", MemorySnifferFaults);
+const CRegistrar producerConsumer("producer_consumer/lists", "lists/s", ProducerConsumerLists);
+const CRegistrar schedulerWrite("scheduler/write", "tokens/s", SchedulerWrite);
+const CRegistrar schedulerLoad("scheduler/load", "tokens/s", SchedulerLoad);
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
@@ -0,0 +1,111 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   handleMapBenchmarks.cpp
+ *
+ * @brief Benchmarks of HandleRemapper compared to std::unordered_map.
+ *
+ */
+
+#include "benchmark.h"
+#include "handleMap.h"
+#include "timer.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+const unsigned RemappedHandles = 100000;
+const unsigned HandleLookups = 4000000;
+// Handle arrays of a call, e.g. descriptor sets bound at once.
+const unsigned HandlesPerBatch = 8;
+
+// Driver handles are mostly pointers to aligned, heap allocated objects.
+uint64_t Handle(uint64_t index, uint64_t base) {
+  return base + index * 0x40 + (index >> 10) * 0x10000;
+}
+
+uint64_t Random(uint64_t& state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 33;
+}
+
+// Lookups of random handles out of 100k mapped ones, as done by CVulkanObj::GetMapping
+// for every handle argument of a replayed call.
+std::vector<uint64_t> RemapperKeys() {
+  std::vector<uint64_t> keys(HandleLookups);
+  uint64_t state = 1;
+  for (auto& key : keys) {
+    key = Handle(Random(state) % RemappedHandles, 0x7f8000000000);
+  }
+  return keys;
+}
+
+TSample RemapperLookups(bool batch) {
+  HandleRemapper<uint64_t> remapper;
+  for (unsigned i = 0; i < RemappedHandles; ++i) {
+    remapper.Add(Handle(i, 0x7f8000000000), Handle(i, 0x550000000000));
+  }
+  const auto keys = RemapperKeys();
+  std::vector<uint64_t> values(HandlesPerBatch);
+  uint64_t sum = 0;
+  Timer timer;
+  for (size_t i = 0; i < keys.size(); i += HandlesPerBatch) {
+    if (batch) {
+      if (remapper.FindBatch(&keys[i], values.data(), HandlesPerBatch) != HandlesPerBatch) {
+        throw std::runtime_error("handle not mapped");
+      }
+    } else {
+      for (unsigned j = 0; j < HandlesPerBatch; ++j) {
+        remapper.Get(keys[i + j], values[j]);
+      }
+    }
+    sum += values[0];
+  }
+  const int64_t time = timer.Get();
+  volatile uint64_t result = sum;
+  (void)result;
+  return {static_cast<double>(keys.size()), time};
+}
+
+TSample UnorderedMapLookups() {
+  std::unordered_map<uint64_t, uint64_t> remapper;
+  for (unsigned i = 0; i < RemappedHandles; ++i) {
+    remapper[Handle(i, 0x7f8000000000)] = Handle(i, 0x550000000000);
+  }
+  const auto keys = RemapperKeys();
+  std::vector<uint64_t> values(HandlesPerBatch);
+  uint64_t sum = 0;
+  Timer timer;
+  for (size_t i = 0; i < keys.size(); i += HandlesPerBatch) {
+    for (unsigned j = 0; j < HandlesPerBatch; ++j) {
+      values[j] = remapper.find(keys[i + j])->second;
+    }
+    sum += values[0];
+  }
+  const int64_t time = timer.Get();
+  volatile uint64_t result = sum;
+  (void)result;
+  return {static_cast<double>(keys.size()), time};
+}
+
+const CRegistrar remapperLookups("handle_remapper/lookups", "lookups/s", [](const TContext&) {
+  return RemapperLookups(false);
+});
+const CRegistrar remapperBatchLookups("handle_remapper/batch_lookups", "lookups/s",
+                                      [](const TContext&) { return RemapperLookups(true); });
+const CRegistrar unorderedMapLookups("handle_remapper/unordered_map_lookups", "lookups/s",
+                                     [](const TContext&) { return UnorderedMapLookups(); });
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
@@ -0,0 +1,159 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   levelZeroBenchmarks.cpp
+ *
+ * @brief Benchmark of Level Zero module cache keys, run against a mock driver.
+ *
+ */
+
+#include "benchmark.h"
+#include "configurator.h"
+#include "l0Drivers.h"
+#include "l0StateDynamic.h"
+#include "timer.h"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+const unsigned ModuleKeys = 20000;
+const size_t SpirvSize = 64 * 1024;
+
+// Properties reported by the mock driver.
+uint32_t mockDriverVersion = 0;
+const uint8_t MockBinary[] = {0x7f, 'E', 'L', 'F', 2, 1, 1, 0};
+
+ze_result_t __zecall MockDeviceGetProperties(ze_device_handle_t hDevice,
+                                             ze_device_properties_t* pDeviceProperties) {
+  std::memset(pDeviceProperties->uuid.id, 0xd0, sizeof(pDeviceProperties->uuid.id));
+  return ZE_RESULT_SUCCESS;
+}
+
+ze_result_t __zecall MockDriverGetProperties(ze_driver_handle_t hDriver,
+                                             ze_driver_properties_t* pDriverProperties) {
+  std::memset(pDriverProperties->uuid.id, 0xd1, sizeof(pDriverProperties->uuid.id));
+  pDriverProperties->driverVersion = mockDriverVersion;
+  return ZE_RESULT_SUCCESS;
+}
+
+ze_result_t __zecall MockModuleGetNativeBinary(ze_module_handle_t hModule,
+                                               size_t* pSize,
+                                               uint8_t* pModuleNativeBinary) {
+  if (pModuleNativeBinary != nullptr) {
+    std::memcpy(pModuleNativeBinary, MockBinary, sizeof(MockBinary));
+  }
+  *pSize = sizeof(MockBinary);
+  return ZE_RESULT_SUCCESS;
+}
+
+// Replaces driver entry points and player configuration used by the module cache and
+// restores them when the run ends.
+class CMockDriver {
+  ze_dispatch_table_t _inject;
+  GITSMode _mode;
+  std::filesystem::path _moduleCacheDir;
+
+public:
+  const ze_driver_handle_t hDriver = reinterpret_cast<ze_driver_handle_t>(0x5a0000001000);
+  const ze_device_handle_t hDevice = reinterpret_cast<ze_device_handle_t>(0x5a0000002000);
+
+  explicit CMockDriver(const std::filesystem::path& moduleCacheDir)
+      : _inject(l0::drv.inject),
+        _mode(Configurator::Get().common.mode),
+        _moduleCacheDir(Configurator::Get().levelzero.player.moduleCacheDir) {
+    l0::drv.inject.zeDeviceGetProperties = MockDeviceGetProperties;
+    l0::drv.inject.zeDriverGetProperties = MockDriverGetProperties;
+    l0::drv.inject.zeModuleGetNativeBinary = MockModuleGetNativeBinary;
+    mockDriverVersion = 0x10001;
+    auto& cfg = Configurator::GetMutable();
+    cfg.common.mode = GITSMode::MODE_PLAYER;
+    cfg.levelzero.player.moduleCacheDir = moduleCacheDir;
+    l0::SD().Map<l0::CDeviceState>()[hDevice] = std::make_unique<l0::CDeviceState>(hDriver);
+  }
+  ~CMockDriver() {
+    l0::SD().Release<l0::CDeviceState>(hDevice);
+    auto& cfg = Configurator::GetMutable();
+    cfg.common.mode = _mode;
+    cfg.levelzero.player.moduleCacheDir = _moduleCacheDir;
+    l0::drv.inject = _inject;
+  }
+};
+
+void Check(bool condition, const char* message) {
+  if (!condition) {
+    throw std::runtime_error(message);
+  }
+}
+
+// Keys of SPIR-V modules are computed for every zeModuleCreate replayed with the cache
+// enabled. Before the timed loop, a module stored under the key of a descriptor has to be
+// found by an identical descriptor and missed after a change of build flags, of
+// a specialization constant or of the driver version.
+TSample ModuleCacheKeys(const TContext& context) {
+  CMockDriver mock(context.workDir);
+  const auto spirv = SyntheticData(SpirvSize);
+  const uint32_t constantIds[] = {1, 2};
+  uint64_t constantValues[] = {16, 32};
+  const void* constantPointers[] = {&constantValues[0], &constantValues[1]};
+  const ze_module_constants_t constants = {2, constantIds, constantPointers};
+  ze_module_desc_t desc = {};
+  desc.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+  desc.format = ZE_MODULE_FORMAT_IL_SPIRV;
+  desc.inputSize = spirv.size();
+  desc.pInputModule = reinterpret_cast<const uint8_t*>(spirv.data());
+  desc.pBuildFlags = "-ze-opt-level=2";
+  desc.pConstants = &constants;
+
+  l0::ModuleCache cache;
+  const auto key = cache.GetKey(mock.hDevice, &desc);
+  Check(!key.empty(), "module cache key not computed");
+  cache.Store(key, reinterpret_cast<ze_module_handle_t>(0x5a0000003000));
+
+  std::vector<uint8_t> binary;
+  ze_module_desc_t identical = desc;
+  Check(cache.Load(cache.GetKey(mock.hDevice, &identical), binary) &&
+            binary.size() == sizeof(MockBinary),
+        "identical module descriptor missed the cache");
+
+  ze_module_desc_t otherFlags = desc;
+  otherFlags.pBuildFlags = "-ze-opt-level=1";
+  binary.clear();
+  Check(!cache.Load(cache.GetKey(mock.hDevice, &otherFlags), binary),
+        "module with other build flags hit the cache");
+
+  constantValues[1] = 64;
+  binary.clear();
+  Check(!cache.Load(cache.GetKey(mock.hDevice, &desc), binary),
+        "module with other specialization constant hit the cache");
+  constantValues[1] = 32;
+
+  mockDriverVersion++;
+  binary.clear();
+  Check(!cache.Load(cache.GetKey(mock.hDevice, &desc), binary),
+        "module built by other driver version hit the cache");
+  mockDriverVersion--;
+
+  Timer timer;
+  for (unsigned i = 0; i < ModuleKeys; ++i) {
+    Check(cache.GetKey(mock.hDevice, &desc) == key, "module cache key changed");
+  }
+  return {static_cast<double>(ModuleKeys), timer.Get()};
+}
+
+const CRegistrar moduleCacheKeys("level_zero/module_cache_keys", "keys/s", ModuleCacheKeys);
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
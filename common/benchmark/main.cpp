@@ -0,0 +1,269 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   main.cpp
+ *
+ * @brief Microbenchmarks of the GITS core run on synthetic data, without a GPU.
+ *
+ */
+
+#include "benchmark.h"
+#include "gits.h"
+#include "log.h"
+#include "configurator.h"
+
+#include "nlohmann/json.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace gits {
+namespace benchmark {
+
+std::vector<TBenchmark>& Benchmarks() {
+  static std::vector<TBenchmark> benchmarks;
+  return benchmarks;
+}
+
+std::vector<char> SyntheticData(uint64_t size, uint32_t seed) {
+  std::vector<char> data(size);
+  uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+  uint64_t offset = 0;
+  while (offset < size) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    const uint64_t length = std::min<uint64_t>(64 + (state >> 58) * 8, size - offset);
+    if ((state >> 32) & 1) {
+      std::fill_n(data.data() + offset, length, static_cast<char>(state >> 40));
+    } else {
+      for (uint64_t i = 0; i < length; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[offset + i] = static_cast<char>(state >> 56);
+      }
+    }
+    offset += length;
+  }
+  return data;
+}
+
+} // namespace benchmark
+} // namespace gits
+
+using namespace gits;
+using namespace gits::benchmark;
+
+namespace {
+
+struct TResult {
+  std::string name;
+  std::string unit;
+  double value; // Median of samples.
+  std::vector<double> samples;
+};
+
+void Usage() {
+  std::printf(
+      "Usage: gitsBenchmark [--filter <text>] [--repeat <n>] [--size <MB>] [--dir <path>]\n"
+      "                     [--compression <LZ4|ZSTD>] [--json <file>] [--baseline <file>]\n"
+      "                     [--threshold <percent>] [--list]\n"
+      "Runs microbenchmarks of the GITS core on synthetic data. Results are median\n"
+      "throughputs of the repeated runs, higher is better. With --baseline, results are\n"
+      "compared to a file written with --json and the exit code is 2 if any of them is\n"
+      "slower than the baseline by more than the threshold (default 10%%).\n");
+}
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t middle = values.size() / 2;
+  return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+TResult Run(const TBenchmark& benchmark, const TContext& context, unsigned repeat) {
+  TResult result{benchmark.name, benchmark.unit, 0.0, {}};
+  // First run warms up caches and allocators, it is not measured.
+  for (unsigned i = 0; i <= repeat; ++i) {
+    std::filesystem::remove_all(context.workDir);
+    std::filesystem::create_directories(context.workDir);
+    const TSample sample = benchmark.func(context);
+    if (i > 0) {
+      result.samples.push_back(sample.work * 1e9 / std::max<int64_t>(sample.time, 1));
+    }
+  }
+  result.value = Median(result.samples);
+  return result;
+}
+
+nlohmann::ordered_json ToJson(const std::vector<TResult>& results,
+                              const std::string& compression,
+                              uint64_t dataSize) {
+  nlohmann::ordered_json json;
+  json["compression"] = compression;
+  json["dataSize"] = dataSize;
+  json["threads"] = std::thread::hardware_concurrency();
+  auto& benchmarks = json["benchmarks"];
+  benchmarks = nlohmann::ordered_json::array();
+  for (const auto& result : results) {
+    benchmarks.push_back({{"name", result.name},
+                          {"unit", result.unit},
+                          {"value", result.value},
+                          {"samples", result.samples}});
+  }
+  return json;
+}
+
+// Returns number of results slower than the baseline by more than the threshold.
+unsigned Compare(const std::vector<TResult>& results,
+                 const nlohmann::json& baseline,
+                 const std::string& compression,
+                 double threshold) {
+  if (baseline.value("compression", compression) != compression) {
+    std::printf("Warning: baseline was measured with %s compression.\n",
+                baseline["compression"].get<std::string>().c_str());
+  }
+  std::map<std::string, double> baselineValues;
+  for (const auto& entry : baseline["benchmarks"]) {
+    baselineValues[entry["name"].get<std::string>()] = entry["value"].get<double>();
+  }
+
+  unsigned regressions = 0;
+  std::printf("\n%-40s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+  for (const auto& result : results) {
+    const auto it = baselineValues.find(result.name);
+    if (it == baselineValues.end() || it->second <= 0) {
+      std::printf("%-40s %14s %14.1f %9s\n", result.name.c_str(), "-", result.value, "new");
+      continue;
+    }
+    const double change = (result.value / it->second - 1.0) * 100.0;
+    const bool regression = change < -threshold;
+    regressions += regression ? 1 : 0;
+    std::printf("%-40s %14.1f %14.1f %+8.1f%%%s\n", result.name.c_str(), it->second, result.value,
+                change, regression ? "  REGRESSION" : "");
+  }
+  return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string filter;
+  unsigned repeat = 5;
+  uint64_t sizeMB = 64;
+  std::filesystem::path workDir =
+      std::filesystem::temp_directory_path() / ("gitsBenchmark-" + std::to_string(getpid()));
+  std::filesystem::path jsonPath;
+  std::filesystem::path baselinePath;
+  double threshold = 10.0;
+  bool list = false;
+  auto& compressionType = Configurator::GetMutable().common.recorder.compression.type;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--filter" && hasValue) {
+        filter = argv[++i];
+      } else if (arg == "--repeat" && hasValue) {
+        repeat = std::max(std::strtoul(argv[++i], nullptr, 10), 1ul);
+      } else if (arg == "--size" && hasValue) {
+        sizeMB = std::max(std::strtoull(argv[++i], nullptr, 10), 1ull);
+      } else if (arg == "--dir" && hasValue) {
+        workDir = argv[++i];
+      } else if (arg == "--compression" && hasValue) {
+        compressionType = stringTo<CompressionType>(argv[++i]);
+      } else if (arg == "--json" && hasValue) {
+        jsonPath = argv[++i];
+      } else if (arg == "--baseline" && hasValue) {
+        baselinePath = argv[++i];
+      } else if (arg == "--threshold" && hasValue) {
+        threshold = std::strtod(argv[++i], nullptr);
+      } else if (arg == "--list") {
+        list = true;
+      } else if (arg == "-h" || arg == "--help") {
+        Usage();
+        return EXIT_SUCCESS;
+      } else {
+        Usage();
+        return EXIT_FAILURE;
+      }
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  auto benchmarks = Benchmarks();
+  std::sort(benchmarks.begin(), benchmarks.end(),
+            [](const TBenchmark& a, const TBenchmark& b) { return a.name < b.name; });
+  benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+                                  [&](const TBenchmark& benchmark) {
+                                    return benchmark.name.find(filter) == std::string::npos;
+                                  }),
+                   benchmarks.end());
+  if (list) {
+    for (const auto& benchmark : benchmarks) {
+      std::printf("%s [%s]\n", benchmark.name.c_str(), benchmark.unit.c_str());
+    }
+    return EXIT_SUCCESS;
+  }
+
+  nlohmann::json baseline;
+  if (!baselinePath.empty()) {
+    try {
+      std::ifstream file(baselinePath);
+      baseline = nlohmann::json::parse(file);
+    } catch (const std::exception& e) {
+      std::fprintf(stderr, "Couldn't read baseline %s: %s\n", baselinePath.string().c_str(),
+                   e.what());
+      return EXIT_FAILURE;
+    }
+  }
+
+  log::Initialize(LogLevel::WARN);
+  log::AddConsoleAppender();
+  // Stream compressor is created once per process.
+  CGits::Instance().CompressorInit(compressionType);
+  const std::string compression = stringFrom<CompressionType>(compressionType);
+
+  const TContext context{workDir, sizeMB * 1024 * 1024};
+  std::vector<TResult> results;
+  int exitCode = EXIT_SUCCESS;
+  try {
+    std::printf("%-40s %14s %10s\n", "benchmark", "median", "unit");
+    for (const auto& benchmark : benchmarks) {
+      results.push_back(Run(benchmark, context, repeat));
+      std::printf("%-40s %14.1f %10s\n", results.back().name.c_str(), results.back().value,
+                  results.back().unit.c_str());
+      std::fflush(stdout);
+    }
+
+    if (!jsonPath.empty()) {
+      std::ofstream file(jsonPath);
+      file << ToJson(results, compression, context.dataSize).dump(2) << std::endl;
+    }
+    if (!baselinePath.empty() && Compare(results, baseline, compression, threshold) > 0) {
+      exitCode = 2;
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+    exitCode = EXIT_FAILURE;
+  }
+
+  std::error_code ec;
+  std::filesystem::remove_all(workDir, ec);
+  return exitCode;
+}
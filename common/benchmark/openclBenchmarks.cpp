@@ -0,0 +1,262 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   openclBenchmarks.cpp
+ *
+ * @brief Benchmark of translation of pointers stored in OpenCL USM and SVM allocations, run
+ *        against a mock driver.
+ *
+ */
+
+#include "benchmark.h"
+#include "openclPlayerRunWrap.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+using namespace OpenCL;
+
+const cl_context MockContext = reinterpret_cast<cl_context>(0x6c0000001000);
+const cl_command_queue MockQueue = reinterpret_cast<cl_command_queue>(0x6c0000002000);
+const size_t DeviceSize = 1024 * 1024;
+const size_t HostSize = 64 * 1024;
+const char Filler = static_cast<char>(0xa5);
+
+// Copies enqueued to the mock driver. Non-blocking copies are done by clFinish, so results
+// read before the queue is finished are stale.
+struct TMockQueue {
+  struct TCopy {
+    void* dst;
+    const void* src;
+    size_t size;
+  };
+  std::vector<TCopy> pending;
+  unsigned copies = 0;
+  unsigned blockingCopies = 0;
+};
+TMockQueue mockQueue;
+
+cl_int EnqueueCopy(
+    cl_command_queue queue, cl_bool blocking, void* dst, const void* src, size_t size) {
+  if (queue != MockQueue) {
+    return CL_INVALID_COMMAND_QUEUE;
+  }
+  mockQueue.copies++;
+  if (blocking) {
+    mockQueue.blockingCopies++;
+    std::memcpy(dst, src, size);
+  } else {
+    mockQueue.pending.push_back({dst, src, size});
+  }
+  return CL_SUCCESS;
+}
+
+cl_int STDCALL MockEnqueueMemcpyINTEL(cl_command_queue command_queue,
+                                      cl_bool blocking,
+                                      void* dst_ptr,
+                                      const void* src_ptr,
+                                      size_t size,
+                                      cl_uint num_events_in_wait_list,
+                                      const cl_event* event_wait_list,
+                                      cl_event* event) {
+  return EnqueueCopy(command_queue, blocking, dst_ptr, src_ptr, size);
+}
+
+cl_int STDCALL MockEnqueueSVMMemcpy(cl_command_queue command_queue,
+                                    cl_bool blocking_copy,
+                                    void* dst_ptr,
+                                    const void* src_ptr,
+                                    size_t size,
+                                    cl_uint num_events_in_wait_list,
+                                    const cl_event* event_wait_list,
+                                    cl_event* event) {
+  return EnqueueCopy(command_queue, blocking_copy, dst_ptr, src_ptr, size);
+}
+
+cl_int STDCALL MockFinish(cl_command_queue command_queue) {
+  for (const auto& copy : mockQueue.pending) {
+    std::memcpy(copy.dst, copy.src, copy.size);
+  }
+  mockQueue.pending.clear();
+  return CL_SUCCESS;
+}
+
+// Allocation as seen by the player. Its recorded address is mapped to the memory of
+// the allocation, as done when USM and SVM allocations are replayed.
+struct TAllocation {
+  void* recorded;
+  std::vector<char> memory;
+  std::vector<size_t> slots;
+  std::vector<void*> targets; // Player pointers expected in slots after translation.
+};
+
+// Replaces driver entry points used by pointer translation and registers the context,
+// allocations and mappings in the state. Everything is restored when the run ends.
+class CMockDriver {
+  decltype(drvOcl.clEnqueueMemcpyINTEL) _enqueueMemcpyINTEL;
+  decltype(drvOcl.clEnqueueSVMMemcpy) _enqueueSVMMemcpy;
+  decltype(drvOcl.clFinish) _finish;
+  std::vector<void*> _allocations;
+
+public:
+  CMockDriver()
+      : _enqueueMemcpyINTEL(drvOcl.clEnqueueMemcpyINTEL),
+        _enqueueSVMMemcpy(drvOcl.clEnqueueSVMMemcpy),
+        _finish(drvOcl.clFinish) {
+    drvOcl.clEnqueueMemcpyINTEL = MockEnqueueMemcpyINTEL;
+    drvOcl.clEnqueueSVMMemcpy = MockEnqueueSVMMemcpy;
+    drvOcl.clFinish = MockFinish;
+    mockQueue = TMockQueue();
+    auto context = std::make_shared<CCLContextState>(false, nullptr);
+    context->fakeQueue = MockQueue;
+    SD()._contextStates[MockContext] = context;
+  }
+  ~CMockDriver() {
+    for (auto ptr : _allocations) {
+      SD()._usmAllocStates.erase(ptr);
+      SD()._svmAllocStates.erase(ptr);
+      CCLMappedPtr::RemoveMapping(CCLMappedPtr::GetOriginal(ptr));
+    }
+    SD()._contextStates.erase(MockContext);
+    drvOcl.clEnqueueMemcpyINTEL = _enqueueMemcpyINTEL;
+    drvOcl.clEnqueueSVMMemcpy = _enqueueSVMMemcpy;
+    drvOcl.clFinish = _finish;
+  }
+  void AddUsm(TAllocation& allocation, UnifiedMemoryType type) {
+    auto* ptr = allocation.memory.data();
+    SD()._usmAllocStates[ptr] = std::make_shared<CCLUSMAllocState>(
+        MockContext, nullptr, nullptr, allocation.memory.size(), 0, type);
+    Add(allocation);
+  }
+  void AddSvm(TAllocation& allocation, cl_svm_mem_flags flags) {
+    auto* ptr = allocation.memory.data();
+    SD()._svmAllocStates[ptr] =
+        std::make_shared<CCLSVMAllocState>(MockContext, flags, allocation.memory.size(), 0);
+    Add(allocation);
+  }
+
+private:
+  void Add(TAllocation& allocation) {
+    auto* ptr = allocation.memory.data();
+    CCLMappedPtr::AddMapping(allocation.recorded, ptr);
+    _allocations.push_back(ptr);
+  }
+};
+
+// Stores recorded pointers into the target allocation, to its start or inside it, in
+// the slots of the allocation and marks the slots as not translated.
+void FillSlots(TAllocation& allocation, TAllocation& target, std::map<size_t, bool>& offsets) {
+  std::fill(allocation.memory.begin(), allocation.memory.end(), Filler);
+  for (size_t i = 0; i < allocation.slots.size(); ++i) {
+    const size_t targetOffset = (i % 5 == 0) ? 0 : (i * 72) % target.memory.size();
+    char* recorded = static_cast<char*>(target.recorded) + targetOffset;
+    std::memcpy(allocation.memory.data() + allocation.slots[i], &recorded, sizeof(void*));
+    allocation.targets.push_back(target.memory.data() + targetOffset);
+    offsets[allocation.slots[i]] = false;
+  }
+}
+
+void CheckSlots(const TAllocation& allocation,
+                const std::map<size_t, bool>& offsets,
+                const char* name) {
+  std::vector<bool> isSlot(allocation.memory.size());
+  for (size_t i = 0; i < allocation.slots.size(); ++i) {
+    void* translated = nullptr;
+    std::memcpy(&translated, allocation.memory.data() + allocation.slots[i], sizeof(void*));
+    if (translated != allocation.targets[i] || !offsets.at(allocation.slots[i])) {
+      throw std::runtime_error(std::string("pointer not translated in ") + name + " at offset " +
+                               std::to_string(allocation.slots[i]));
+    }
+    std::fill_n(isSlot.begin() + allocation.slots[i], sizeof(void*), true);
+  }
+  for (size_t i = 0; i < allocation.memory.size(); ++i) {
+    if (!isSlot[i] && allocation.memory[i] != Filler) {
+      throw std::runtime_error(std::string("memory around pointers modified in ") + name +
+                               " at offset " + std::to_string(i));
+    }
+  }
+}
+
+// Pointer slots of a kernel's allocations are translated before the kernel is enqueued.
+// Device USM and coarse-grained SVM allocations are translated through copies, host USM
+// and fine-grained SVM allocations in place. Slots are packed, clustered and sparse, so
+// coalesced reads and partial writes are both covered. All slots have to hold the player
+// pointers, nothing else may change, and translated slots aren't copied again.
+TSample PointerTranslation(const TContext& context) {
+  CMockDriver mock;
+  TAllocation target{reinterpret_cast<void*>(0x10000000), std::vector<char>(DeviceSize)};
+  TAllocation usmDevice{reinterpret_cast<void*>(0x20000000), std::vector<char>(DeviceSize)};
+  TAllocation usmHost{reinterpret_cast<void*>(0x30000000), std::vector<char>(HostSize)};
+  TAllocation svmCoarse{reinterpret_cast<void*>(0x40000000), std::vector<char>(HostSize)};
+  TAllocation svmFine{reinterpret_cast<void*>(0x50000000), std::vector<char>(HostSize)};
+  for (size_t offset = 0; offset < DeviceSize; offset += 16) {
+    usmDevice.slots.push_back(offset);
+  }
+  for (size_t offset = 8; offset < HostSize; offset += 64) {
+    usmHost.slots.push_back(offset);
+    svmFine.slots.push_back(offset);
+  }
+  for (size_t offset = 0; offset < HostSize; offset += 4096) {
+    for (size_t slot = 0; slot < 4; ++slot) {
+      svmCoarse.slots.push_back(offset + slot * 8);
+    }
+    svmCoarse.slots.push_back(offset + 200);
+    svmCoarse.slots.push_back(offset + 1000);
+  }
+  mock.AddUsm(target, UnifiedMemoryType::device);
+  mock.AddUsm(usmDevice, UnifiedMemoryType::device);
+  mock.AddUsm(usmHost, UnifiedMemoryType::host);
+  mock.AddSvm(svmCoarse, CL_MEM_READ_WRITE);
+  mock.AddSvm(svmFine, CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER);
+  auto& usmDeviceOffsets = SD()._usmAllocStates[usmDevice.memory.data()]->indirectPointersOffsets;
+  auto& usmHostOffsets = SD()._usmAllocStates[usmHost.memory.data()]->indirectPointersOffsets;
+  auto& svmCoarseOffsets = SD()._svmAllocStates[svmCoarse.memory.data()]->indirectPointersOffsets;
+  auto& svmFineOffsets = SD()._svmAllocStates[svmFine.memory.data()]->indirectPointersOffsets;
+  FillSlots(usmDevice, target, usmDeviceOffsets);
+  FillSlots(usmHost, target, usmHostOffsets);
+  FillSlots(svmCoarse, usmDevice, svmCoarseOffsets);
+  FillSlots(svmFine, svmCoarse, svmFineOffsets);
+  const size_t slots = usmDevice.slots.size() + usmHost.slots.size() + svmCoarse.slots.size() +
+                       svmFine.slots.size();
+
+  Timer timer;
+  TranslatePointers();
+  const int64_t time = timer.Get();
+
+  if (!mockQueue.pending.empty() || mockQueue.blockingCopies != 0 || mockQueue.copies == 0) {
+    throw std::runtime_error("pointer translation copies not finished or blocking");
+  }
+  CheckSlots(usmDevice, usmDeviceOffsets, "device USM");
+  CheckSlots(usmHost, usmHostOffsets, "host USM");
+  CheckSlots(svmCoarse, svmCoarseOffsets, "coarse-grained SVM");
+  CheckSlots(svmFine, svmFineOffsets, "fine-grained SVM");
+  const unsigned copies = mockQueue.copies;
+  TranslatePointers();
+  if (mockQueue.copies != copies) {
+    throw std::runtime_error("translated pointers copied again");
+  }
+  return {static_cast<double>(slots), time};
+}
+
+const CRegistrar pointerTranslation("opencl/pointer_translation", "pointers/s",
+                                    PointerTranslation);
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
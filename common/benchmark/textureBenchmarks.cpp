@@ -0,0 +1,77 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   textureBenchmarks.cpp
+ *
+ * @brief Benchmarks of texel conversion done for screenshots and resource dumps.
+ *
+ */
+
+#include "benchmark.h"
+#include "texture_converter.h"
+#include "timer.h"
+
+#include <cstring>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+const int Width = 1920;
+const int Height = 1080;
+const unsigned Images = 20;
+
+std::vector<uint8_t> Texels(texel_type type, size_t texelSize) {
+  const auto bytes = SyntheticData(static_cast<uint64_t>(Width) * Height * texelSize);
+  if (type != texel_type::RGBA32f && type != texel_type::R32f) {
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+  }
+  // Float images get values slightly out of the [0, 1] range, as rendered HDR targets.
+  std::vector<uint8_t> texels(bytes.size());
+  for (size_t i = 0; i + sizeof(float) <= bytes.size(); i += sizeof(float)) {
+    const float value = static_cast<uint8_t>(bytes[i]) / 200.0f - 0.1f;
+    std::memcpy(&texels[i], &value, sizeof(value));
+  }
+  return texels;
+}
+
+TSample ConvertImages(texel_type input,
+                      size_t inputTexelSize,
+                      texel_type output,
+                      unsigned threadCount) {
+  const auto texels = Texels(input, inputTexelSize);
+  std::vector<uint8_t> converted(static_cast<size_t>(Width) * Height * 4);
+  Timer timer;
+  for (unsigned i = 0; i < Images; ++i) {
+    convert_texture_data(input, texels, output, converted, Width, Height, threadCount);
+  }
+  return {static_cast<double>(Images), timer.Get()};
+}
+
+const CRegistrar rgba8("texture/rgba8_to_bgra8_1080p", "images/s", [](const TContext&) {
+  return ConvertImages(texel_type::RGBA8, 4, texel_type::BGRA8, 1);
+});
+const CRegistrar rgb10a2("texture/rgb10a2_to_bgra8_1080p", "images/s", [](const TContext&) {
+  return ConvertImages(texel_type::RGB10A2, 4, texel_type::BGRA8, 1);
+});
+const CRegistrar rgba32f("texture/rgba32f_to_bgra8_1080p", "images/s", [](const TContext&) {
+  return ConvertImages(texel_type::RGBA32f, 16, texel_type::BGRA8, 1);
+});
+const CRegistrar rgba32fThreads("texture/rgba32f_to_bgra8_1080p_all_threads", "images/s",
+                                [](const TContext&) {
+                                  return ConvertImages(texel_type::RGBA32f, 16, texel_type::BGRA8,
+                                                       0);
+                                });
+const CRegistrar r32f("texture/r32f_to_rgba8_1080p", "images/s", [](const TContext&) {
+  return ConvertImages(texel_type::R32f, 4, texel_type::RGBA8, 1);
+});
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
@@ -0,0 +1,170 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   threadSyncBenchmarks.cpp
+ *
+ * @brief Stress benchmark of timeline semaphore waiters of the Vulkan recorder.
+ *
+ */
+
+#include "benchmark.h"
+#include "timer.h"
+#include "vulkanTimelineWaitRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace gits {
+namespace benchmark {
+
+namespace {
+const unsigned Semaphores = 64;
+const unsigned Waiters = 512;
+// Timeline values signaled on every semaphore, waiters wait for values 1 to SignaledValues.
+const unsigned SignaledValues = Waiters / Semaphores;
+
+typedef uint64_t TSemaphore;
+
+struct TWaiter {
+  uint32_t count;
+  TSemaphore semaphores[2];
+  uint64_t values[2];
+  bool waitAny;
+};
+
+// State shared with waiter threads. It is kept alive by the threads, so they can be
+// detached if some of them never wake.
+struct TWaitState {
+  std::recursive_mutex mutex;
+  std::condition_variable_any woken;
+  Vulkan::CTimelineWaitRegistry<TSemaphore> registry;
+  std::vector<TWaiter> waiters;
+  std::vector<uint64_t> signaled;   // Last value signaled on each semaphore.
+  std::vector<unsigned> wakes;      // Returns from Wait of each waiter.
+  std::vector<unsigned> earlyWakes; // Returns before the waiter was satisfied.
+  unsigned started = 0;
+  unsigned finished = 0;
+  TWaitState() : waiters(Waiters), signaled(Semaphores), wakes(Waiters), earlyWakes(Waiters) {}
+};
+
+TSemaphore Semaphore(unsigned index) {
+  return 0x7f0000001000 + index * 0x40;
+}
+
+unsigned SemaphoreIndex(TSemaphore semaphore) {
+  return static_cast<unsigned>((semaphore - 0x7f0000001000) / 0x40);
+}
+
+// Waiters wait for a single value, for all of two values or for any of two values, as
+// vkWaitSemaphores calls with and without VK_SEMAPHORE_WAIT_ANY_BIT.
+void PrepareWaiters(TWaitState& state, std::mt19937& random) {
+  for (unsigned i = 0; i < Waiters; ++i) {
+    auto& waiter = state.waiters[i];
+    waiter.count = i % 3 == 0 ? 1 : 2;
+    waiter.waitAny = i % 3 == 2;
+    for (unsigned j = 0; j < waiter.count; ++j) {
+      waiter.semaphores[j] = Semaphore((i + j * 7) % Semaphores);
+      waiter.values[j] = 1 + random() % SignaledValues;
+    }
+  }
+}
+
+bool Satisfied(const TWaitState& state, const TWaiter& waiter) {
+  unsigned satisfied = 0;
+  for (unsigned j = 0; j < waiter.count; ++j) {
+    if (state.signaled[SemaphoreIndex(waiter.semaphores[j])] >= waiter.values[j]) {
+      ++satisfied;
+    }
+  }
+  return waiter.waitAny ? satisfied > 0 : satisfied == waiter.count;
+}
+
+// Starts several hundred waiter threads, then signals all values of all semaphores with
+// semaphores taken in random order. Every waiter has to wake exactly once and only after
+// the values it waits for are signaled.
+TSample TimelineWaiters(const TContext& context) {
+  std::mt19937 random(12345);
+  auto state = std::make_shared<TWaitState>();
+  PrepareWaiters(*state, random);
+
+  std::vector<unsigned> signals;
+  for (unsigned i = 0; i < Semaphores; ++i) {
+    signals.insert(signals.end(), SignaledValues, i);
+  }
+  std::shuffle(signals.begin(), signals.end(), random);
+
+  Timer timer;
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < Waiters; ++i) {
+    threads.emplace_back([state, i] {
+      std::unique_lock<std::recursive_mutex> lock(state->mutex);
+      const auto& waiter = state->waiters[i];
+      ++state->started;
+      state->registry.Wait(lock, waiter.count, waiter.semaphores, waiter.values, waiter.waitAny);
+      ++state->wakes[i];
+      if (!Satisfied(*state, waiter)) {
+        ++state->earlyWakes[i];
+      }
+      ++state->finished;
+      state->woken.notify_one();
+    });
+  }
+  // No value is signaled yet, so all waiters are registered once they have started.
+  while (true) {
+    std::unique_lock<std::recursive_mutex> lock(state->mutex);
+    if (state->started == Waiters) {
+      break;
+    }
+    lock.unlock();
+    std::this_thread::yield();
+  }
+  for (auto index : signals) {
+    std::unique_lock<std::recursive_mutex> lock(state->mutex);
+    const uint64_t value = ++state->signaled[index];
+    state->registry.Signal(Semaphore(index), value);
+  }
+
+  unsigned finished = 0;
+  {
+    std::unique_lock<std::recursive_mutex> lock(state->mutex);
+    state->woken.wait_for(lock, std::chrono::seconds(30),
+                          [&] { return state->finished == Waiters; });
+    finished = state->finished;
+  }
+  if (finished != Waiters) {
+    for (auto& thread : threads) {
+      thread.detach();
+    }
+    throw std::runtime_error("timeline waiters not woken: " + std::to_string(Waiters - finished));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const int64_t time = timer.Get();
+
+  for (unsigned i = 0; i < Waiters; ++i) {
+    if (state->wakes[i] != 1 || state->earlyWakes[i] != 0) {
+      throw std::runtime_error("timeline waiter " + std::to_string(i) + " woken " +
+                               std::to_string(state->wakes[i]) + " times, " +
+                               std::to_string(state->earlyWakes[i]) + " before satisfied");
+    }
+  }
+  return {static_cast<double>(Waiters), time};
+}
+
+const CRegistrar timelineWaiters("thread_sync/timeline_waiters", "waiters/s", TimelineWaiters);
+} // namespace
+
+} // namespace benchmark
+} // namespace gits
@@ -545,6 +545,7 @@ bool MemorySniffer::WriteCallback(void* addr, bool writeIntention = true) {
     }
   }
   if (writeIntention) {
+    gits::telemetry::MemoryWriteFault();
     if (!unveilWholeRegion) {
       SetPagesProtection(PageMemoryProtection::READ_WRITE, addr);
     }
@@ -743,6 +744,8 @@ bool MemorySniffer::Install() {
   }
   return true;
 #else
+  // Telemetry is created here, the signal handler must not initialize it.
+  gits::telemetry::Data();
   struct sigaction sa = {};
   sa.sa_flags = SA_SIGINFO;
   sa.sa_sigaction = &MemorySnifferSignalHandler;
@@ -0,0 +1,138 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   compression_policy.cpp
+ *
+ * @brief Adaptive compression of recorded streams.
+ *
+ */
+
+#include "compression_policy.h"
+#include "gits.h"
+#include "log.h"
+
+#include <mutex>
+
+namespace gits {
+
+namespace {
+// Chunks compressed to more than this fraction of their size are stored uncompressed.
+const double IncompressibleRatio = 0.9;
+// Every that many chunks of an incompressible type one is compressed to check if it changed.
+const uint64_t ProbeInterval = 16;
+// Weight of the last chunk in the smoothed ratio.
+const double RatioSmoothing = 0.25;
+// Level is raised after that many reports of an empty writer queue.
+const unsigned DrainedReports = 16;
+
+const char* const writeTypeNames[] = {"standalone", "package", "large standalone"};
+
+std::mutex levelMutex;
+uint32_t currentLevel = 0;
+unsigned drainedReports = 0;
+} // namespace
+
+CCompressionPolicy::CCompressionPolicy(std::string name) : _name(std::move(name)) {}
+
+CCompressionPolicy::~CCompressionPolicy() {
+  for (auto type : {WriteType::PACKAGE, WriteType::STANDALONE, WriteType::LARGE_STANDALONE}) {
+    const auto& stats = _stats[type];
+    if (stats.chunks == 0) {
+      continue;
+    }
+    LOG_INFO << "Adaptive compression of " << _name << ", " << writeTypeNames[type]
+             << " chunks: " << stats.chunks << " written, " << stats.rawChunks
+             << " stored uncompressed, ratio "
+             << (stats.compressedSize ? (double)stats.size / stats.compressedSize : 0.0)
+             << ", compression "
+             << (stats.time ? stats.sampledSize * 1e9 / stats.time / (1024 * 1024) : 0.0)
+             << " MB/s";
+  }
+}
+
+bool CCompressionPolicy::ShouldCompress(WriteType type) {
+  auto& stats = _stats[type];
+  if (stats.samples == 0 || stats.ratio <= IncompressibleRatio) {
+    return true;
+  }
+  // Content of a type changes over time, e.g. when a scene starts streaming textures.
+  if (++stats.skipped >= ProbeInterval) {
+    stats.skipped = 0;
+    return true;
+  }
+  return false;
+}
+
+bool CCompressionPolicy::Compressed(WriteType type,
+                                    uint64_t size,
+                                    uint64_t compressedSize,
+                                    int64_t time) {
+  auto& stats = _stats[type];
+  const double ratio = size ? (double)compressedSize / size : 1.0;
+  stats.ratio = stats.samples == 0 ? ratio
+                                   : stats.ratio * (1.0 - RatioSmoothing) + ratio * RatioSmoothing;
+  stats.samples++;
+  stats.sampledSize += size;
+  stats.time += time;
+
+  if (ratio > IncompressibleRatio) {
+    StoredRaw(type, size);
+    return false;
+  }
+  stats.chunks++;
+  stats.size += size;
+  stats.compressedSize += compressedSize;
+  return true;
+}
+
+void CCompressionPolicy::StoredRaw(WriteType type, uint64_t size) {
+  auto& stats = _stats[type];
+  stats.chunks++;
+  stats.rawChunks++;
+  stats.size += size;
+  stats.compressedSize += size;
+}
+
+void CCompressionPolicy::WriterQueueDepth(size_t depth, size_t capacity, bool consumer) {
+  const auto& compression = Configurator::Get().common.recorder.compression;
+  if (!compression.adaptive || compression.type == CompressionType::NONE) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(levelMutex);
+  if (currentLevel == 0) {
+    currentLevel = compression.level;
+  }
+  uint32_t level = currentLevel;
+  if (depth * 4 >= capacity * 3) {
+    // Writer doesn't keep up with the application, trade compression ratio for speed.
+    drainedReports = 0;
+    if (level > 1) {
+      level--;
+    }
+  } else if (consumer) {
+    // Producer reports the queue right after adding a burst to it, so only the writer
+    // thread sees it empty.
+    if (depth > 0) {
+      drainedReports = 0;
+    } else if (++drainedReports >= DrainedReports && level < compression.level) {
+      drainedReports = 0;
+      level++;
+    }
+  }
+
+  if (level != currentLevel) {
+    LOG_TRACE << "Writer queue depth " << depth << "/" << capacity
+              << ", changing compression level to " << level;
+    currentLevel = level;
+    CGits::Instance().GitsStreamCompressor().SetLevel(level);
+  }
+}
+
+} // namespace gits
@@ -0,0 +1,198 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   direct_file_buf.cpp
+ *
+ * @brief Output stream buffer writing files with direct I/O.
+ *
+ */
+
+#include "direct_file_buf.h"
+
+#ifdef GITS_PLATFORM_LINUX
+
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace gits {
+
+namespace {
+// Offsets and sizes of direct I/O writes have to be multiples of the logical block size
+// of the device, 4 KiB covers all common devices.
+const uint64_t directIOAlignment = 4096;
+const uint64_t directIOBufferSize = 8 * 1024 * 1024;
+const uint64_t preallocationStep = 256 * 1024 * 1024;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+CDirectFileBuf* CDirectFileBuf::Open(const std::filesystem::path& path) {
+  const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return nullptr;
+  }
+  void* buffer = nullptr;
+  if (posix_memalign(&buffer, directIOAlignment, directIOBufferSize) != 0) {
+    close(fd);
+    return nullptr;
+  }
+  return new CDirectFileBuf(path, fd, static_cast<char*>(buffer));
+}
+
+CDirectFileBuf::CDirectFileBuf(const std::filesystem::path& path, int fd, char* buffer)
+    : _path(path),
+      _fd(fd),
+      _buffer(buffer),
+      _bufferOffset(0),
+      _preallocated(0),
+      _preallocate(true),
+      _bytesWritten(0),
+      _writeTime(0) {
+  setp(_buffer, _buffer + directIOBufferSize);
+}
+
+CDirectFileBuf::~CDirectFileBuf() {
+  if (sync() != 0) {
+    LOG_ERROR << "Direct I/O: final flush of " << _path << " failed, the file is incomplete: "
+              << strerror(errno);
+  }
+  const uint64_t size = _bufferOffset + (pptr() - pbase());
+  const uint64_t allocatedEnd = AlignUp(size, directIOAlignment);
+  if (_preallocated > allocatedEnd) {
+    // Release space preallocated past the end of the file.
+    fallocate(_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, allocatedEnd,
+              _preallocated - allocatedEnd);
+  }
+  if (close(_fd) != 0) {
+    LOG_ERROR << "Direct I/O: closing " << _path << " failed: " << strerror(errno);
+  }
+  free(_buffer);
+
+  const double seconds = std::chrono::duration<double>(_writeTime).count();
+  if (_bytesWritten > 0 && seconds > 0) {
+    const double megabytes = _bytesWritten / (1024.0 * 1024.0);
+    LOG_INFO << "Direct I/O: written " << megabytes << " MB to " << _path << " at "
+             << megabytes / seconds << " MB/s.";
+  }
+}
+
+bool CDirectFileBuf::Preallocate(uint64_t end) {
+  if (!_preallocate || end <= _preallocated) {
+    return true;
+  }
+  const uint64_t newEnd = AlignUp(end, preallocationStep);
+  if (fallocate(_fd, FALLOC_FL_KEEP_SIZE, _preallocated, newEnd - _preallocated) != 0) {
+    if (errno == ENOSPC) {
+      return false;
+    }
+    // File system not supporting preallocation is not an error.
+    _preallocate = false;
+    return true;
+  }
+  _preallocated = newEnd;
+  return true;
+}
+
+bool CDirectFileBuf::WriteBlocks(uint64_t size) {
+  if (!Preallocate(_bufferOffset + size)) {
+    return false;
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  uint64_t written = 0;
+  while (written < size) {
+    const auto ret = pwrite(_fd, _buffer + written, size - written, _bufferOffset + written);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      LOG_ERROR << "Direct I/O write to " << _path << " failed: " << strerror(errno);
+      return false;
+    }
+    written += ret;
+  }
+  _writeTime += std::chrono::steady_clock::now() - begin;
+  _bytesWritten += size;
+  return true;
+}
+
+CDirectFileBuf::int_type CDirectFileBuf::overflow(int_type ch) {
+  if (pptr() == epptr()) {
+    if (!WriteBlocks(directIOBufferSize)) {
+      return traits_type::eof();
+    }
+    _bufferOffset += directIOBufferSize;
+    setp(_buffer, _buffer + directIOBufferSize);
+  }
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+std::streamsize CDirectFileBuf::xsputn(const char* s, std::streamsize n) {
+  std::streamsize copied = 0;
+  while (copied < n) {
+    if (pptr() == epptr() && traits_type::eq_int_type(overflow(traits_type::eof()),
+                                                      traits_type::eof())) {
+      break;
+    }
+    const auto chunk = std::min<std::streamsize>(n - copied, epptr() - pptr());
+    std::memcpy(pptr(), s + copied, chunk);
+    pbump(static_cast<int>(chunk));
+    copied += chunk;
+  }
+  return copied;
+}
+
+int CDirectFileBuf::sync() {
+  // The partial last block is written padded and the file is truncated to the real size.
+  // The block stays in the buffer and is written again with the data that follows it.
+  const uint64_t used = pptr() - pbase();
+  if (used == 0) {
+    return 0;
+  }
+  const uint64_t padded = AlignUp(used, directIOAlignment);
+  std::memset(_buffer + used, 0, padded - used);
+  if (!WriteBlocks(padded) || ftruncate(_fd, _bufferOffset + used) != 0) {
+    return -1;
+  }
+  // Truncation also releases the space preallocated past the end of the file.
+  _preallocated = std::min(_preallocated, AlignUp(_bufferOffset + used, directIOAlignment));
+  const uint64_t fullBlocks = used / directIOAlignment * directIOAlignment;
+  const uint64_t tail = used - fullBlocks;
+  std::memmove(_buffer, _buffer + fullBlocks, tail);
+  _bufferOffset += fullBlocks;
+  setp(_buffer, _buffer + directIOBufferSize);
+  pbump(static_cast<int>(tail));
+  return 0;
+}
+
+CDirectFileBuf::pos_type CDirectFileBuf::seekoff(off_type off,
+                                                 std::ios_base::seekdir dir,
+                                                 std::ios_base::openmode which) {
+  // Only reporting the current position is supported.
+  if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) {
+    return pos_type(off_type(-1));
+  }
+  return pos_type(static_cast<off_type>(_bufferOffset + (pptr() - pbase())));
+}
+
+} // namespace gits
+
+#endif
@@ -0,0 +1,111 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   dump_pipeline.cpp
+ *
+ * @brief Background conversion and writing of captured resource dumps.
+ *
+ */
+
+#include "dump_pipeline.h"
+#include "configurationLib.h"
+#include "exception.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace gits {
+
+CDumpPipeline::CDumpPipeline(unsigned threadCount)
+    : _pendingMemory(0), _pendingJobs(0), _stop(false), _threadCount(threadCount) {}
+
+CDumpPipeline::~CDumpPipeline() {
+  try {
+    Finish();
+  } catch (...) {
+    topmost_exception_handler("CDumpPipeline::~CDumpPipeline");
+  }
+}
+
+void CDumpPipeline::Schedule(std::vector<char> snapshot, TJob job) {
+  const auto& cfg = Configurator::Get().common.shared;
+  const uint64_t memoryLimit = cfg.dumpMemoryLimit * 1024ULL * 1024ULL;
+  const uint64_t size = snapshot.size();
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_workers.empty()) {
+    unsigned threadCount = _threadCount != 0 ? _threadCount : cfg.dumpWorkerThreads;
+    if (threadCount == 0) {
+      threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+    _stop = false;
+    for (unsigned i = 0; i < threadCount; ++i) {
+      _workers.emplace_back(&CDumpPipeline::Work, this);
+    }
+  }
+
+  // Snapshot bigger than the limit is accepted once the pipeline is empty.
+  _jobDone.wait(lock, [&] {
+    return _pendingJobs == 0 || _pendingMemory + size <= memoryLimit;
+  });
+  _pendingMemory += size;
+  ++_pendingJobs;
+  _jobs.push_back({std::move(snapshot), std::move(job)});
+  lock.unlock();
+  _jobQueued.notify_one();
+}
+
+void CDumpPipeline::Flush() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _jobDone.wait(lock, [&] { return _pendingJobs == 0; });
+}
+
+void CDumpPipeline::Finish() {
+  Flush();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _jobQueued.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+  _workers.clear();
+}
+
+void CDumpPipeline::Work() {
+  for (;;) {
+    CDumpJob job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _jobQueued.wait(lock, [&] { return _stop || !_jobs.empty(); });
+      if (_jobs.empty()) {
+        return;
+      }
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+    }
+
+    try {
+      job.job(job.snapshot);
+    } catch (const std::exception& e) {
+      LOG_ERROR << "Writing resource dump failed: " << e.what();
+    } catch (...) {
+      LOG_ERROR << "Unknown error while writing resource dump";
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _pendingMemory -= job.snapshot.size();
+      --_pendingJobs;
+    }
+    _jobDone.notify_all();
+  }
+}
+
+} // namespace gits
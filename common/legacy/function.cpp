@@ -44,9 +44,6 @@ void gits::CFunction::Write(CBinOStream& stream) const {
   if (ret) {
     stream << *ret;
   }
-  if (Configurator::Get().common.recorder.highIntegrity) {
-    stream.flush();
-  }
 }
 
 /**
@@ -28,6 +28,7 @@
 
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 namespace gits {
 // Developer builds are of the form: dd.dd.dd.999
@@ -108,6 +109,8 @@ CGits::CGits(uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3)
 CGits::~CGits() {
   try {
     // Release all resources explicitly, before signature creation.
+    // Dump workers feed the image writer, so they have to finish first.
+    _dumpPipeline.Finish();
     _imageWriter.finish();
     _fileRecorder.reset();
     _filePlayer.reset();
@@ -444,7 +447,15 @@ std::ostream& operator<<(std::ostream& stream, const CGits& g) {
  * @return Output stream
  */
 CBinOStream& operator<<(CBinOStream& stream, const CGits& g) {
-  stream << g._version;
+  // Players older than adaptive compression fail on chunks stored uncompressed, a newer
+  // version makes them warn about the stream first.
+  const auto& compression = Configurator::Get().common.recorder.compression;
+  if (compression.adaptive && compression.type != CompressionType::NONE &&
+      g._version < CVersion(GITS_ADAPTIVE_COMPRESSION)) {
+    stream << CVersion(GITS_ADAPTIVE_COMPRESSION);
+  } else {
+    stream << g._version;
+  }
   stream << g.FileRecorder();
   return stream;
 }
@@ -466,7 +477,10 @@ CBinIStream& operator>>(CBinIStream& stream, CGits& g) {
 
   LOG_INFO << "Sequence recorded with: " << version;
   // check if file was not written with a newer version of GITS software
-  if (g._version < version) {
+  const CVersion supported = g._version < CVersion(GITS_ADAPTIVE_COMPRESSION)
+                                 ? CVersion(GITS_ADAPTIVE_COMPRESSION)
+                                 : g._version;
+  if (supported < version) {
     LOG_WARNING << "File is written with newer version: " << version << "!!!";
   }
 
@@ -618,11 +632,19 @@ void CGits::WriteImage(const std::string& filename,
                        bool flip,
                        bool isBGR,
                        bool isSRGB) {
+  std::unique_lock<std::mutex> lock(_imageWriterMutex);
   if (!_imageWriter.running()) {
+    unsigned threadCount = _configuration.common.shared.imageWriterThreads;
+    if (threadCount == 0) {
+      threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
     auto writer = std::make_shared<ImageWriter>();
-    _imageWriter.start([writer = std::move(writer)](auto& queue) mutable { (*writer)(queue); });
+    _imageWriter.start([writer = std::move(writer)](auto& queue) mutable { (*writer)(queue); },
+                       threadCount);
   }
 
+  lock.unlock();
+
   Image img(filename, width, height, hasAlpha, data, flip, isBGR, isSRGB);
   _imageWriter.queue().produce(img);
 }
@@ -0,0 +1,70 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   compression_policy.h
+ *
+ * @brief Adaptive compression of recorded streams.
+ *
+ */
+
+#pragma once
+
+#include "streams.h"
+#include "tools.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gits {
+
+/**
+   * @brief Adaptive compression policy of a stream writer
+   *
+   * Each gits::CBinOStream with adaptive compression enabled has its own policy, so
+   * statistics are kept separately for the token stream and for every resource file.
+   * The policy samples compression ratio and throughput per chunk type and stores
+   * chunks of types that don't compress well uncompressed, probing them again from
+   * time to time. Compression level of the stream compressor is lowered when the
+   * writer queue backs up and restored when it drains.
+   */
+class CCompressionPolicy : private gits::noncopyable {
+  struct TTypeStats {
+    double ratio = 0.0; // Smoothed compressed to uncompressed size ratio.
+    uint64_t samples = 0;
+    uint64_t skipped = 0; // Chunks stored uncompressed since the last probe.
+    uint64_t chunks = 0;
+    uint64_t rawChunks = 0;
+    uint64_t size = 0;
+    uint64_t compressedSize = 0;
+    uint64_t sampledSize = 0;
+    int64_t time = 0;
+  };
+
+  std::string _name;
+  TTypeStats _stats[3];
+
+public:
+  explicit CCompressionPolicy(std::string name);
+  ~CCompressionPolicy();
+
+  // Returns false if chunk should be stored uncompressed without trying to compress it.
+  bool ShouldCompress(WriteType type);
+  // Records compression of a chunk, returns false if it should be stored uncompressed.
+  bool Compressed(WriteType type, uint64_t size, uint64_t compressedSize, int64_t time);
+  // Records chunk stored uncompressed without compressing it.
+  void StoredRaw(WriteType type, uint64_t size);
+
+  // Adjusts compression level to the number of token bursts waiting in the writer queue.
+  // Level is lowered on reports of both sides of the queue and raised only on reports of
+  // the consumer.
+  static void WriterQueueDepth(size_t depth, size_t capacity, bool consumer);
+};
+
+} // namespace gits
@@ -0,0 +1,70 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   direct_file_buf.h
+ *
+ * @brief Output stream buffer writing files with direct I/O.
+ *
+ */
+
+#pragma once
+
+#include "platform.h"
+
+#ifdef GITS_PLATFORM_LINUX
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <streambuf>
+
+namespace gits {
+
+/**
+   * @brief Direct I/O file output buffer
+   *
+   * Writes go to an aligned buffer which is written to the file opened with O_DIRECT
+   * in large, aligned blocks, so recording big streams does not thrash the page cache.
+   * File space is preallocated ahead of the writes to keep the file contiguous.
+   * Only appending is supported. Measured write bandwidth is logged when the buffer
+   * is destroyed.
+   */
+class CDirectFileBuf : public std::streambuf {
+  std::filesystem::path _path;
+  int _fd;
+  char* _buffer;
+  uint64_t _bufferOffset; // File offset of the first byte of the buffer, always aligned.
+  uint64_t _preallocated;
+  bool _preallocate;
+  uint64_t _bytesWritten;
+  std::chrono::steady_clock::duration _writeTime;
+
+  CDirectFileBuf(const std::filesystem::path& path, int fd, char* buffer);
+  bool WriteBlocks(uint64_t size);
+  bool Preallocate(uint64_t end);
+
+protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+  pos_type seekoff(off_type off,
+                   std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override;
+
+public:
+  // Returns nullptr if the file system does not support direct I/O.
+  static CDirectFileBuf* Open(const std::filesystem::path& path);
+  CDirectFileBuf(const CDirectFileBuf&) = delete;
+  CDirectFileBuf& operator=(const CDirectFileBuf&) = delete;
+  ~CDirectFileBuf() override;
+};
+
+} // namespace gits
+
+#endif
@@ -0,0 +1,73 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   dump_pipeline.h
+ *
+ * @brief Background conversion and writing of captured resource dumps.
+ *
+ */
+
+#pragma once
+
+#include "tools_lite.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gits {
+
+/**
+   * @brief Resource dump pipeline
+   *
+   * Takes host snapshots of resources captured on the replay thread and passes them
+   * to a pool of worker threads doing format conversion and file output. Scheduling
+   * blocks while the snapshots waiting in the pipeline exceed the memory limit.
+   */
+class CDumpPipeline : private gits::noncopyable {
+public:
+  typedef std::function<void(const std::vector<char>& snapshot)> TJob;
+
+private:
+  struct CDumpJob {
+    std::vector<char> snapshot;
+    TJob job;
+  };
+
+  std::mutex _mutex;
+  std::condition_variable _jobQueued;
+  std::condition_variable _jobDone;
+  std::deque<CDumpJob> _jobs;
+  uint64_t _pendingMemory;
+  unsigned _pendingJobs;
+  bool _stop;
+  unsigned _threadCount;
+  std::vector<std::thread> _workers;
+
+  void Work();
+
+public:
+  // Thread count 0 takes the dumpWorkerThreads option. A single worker runs the jobs in
+  // the order they were scheduled.
+  explicit CDumpPipeline(unsigned threadCount = 0);
+  ~CDumpPipeline();
+
+  // Takes over the snapshot and runs the job on it on a worker thread.
+  void Schedule(std::vector<char> snapshot, TJob job);
+  // Waits until all scheduled jobs are finished.
+  void Flush();
+  // Flushes the pipeline and stops the workers.
+  void Finish();
+};
+
+} // namespace gits
@@ -25,10 +25,13 @@
 #include "pragmas.h"
 #include "apis_iface.h"
 #include "messageBus.h"
+#include "dump_pipeline.h"
+#include "telemetry.h"
 
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <filesystem>
@@ -47,6 +50,8 @@
 #define GITS_TOKEN_COMPRESSION        GITS_MAKE_VERSION3(2, 0, 10)
 #define GITS_API_INFO                 GITS_MAKE_VERSION3(2, 0, 11)
 #define GITS_DX12_ENCODING_FIX        GITS_MAKE_VERSION3(2, 0, 12)
+// Written only by recorders with adaptive compression, which may store chunks uncompressed.
+#define GITS_ADAPTIVE_COMPRESSION     GITS_MAKE_VERSION3(2, 0, 13)
 
 struct lua_State;
 
@@ -206,6 +211,8 @@ private:
   Events _playbackEvents;
   std::shared_ptr<lua_State> _lua;
   Task<Image> _imageWriter;
+  std::mutex _imageWriterMutex;
+  CDumpPipeline _dumpPipeline;
   StreamingContext* _sc;
   TimerSet _timers;
 
@@ -334,9 +341,11 @@ public:
 
   void StateRestoreStarted() {
     _restoringState = true;
+    telemetry::StateRestoreStarted();
   }
   void StateRestoreFinished() {
     _restoringState = false;
+    telemetry::StateRestoreFinished();
   }
   void SetPlayerFinish() {
     _finished.store(true);
@@ -431,6 +440,9 @@ public:
   FrameTimeSheet& TimeSheet() {
     return _timeSheet;
   }
+  CDumpPipeline& DumpPipeline() {
+    return _dumpPipeline;
+  }
   //destroys the data argument
   void WriteImage(const std::string& filename,
                   size_t width,
@@ -0,0 +1,273 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+#include <smmintrin.h>
+#endif
+
+namespace gits {
+
+template <class T>
+inline uint64_t HandleToUint64(T handle) {
+  if constexpr (std::is_pointer_v<T>) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+  } else {
+    return static_cast<uint64_t>(handle);
+  }
+}
+
+// Handles are mostly aligned pointers, so low bits carry little entropy.
+// Fibonacci hashing spreads them evenly over the power-of-two table.
+inline uint64_t HashHandle(uint64_t handle) {
+  return (handle ^ (handle >> 32)) * 0x9E3779B97F4A7C15ull;
+}
+
+// Handle to handle map used to translate recorded API object names into the
+// ones created during playback. Keys are kept in a flat array (probed two at a
+// time with SSE4.1 compares), so a lookup touches one cache line of keys in the
+// common case and never allocates. Values are copied to a flat array next to
+// the keys for Get and FindBatch. Find returns pointers into fixed-size chunks
+// referenced by slot numbers, which rehashing never moves, so the pointers stay
+// valid until their key is removed.
+template <class T>
+class HandleRemapper {
+  static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+  static constexpr uint64_t DELETED_KEY = UINT64_MAX - 1;
+  static constexpr size_t GROUP_SIZE = 2;
+  static constexpr size_t MIN_CAPACITY = 64;
+  static constexpr size_t CHUNK_SHIFT = 10;
+  static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+
+  std::vector<uint64_t> _keys;
+  std::vector<T> _values;
+  std::vector<uint32_t> _slots; // stable value slot of the key at the same position
+  std::vector<std::unique_ptr<T[]>> _chunks;
+  std::vector<uint32_t> _freeSlots;
+  uint32_t _slotCount; // slots handed out from chunks, including freed ones
+  size_t _size;
+  size_t _used; // live entries and tombstones
+  size_t _groupMask;
+  // Keys colliding with the internal markers are extremely unlikely, but
+  // still valid handle values, so they get dedicated storage.
+  bool _hasReserved[2];
+  T _reservedValues[2];
+
+  static bool IsReserved(uint64_t key) {
+    return key >= DELETED_KEY;
+  }
+  static size_t ReservedIdx(uint64_t key) {
+    return (size_t)(key - DELETED_KEY);
+  }
+  size_t HomeGroup(uint64_t key) const {
+    return (size_t)(HashHandle(key) >> 32) & _groupMask;
+  }
+  T& Value(uint32_t slot) {
+    return _chunks[slot >> CHUNK_SHIFT][slot & (CHUNK_SIZE - 1)];
+  }
+  uint32_t NewSlot() {
+    if (!_freeSlots.empty()) {
+      const uint32_t slot = _freeSlots.back();
+      _freeSlots.pop_back();
+      return slot;
+    }
+    if (_slotCount == _chunks.size() * CHUNK_SIZE) {
+      _chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+    }
+    return _slotCount++;
+  }
+
+  // Returns position of the key or SIZE_MAX. Group probing: the first group
+  // containing an empty slot terminates the search, as inserts always take the
+  // first free slot in group order.
+  size_t FindPos(uint64_t key) const {
+    if (_keys.empty()) {
+      return SIZE_MAX;
+    }
+    const uint64_t* keys = _keys.data();
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+    const __m128i keyVec = _mm_set1_epi64x((long long)key);
+    const __m128i emptyVec = _mm_set1_epi64x((long long)EMPTY_KEY);
+    for (size_t group = HomeGroup(key);; group = (group + 1) & _groupMask) {
+      const size_t base = group * GROUP_SIZE;
+      const __m128i slots = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + base));
+      const int match = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(slots, keyVec)));
+      if (match != 0) {
+        return base + ((match & 1) ? 0 : 1);
+      }
+      if (_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(slots, emptyVec))) != 0) {
+        return SIZE_MAX;
+      }
+    }
+#else
+    for (size_t group = HomeGroup(key);; group = (group + 1) & _groupMask) {
+      const size_t base = group * GROUP_SIZE;
+      bool hasEmpty = false;
+      for (size_t lane = 0; lane < GROUP_SIZE; ++lane) {
+        if (keys[base + lane] == key) {
+          return base + lane;
+        }
+        hasEmpty |= keys[base + lane] == EMPTY_KEY;
+      }
+      if (hasEmpty) {
+        return SIZE_MAX;
+      }
+    }
+#endif
+  }
+
+  size_t FindFreePos(uint64_t key) const {
+    for (size_t group = HomeGroup(key);; group = (group + 1) & _groupMask) {
+      const size_t base = group * GROUP_SIZE;
+      for (size_t lane = 0; lane < GROUP_SIZE; ++lane) {
+        if (_keys[base + lane] >= DELETED_KEY) {
+          return base + lane;
+        }
+      }
+    }
+  }
+
+  // Values in chunks stay in place, only their flat copies move.
+  void Rehash(size_t capacity) {
+    std::vector<uint64_t> oldKeys(capacity, EMPTY_KEY);
+    std::vector<T> oldValues(capacity);
+    std::vector<uint32_t> oldSlots(capacity);
+    oldKeys.swap(_keys);
+    oldValues.swap(_values);
+    oldSlots.swap(_slots);
+    _groupMask = capacity / GROUP_SIZE - 1;
+    _used = _size;
+    for (size_t i = 0; i < oldKeys.size(); ++i) {
+      if (!IsReserved(oldKeys[i])) {
+        size_t pos = FindFreePos(oldKeys[i]);
+        _keys[pos] = oldKeys[i];
+        _values[pos] = oldValues[i];
+        _slots[pos] = oldSlots[i];
+      }
+    }
+  }
+
+public:
+  HandleRemapper()
+      : _slotCount(0), _size(0), _used(0), _groupMask(0), _hasReserved{false, false} {}
+
+  size_t size() const {
+    return _size + (_hasReserved[0] ? 1 : 0) + (_hasReserved[1] ? 1 : 0);
+  }
+
+  void Add(T key, T value) {
+    const uint64_t k = HandleToUint64(key);
+    if (IsReserved(k)) {
+      _hasReserved[ReservedIdx(k)] = true;
+      _reservedValues[ReservedIdx(k)] = value;
+      return;
+    }
+    size_t pos = FindPos(k);
+    if (pos != SIZE_MAX) {
+      _values[pos] = value;
+      Value(_slots[pos]) = value;
+      return;
+    }
+    // Keep occupancy (including tombstones) at or below 1/2.
+    if ((_used + 1) * 2 > _keys.size()) {
+      Rehash(_keys.empty() ? MIN_CAPACITY
+                           : ((_size + 1) * 4 > _keys.size() ? _keys.size() * 2 : _keys.size()));
+    }
+    pos = FindFreePos(k);
+    if (_keys[pos] == EMPTY_KEY) {
+      _used++;
+    }
+    _keys[pos] = k;
+    _values[pos] = value;
+    _slots[pos] = NewSlot();
+    Value(_slots[pos]) = value;
+    _size++;
+  }
+
+  void Remove(T key) {
+    const uint64_t k = HandleToUint64(key);
+    if (IsReserved(k)) {
+      _hasReserved[ReservedIdx(k)] = false;
+      return;
+    }
+    size_t pos = FindPos(k);
+    if (pos != SIZE_MAX) {
+      _keys[pos] = DELETED_KEY;
+      _freeSlots.push_back(_slots[pos]);
+      _size--;
+    }
+  }
+
+  // Returns pointer to the mapped value (valid until the key is removed) or nullptr.
+  T* Find(T key) {
+    const uint64_t k = HandleToUint64(key);
+    if (IsReserved(k)) {
+      return _hasReserved[ReservedIdx(k)] ? &_reservedValues[ReservedIdx(k)] : nullptr;
+    }
+    size_t pos = FindPos(k);
+    return pos == SIZE_MAX ? nullptr : &Value(_slots[pos]);
+  }
+
+  // Copies the mapped value without touching the chunks. Returns false if there is none.
+  bool Get(T key, T& value) const {
+    const uint64_t k = HandleToUint64(key);
+    if (IsReserved(k)) {
+      if (_hasReserved[ReservedIdx(k)]) {
+        value = _reservedValues[ReservedIdx(k)];
+      }
+      return _hasReserved[ReservedIdx(k)];
+    }
+    size_t pos = FindPos(k);
+    if (pos == SIZE_MAX) {
+      return false;
+    }
+    value = _values[pos];
+    return true;
+  }
+
+  // Translates num keys. Home groups of all keys are prefetched first, so the
+  // memory latency of independent lookups overlaps. Returns index of the first
+  // key without mapping (its value is left untouched) or num if all were found.
+  size_t FindBatch(const T* keys, T* values, size_t num) const {
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+    if (!_keys.empty()) {
+      for (size_t i = 0; i < num; ++i) {
+        const size_t base = HomeGroup(HandleToUint64(keys[i])) * GROUP_SIZE;
+        _mm_prefetch(reinterpret_cast<const char*>(_keys.data() + base), _MM_HINT_T0);
+      }
+    }
+#endif
+    for (size_t i = 0; i < num; ++i) {
+      if (!Get(keys[i], values[i])) {
+        return i;
+      }
+    }
+    return num;
+  }
+
+  void Clear() {
+    _keys.clear();
+    _values.clear();
+    _slots.clear();
+    _chunks.clear();
+    _freeSlots.clear();
+    _slotCount = 0;
+    _size = 0;
+    _used = 0;
+    _groupMask = 0;
+    _hasReserved[0] = _hasReserved[1] = false;
+  }
+};
+
+} // namespace gits
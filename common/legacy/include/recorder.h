@@ -21,6 +21,7 @@
 #include "performance.h"
 #include "pragmas.h"
 #include "InputListener.h"
+#include "token_sequencer.h"
 
 #include <list>
 #include <vector>
@@ -73,6 +74,8 @@ class CRecorder : private gits::noncopyable {
 
   std::vector<std::function<void()>> _disposeEvents;
   StreamingContext _sc;
+  // Destroyed before the scheduler it delivers tokens to.
+  std::unique_ptr<CTokenSequencer> _sequencer;
 
   CRecorder();
   CRecorder(const CRecorder& other) = delete;
@@ -11,11 +11,15 @@
 #include "tools.h"
 #include "pragmas.h"
 
+#include <atomic>
+#include <map>
 #include <unordered_map>
 #include <string>
 #include <limits>
 #include <memory>
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 namespace gits {
 enum TResourceType {
@@ -103,6 +107,19 @@ public:
 
   const std::filesystem::path& getIndexFilename() const;
 
+  // Total size of resources returned by get.
+  uint64_t loaded_size() const {
+    return loadedSize_;
+  }
+  // Size of resources put since the last flush_pending call in high integrity mode.
+  uint64_t pending_size() const {
+    return pendingSize_;
+  }
+  // Flushes data files, appends index entries put since the previous call to entries and
+  // stores current sizes of data files in fileSizes. Used by the stream journal.
+  void flush_pending(std::vector<std::pair<hash_t, TResourceHandle2>>& entries,
+                     std::map<uint32_t, uint64_t>& fileSizes);
+
   static const hash_t EmptyHash = 0;
 
 private:
@@ -112,6 +129,9 @@ private:
   std::unordered_map<uint32_t, std::filesystem::path> filenames_map_;
   std::unordered_map<uint32_t, uint64_t> file_sizes_;
   std::mutex mutex_;
+  std::vector<std::pair<hash_t, TResourceHandle2>> pending_;
+  std::atomic<uint64_t> pendingSize_;
+  uint64_t loadedSize_;
 
   hash_t fakeHash_;
   std::map<uint32_t, CBinOStream*> _fileWriter;
@@ -17,8 +17,12 @@
 
 #include "tools.h"
 #include "timer.h"
+#include "performance.h"
 #include "token.h"
 #include "runner.h"
+#include "stream_journal.h"
+
+#include <memory>
 
 namespace gits {
 
@@ -57,11 +61,24 @@ private:
 
   CBinOStream* _oBinStream;
   CBinIStream* _iBinStream;
+  std::unique_ptr<CStreamJournal> _journal;
 
   std::mutex _tokenRegisterMutex;
 
+  // Frames preloaded from the stream and played repeatedly in the frame loop mode.
+  CTokenList _loopTokens;
+  CTokenList::iterator _nextLoopToken;
+  unsigned _loopFrames;
+  unsigned _loopIteration;
+  bool _loopDone;
+  Timer _loopTimer;
+  FrameTimeSheet _loopTimeSheet;
+
+  void RegisterLocked(CToken* token);
   bool LoadChunk();
   CToken* Token();
+  void PrepareFrameLoop();
+  CToken* LoopToken();
 
 public:
 #if defined GITS_PLATFORM_WINDOWS
@@ -78,6 +95,11 @@ public:
   ~CScheduler();
 
   void Register(CToken* token);
+  // Registers tokens of a scheduler used as a batch, e.g. filled on a worker thread,
+  // keeping their order. The batch is left empty.
+  void RegisterBatch(CScheduler& batch);
+  // Writes registered tokens of a batch to the stream and deletes them, unless keep is set.
+  void WriteBatch(CBinOStream& stream, bool keep = false);
 
   bool Run(CAction& action);
 
@@ -85,10 +107,19 @@ public:
     _oBinStream = stream;
   }
   void Stream(CBinIStream* stream);
+  // Journal committing writes of the output stream in high integrity mode.
+  void Journal(std::unique_ptr<CStreamJournal> journal) {
+    _journal = std::move(journal);
+  }
 
   // Last chunk needs to be written by the owner of scheduler.
   void WriteChunk(bool purgeTokens = true);
   void WriteAll();
+
+  // Times of frame loop iterations, empty if frame loop was not played.
+  FrameTimeSheet& FrameLoopTimeSheet() {
+    return _loopTimeSheet;
+  }
 };
 
 } // namespace gits
@@ -0,0 +1,39 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_analyzer.h
+ *
+ * @brief Offline analysis of the size and content of recorded streams.
+ *
+ */
+
+#pragma once
+
+#include <filesystem>
+
+namespace gits {
+class CBinIStream;
+
+struct CAnalyzeSettings {
+  std::filesystem::path jsonPath; // Empty path writes text report only.
+  unsigned threads;               // 0 uses one thread per hardware thread.
+};
+
+/**
+   * @brief Prints cost breakdown of a recorded stream
+   *
+   * Reads all tokens of the stream, which has to be positioned after its header, and
+   * reports per function id the call count, serialized bytes and bytes of resources it
+   * references. It also reports token and byte counts per frame and the compression ratio
+   * of chunks per chunk type. Compressed chunks are decompressed in parallel ahead of the
+   * deserialization. Tokens are only deserialized, so no API driver is used.
+   */
+void AnalyzeStream(CBinIStream& stream, const CAnalyzeSettings& settings);
+
+} // namespace gits
@@ -0,0 +1,135 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_chunks.h
+ *
+ * @brief Reading and parallel decompression of compressed stream chunks.
+ *
+ */
+
+#pragma once
+
+#include "streams.h"
+#include "tools.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gits {
+
+// Compressed part of a chunk, large chunks consist of many parts.
+struct CChunkPart {
+  uint64_t size;
+  bool raw = false; // Stored uncompressed by the adaptive compression policy.
+  std::vector<char> data;
+};
+
+// Chunk of a compressed stream as it is stored in the file.
+struct CStreamChunk {
+  uint64_t offset;
+  WriteType type;
+  uint64_t size;
+  std::vector<CChunkPart> parts;
+};
+
+std::unique_ptr<StreamCompressor> CreateStreamCompressor(CompressionType type, uint32_t level);
+
+// Reads the next chunk of a compressed stream. Returns false at the end of file.
+bool ReadStreamChunk(CBinIStream& in, uint64_t fileSize, CStreamChunk& chunk);
+
+// Reads all remaining chunks of a compressed stream.
+std::vector<CStreamChunk> ReadStreamChunks(CBinIStream& in);
+
+// Decompresses the part into data, which has to hold part.size bytes.
+void DecompressStreamPart(StreamCompressor& decompressor, const CChunkPart& part, char* data);
+
+// Decompresses all parts of the chunk into data.
+void DecompressStreamChunk(StreamCompressor& decompressor,
+                           const CStreamChunk& chunk,
+                           std::vector<char>& data);
+
+/**
+   * @brief Parallel decompressor of a compressed stream
+   *
+   * Chunks are read from the file, or taken from chunks preloaded in memory, on a reader
+   * thread and decompressed on worker threads, at most window chunks ahead of the
+   * consumer. Decompressed chunks are returned in stream order, so they can be fed to
+   * a CBinIStream with SetChunkSource.
+   */
+class CChunkDecoder : private gits::noncopyable {
+public:
+  struct TTypeStats {
+    uint64_t count = 0;
+    uint64_t size = 0;
+    uint64_t compressedSize = 0;
+  };
+
+private:
+  struct CJob {
+    CStreamChunk chunk;
+    const CStreamChunk* source = nullptr;
+    std::vector<char> data;
+    bool done = false;
+    std::exception_ptr error;
+  };
+
+  std::unique_ptr<CBinIStream> _in;
+  uint64_t _fileSize;
+  std::vector<CStreamChunk> _chunks;
+  CompressionType _type;
+  size_t _window;
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::condition_variable _finished;
+  std::condition_variable _consumed;
+  std::deque<std::shared_ptr<CJob>> _jobs;
+  std::deque<std::shared_ptr<CJob>> _ordered;
+  bool _readerDone;
+  bool _stop;
+  std::exception_ptr _readerError;
+  std::thread _reader;
+  std::vector<std::thread> _workers;
+  TTypeStats _stats[3];
+
+  void Start(unsigned threads, unsigned window);
+  bool ReadNext(CJob& job, size_t& index);
+  void Read();
+  void Work();
+
+public:
+  // Decodes chunks of the file starting at offset, where the first chunk header is.
+  // 0 threads uses one thread per hardware thread, 0 window four chunks per thread.
+  CChunkDecoder(const std::filesystem::path& path,
+                uint64_t offset,
+                CompressionType type,
+                unsigned threads,
+                unsigned window = 0);
+  // Decodes chunks preloaded in memory.
+  CChunkDecoder(std::vector<CStreamChunk> chunks,
+                CompressionType type,
+                unsigned threads,
+                unsigned window = 0);
+  ~CChunkDecoder();
+
+  // Returns false at the end of the stream, rethrows errors of the reader and workers.
+  bool Next(std::vector<char>& data);
+  // Statistics of chunks returned so far, indexed by WriteType.
+  const TTypeStats& Stats(WriteType type) const {
+    return _stats[type];
+  }
+};
+
+} // namespace gits
@@ -0,0 +1,72 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_journal.h
+ *
+ * @brief Journal making streams recorded in high integrity mode recoverable after a crash.
+ *
+ */
+
+#pragma once
+
+#include "tools_lite.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+namespace gits {
+
+class CBinOStream;
+
+extern const char* const StreamJournalFileName;
+
+/**
+   * @brief High integrity mode stream journal
+   *
+   * Instead of flushing stream and resource files after every write, they are flushed
+   * in groups. After each group commit a checksummed, sequence numbered record with sizes
+   * of all the files and resource index entries added since the previous record is
+   * appended to the journal. A group is committed when the configured time window
+   * elapses or enough bytes are pending, whatever comes first.
+   */
+class CStreamJournal : private gits::noncopyable {
+  std::ofstream _file;
+  CBinOStream& _stream;
+  std::chrono::milliseconds _commitInterval;
+  uint64_t _commitSize;
+  std::chrono::steady_clock::time_point _lastCommit;
+  uint64_t _committedStreamSize;
+  uint64_t _sequence;
+  bool _closed;
+
+  void WriteRecord(bool closing);
+
+public:
+  CStreamJournal(const std::filesystem::path& fileName, CBinOStream& stream);
+
+  // Commits pending writes if commit window elapsed or force is set.
+  void Commit(bool force = false);
+  // Commits all writes and marks stream as complete. A journal destroyed without
+  // closing describes a stream which needs recovery.
+  void Close();
+};
+
+/**
+   * Truncates stream and resource files cut off by a crash to the state described by
+   * the last consistent journal record and rebuilds resource index. Returns true if
+   * the stream needed recovery.
+   */
+bool RecoverJournaledStream(const std::filesystem::path& streamPath);
+
+// Returns true if RecoverJournaledStream would modify the stream, doesn't modify any files.
+bool JournaledStreamNeedsRecovery(const std::filesystem::path& streamPath);
+
+} // namespace gits
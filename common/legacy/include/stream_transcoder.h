@@ -0,0 +1,49 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_transcoder.h
+ *
+ * @brief Offline recompression of recorded streams.
+ *
+ */
+
+#pragma once
+
+#include "configurationLib.h"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace gits {
+
+struct CTranscodeSettings {
+  CompressionType type;
+  uint32_t level;
+  uint64_t chunkSize;
+  unsigned threads; // 0 uses one thread per hardware thread.
+};
+
+/**
+   * @brief Recompresses a recorded stream
+   *
+   * Writes a copy of the stream and its resource files to outputDir, with chunks
+   * recompressed using different settings. Chunks are decompressed and recompressed in
+   * parallel. Each recompressed chunk is decompressed again and its checksum is compared
+   * with the checksum of the original data, so the token payload stays byte-identical.
+   *
+   * Chunk boundaries are tied to the writes done by the recorder, so chunks are never
+   * split. A bigger chunk size merges consecutive small chunks, a smaller one keeps the
+   * chunk size of the stream. Streams recorded without compression can only be copied.
+   * Resource index is rewritten to the new chunk offsets, other files are copied.
+   */
+void TranscodeStream(const std::filesystem::path& streamPath,
+                     const std::filesystem::path& outputDir,
+                     const CTranscodeSettings& settings);
+
+} // namespace gits
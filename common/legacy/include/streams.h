@@ -24,8 +24,12 @@
 #include <deque>
 #include <cstdio>
 #include <filesystem>
+#include <functional>
+#include <memory>
 
 namespace gits {
+class CCompressionPolicy;
+
 template <int Value>
 int identity() {
   return Value;
@@ -72,6 +76,9 @@ enum WriteType : uint8_t {
   PACKAGE,
   LARGE_STANDALONE
 };
+
+// Set in the compressed size of a chunk, or of a part of a large chunk, stored uncompressed.
+const uint64_t ChunkStoredRawFlag = 1ULL << 63;
 class CBinOStream : public std::ostream {
   std::streambuf* _buf;
   CompressionType _compressionType;
@@ -81,10 +88,15 @@ class CBinOStream : public std::ostream {
   bool _initializedCompression;
   uint64_t _chunkSize;
   uint64_t _standaloneMaxSize;
+  uint64_t _bytesWritten;
+  std::unique_ptr<CCompressionPolicy> _policy;
   std::mutex mutex_;
 
 public:
   bool InitializeCompression();
+  uint64_t BytesWritten() const {
+    return _bytesWritten;
+  }
   bool WriteCompressed(const char* data, uint64_t dataSize);
   bool WriteCompressedAndGetOffset(const char* data,
                                    uint64_t dataSize,
@@ -100,6 +112,7 @@ public:
   ~CBinOStream();
 
 private:
+  void WritePart(const char* data, uint64_t size, WriteType writeType);
   void HelperWriteCompressed(const char* dataToWrite, uint64_t size, WriteType writeType);
   void HelperWriteCompressedLarge(const char* dataToWrite, uint64_t size, WriteType writeType);
 };
@@ -147,11 +160,18 @@ class CBinIStream /*: public std::istream*/ {
   bool _initializedCompression;
   uint64_t _chunkSize;
   uint64_t _standaloneMaxSize;
+  uint64_t _bytesRead;
+  std::function<bool(std::vector<char>&)> _chunkSource;
+  bool _chunkSourceExhausted;
+
+  bool ReadFromChunkSource(char* data, uint64_t dataSize);
+  // Reads chunk data stored with compressedSize from the chunk header and decompresses it.
+  void ReadChunkData(uint64_t compressedSize, uint64_t size, char* data);
 
 public:
   bool ReadHelper(char*, size_t);
   bool read(char*, size_t);
-  int tellg() const;
+  uint64_t tellg() const;
   void get_delimited_string(std::string& s, char d);
   bool eof() const;
   int fileseek(FILE* stream, uint64_t offset, int origin);
@@ -173,6 +193,19 @@ public:
   const std::filesystem::path& Path() const {
     return _path;
   }
+  CompressionType GetCompressionType() const {
+    return _compressionType;
+  }
+  // Number of bytes returned by read calls, after decompression.
+  uint64_t BytesRead() const {
+    return _bytesRead;
+  }
+  // Following compressed reads take decompressed chunks from source instead of the file.
+  // Source returns false at the end of the stream. Compression has to be initialized.
+  void SetChunkSource(std::function<bool(std::vector<char>&)> source) {
+    _chunkSource = std::move(source);
+    _chunkSourceExhausted = false;
+  }
 };
 
 template <typename T>
@@ -0,0 +1,106 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   telemetry.h
+ *
+ * @brief Live player and recorder telemetry published in shared memory.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace gits {
+namespace telemetry {
+
+/*
+ * Telemetry block is created in /dev/shm/gits-telemetry-<pid> when the telemetry option is
+ * enabled (Linux only). The publishing process is the only writer, readers map the block
+ * read-only and never take locks. Counters only grow, so a reader computes rates from the
+ * difference of two samples. This header is also used by the telemetry viewer, so it must
+ * not include other GITS headers.
+ */
+constexpr uint32_t TelemetryMagic = 0x53544947; // "GITS"
+constexpr uint32_t TelemetryVersion = 1;
+constexpr uint32_t FrameTimeRingSize = 1024;
+constexpr char TelemetryShmPrefix[] = "gits-telemetry-";
+
+enum TPhase : uint64_t {
+  PHASE_STARTING,
+  PHASE_STATE_RESTORE,
+  PHASE_RUNNING,
+  PHASE_FINISHED
+};
+
+struct TTelemetryData {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t pid;
+  uint32_t isRecorder;
+  char processName[64];
+
+  // Time of the last update, in nanoseconds of CLOCK_MONOTONIC.
+  std::atomic<uint64_t> updateTime;
+  std::atomic<uint64_t> phase;
+  std::atomic<uint64_t> frame;
+  // Tokens played by the player or registered by the recorder.
+  std::atomic<uint64_t> tokens;
+
+  // Token bursts waiting between the stream thread and the API thread. In the player these
+  // are bursts loaded ahead, in the recorder bursts waiting to be written.
+  std::atomic<uint64_t> queueDepth;
+  std::atomic<uint64_t> loaderStalls;
+  std::atomic<uint64_t> loaderStallTime;
+
+  std::atomic<uint64_t> compressionInBytes;
+  std::atomic<uint64_t> compressionOutBytes;
+  std::atomic<uint64_t> compressionTime;
+  std::atomic<uint64_t> decompressionInBytes;
+  std::atomic<uint64_t> decompressionOutBytes;
+  std::atomic<uint64_t> decompressionTime;
+
+  // Writes to protected memory caught by the memory sniffer and bytes copied out of shadow
+  // memory.
+  std::atomic<uint64_t> memoryWriteFaults;
+  std::atomic<uint64_t> shadowFlushBytes;
+
+  // Value of tokens when the state restore started, and its duration once it is finished.
+  std::atomic<uint64_t> stateRestoreTokenBase;
+  std::atomic<uint64_t> stateRestoreBegin;
+  std::atomic<uint64_t> stateRestoreTime;
+
+  // Frame times in nanoseconds. Entry of frame n is frameTimes[n % FrameTimeRingSize], it is
+  // written before frameTimeCount is incremented.
+  std::atomic<uint64_t> frameTimeCount;
+  std::atomic<uint64_t> frameTimes[FrameTimeRingSize];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Telemetry block requires lock-free 64-bit atomics.");
+
+// Returns the telemetry block of this process or nullptr if telemetry is disabled. The first
+// call creates the block.
+TTelemetryData* Data();
+
+void FrameEnd(uint64_t frame);
+void TokensProcessed(uint64_t count);
+void QueueDepth(uint64_t depth);
+void LoaderStall(uint64_t time);
+void Compressed(uint64_t inBytes, uint64_t outBytes, uint64_t time);
+void Decompressed(uint64_t inBytes, uint64_t outBytes, uint64_t time);
+// Async-signal-safe, counts faults only once the block was created with Data().
+void MemoryWriteFault();
+void ShadowFlushed(uint64_t bytes);
+void StateRestoreStarted();
+void StateRestoreFinished();
+
+} // namespace telemetry
+} // namespace gits
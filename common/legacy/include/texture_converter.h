@@ -87,12 +87,16 @@ enum class texel_type {
 const char* get_texel_format_string(texel_type val);
 int get_supported_texels_count();
 
+// By default conversion runs on the calling thread only. Callers converting one image at a time
+// can pass a thread_count to have large images split into bands of rows converted concurrently,
+// 0 means one thread per hardware thread.
 void convert_texture_data(texel_type input_format,
                           const std::vector<uint8_t>& input_data,
                           texel_type output_format,
                           std::vector<uint8_t>& output_data,
                           int width,
-                          int height);
+                          int height,
+                          unsigned thread_count = 1);
 
 void normalize_texture_data(texel_type type, std::vector<uint8_t>& data, int width, int height);
 
@@ -0,0 +1,93 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   token_sequencer.h
+ *
+ * @brief Per-thread buffering of recorded tokens merged in the global recording order.
+ *
+ */
+
+#pragma once
+
+#include "tools_lite.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gits {
+
+class CToken;
+
+/**
+   * @brief Recorded tokens sequencer
+   *
+   * Application threads append tokens to their own buffers, each token tagged with
+   * a global sequence number taken when it is scheduled. A merger thread collects
+   * the buffers and passes the tokens to the consumer in sequence order, so that
+   * scheduler bookkeeping and chunk hand-off do not run on the application threads
+   * and threads of different APIs do not contend on a single lock.
+   */
+class CTokenSequencer : private gits::noncopyable {
+public:
+  typedef std::function<void(CToken*)> TConsumer;
+
+private:
+  typedef std::pair<uint64_t, CToken*> TSequencedToken;
+
+  struct CThreadBuffer {
+    std::mutex mutex;
+    std::vector<TSequencedToken> tokens;
+    // Set when the owning thread exits, the merger drops the buffer once drained.
+    std::atomic<bool> released{false};
+  };
+
+  TConsumer _consumer;
+  const uint64_t _id;
+  std::atomic<uint64_t> _nextSequence;
+  std::atomic<uint64_t> _delivered;
+  // Number of tokens appended to thread buffers, a sequence number is taken before
+  // its token is appended.
+  std::atomic<uint64_t> _appended;
+
+  std::mutex _buffersMutex;
+  // Shared with the owning thread, which may outlive the sequencer.
+  std::vector<std::shared_ptr<CThreadBuffer>> _buffers;
+
+  std::mutex _wakeMutex;
+  std::condition_variable _wake;
+  std::atomic<bool> _mergerWaiting;
+  bool _stop;
+
+  std::mutex _flushMutex;
+  std::condition_variable _flushed;
+
+  std::thread _merger;
+
+  CThreadBuffer& ThreadBuffer();
+  void Merge();
+
+public:
+  explicit CTokenSequencer(TConsumer consumer);
+  ~CTokenSequencer();
+
+  // Takes ownership of the token, it reaches the consumer after all tokens scheduled
+  // before it, from any thread.
+  void Schedule(CToken* token);
+  // Waits until all tokens scheduled so far have reached the consumer.
+  void Flush();
+};
+
+} // namespace gits
@@ -35,6 +35,7 @@
 #include <condition_variable>
 #include <vector>
 #include <functional>
+#include <memory>
 
 #ifdef GITS_PLATFORM_X11
 #include <X11/Xlib.h>
@@ -100,6 +101,43 @@ uint64_t ComputeHash(const void* data,
                      uint32_t partialHashRatio);
 uint64_t ComputeHash(const void* data, size_t size, THashType type);
 
+struct THash128 {
+  uint64_t low;
+  uint64_t high;
+  bool operator==(const THash128& other) const {
+    return low == other.low && high == other.high;
+  }
+  bool operator!=(const THash128& other) const {
+    return !(*this == other);
+  }
+};
+
+// XXH3-128 of data. ComputeHash with THashType::XXH3_128 returns the low half of it.
+// Buffers larger than ParallelHashThreshold are split into ParallelHashChunkSize chunks which are
+// hashed concurrently, the result is the hash of the chunk hashes. It doesn't depend on the number
+// of threads, but differs from a plain XXH3 of the whole buffer.
+THash128 ComputeHash128(const void* data, size_t size);
+
+const size_t ParallelHashChunkSize = 64 * 1024 * 1024;
+const size_t ParallelHashThreshold = 4 * ParallelHashChunkSize;
+
+// Computes XXH3_64 / XXH3_128 hash of data provided in pieces. Digest returns the same value as
+// ComputeHash called with the stream type on the concatenated data, Digest128 of an XXH3_128
+// stream the same value as ComputeHash128.
+class CHashStream : private gits::noncopyable {
+public:
+  explicit CHashStream(THashType type = THashType::XXH3_64);
+  ~CHashStream();
+  void Update(const void* data, size_t size);
+  uint64_t Digest() const;
+  THash128 Digest128() const;
+  void Reset();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> _impl;
+};
+
 std::string CommandOutput(const std::string& command, bool isRecorder);
 
 void fast_exit(int);
@@ -178,6 +216,8 @@ std::string GetWindowsProcessName(int processID);
 std::string GetLinuxProcessName(pid_t processID);
 #endif
 std::string GetLinuxProcessNamePath();
+// Returns peak resident memory of the current process in bytes, 0 if unknown.
+uint64_t GetPeakMemoryUsage();
 
 template <class T>
 int get_product_cost(const T&) {
@@ -237,6 +277,7 @@ public:
     if (cost_capacity_ < 1) {
       cost_capacity_ = 1;
     }
+    max_cost_capacity_ = cost_capacity_;
   }
   ~ProducerConsumer() = default;
   ProducerConsumer(const ProducerConsumer&) = delete;
@@ -269,7 +310,10 @@ public:
       }
     }
 
-    cond_.notify_one();
+    // Producer and consumers wait on the same condition, with more than
+    // one consumer notify_one could wake another consumer instead of the
+    // producer.
+    cond_.notify_all();
     return true;
   }
 
@@ -288,7 +332,7 @@ public:
 
     // We have done our job in this thread. Notify
     // our client that the data is loaded.
-    cond_.notify_one();
+    cond_.notify_all();
 
     // We have accepted the product, but now can't accept anymore.
     // Wait till queue has more room in it. This has to be checked
@@ -301,13 +345,24 @@ public:
     return true;
   }
 
+  // Number of products waiting in the queue.
+  size_t size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return products_.size();
+  }
+
+  // Total cost of products the queue accepts before the producer blocks.
+  size_t capacity() const {
+    return max_cost_capacity_;
+  }
+
   void break_pipe() {
     {
       std::unique_lock<std::mutex> lock(mutex_);
       exhausted_ = true;
     }
 
-    cond_.notify_one();
+    cond_.notify_all();
   }
 
 private:
@@ -316,6 +371,7 @@ private:
   std::deque<Product> products_;
   bool exhausted_;
   int cost_capacity_;
+  int max_cost_capacity_;
 };
 
 template <class WorkUnit>
@@ -345,9 +401,13 @@ public:
   Task& operator=(const Task&) = delete;
   Task(Task&&) = delete;
   Task& operator=(Task&&) = delete;
+  // Starts threadCount threads, each running its own copy of func on the shared queue.
   template <class T>
-  void start(T&& func) {
+  void start(T&& func, unsigned threadCount = 1) {
     assert(thread_.size() == 0);
+    for (unsigned i = 1; i < threadCount; ++i) {
+      thread_.emplace_back(TaskFunction<WorkUnit>(queue_, func));
+    }
     thread_.emplace_back(TaskFunction<WorkUnit>(queue_, std::forward<T>(func)));
   }
   bool running() const {
@@ -472,6 +532,11 @@ public:
   ~ImageWriter() = default;
 };
 
+// Flushes of shadow memory ranges larger than ParallelShadowFlushThreshold in total are split
+// into ParallelShadowFlushChunkSize chunks copied concurrently.
+const size_t ParallelShadowFlushChunkSize = 4 * 1024 * 1024;
+const size_t ParallelShadowFlushThreshold = 4 * ParallelShadowFlushChunkSize;
+
 class ShadowBuffer {
   void* _orig;
   size_t _size;
@@ -498,6 +563,8 @@ public:
     _orig = orig;
   }
   void Flush(size_t offset, size_t size);
+  // Flushes a list of {offset, size} ranges.
+  void Flush(const std::vector<std::pair<size_t, size_t>>& ranges);
   void UpdateShadow(size_t offset, size_t size);
   void UpdateShadowFromSource(void* ptr, size_t offset, size_t size);
 };
@@ -505,7 +572,9 @@ public:
 std::pair<const void*, size_t> GetSubrangeOverlappingMemoryPages(
     std::pair<const void*, size_t> range, const std::set<const void*>& pages);
 std::vector<std::pair<uint64_t, uint64_t>> GetIntervalSetFromMemoryPages(
-    std::pair<const void*, size_t> range, const std::set<const void*>& pages);
+    std::pair<const void*, size_t> range,
+    const std::set<const void*>& pages,
+    uint64_t maxGap = 0);
 std::vector<std::pair<const uint8_t*, const uint8_t*>> GetChangedMemorySubranges(
     const void* oldData, const void* newRangeData, uint64_t length, size_t stepSize);
 void GetMemoryDiffSubRange(const void* oldData,
@@ -562,11 +631,15 @@ public:
                               const uint64_t expectedUncompressedSize,
                               char* uncompressedData) = 0;
   virtual uint64_t MaxCompressedSize(const uint64_t dataSize) = 0;
+  // Changes level (1 - fastest, 10 - slowest) of following Compress calls.
+  virtual void SetLevel(uint32_t level) = 0;
 };
 
 class LZ4StreamCompressor : public StreamCompressor {
 public:
-  LZ4StreamCompressor() {}
+  LZ4StreamCompressor()
+      : LZ4StreamCompressor(Configurator::Get().common.recorder.compression.level) {}
+  explicit LZ4StreamCompressor(uint32_t level) : level_(level) {}
   virtual uint64_t Compress(const char* uncompressedData,
                             const uint64_t uncompressedDataSize,
                             std::vector<char>* compressedData) override;
@@ -575,10 +648,12 @@ public:
                               const uint64_t expectedUncompressedSize,
                               char* uncompressedData) override;
   virtual uint64_t MaxCompressedSize(const uint64_t dataSize) override;
+  virtual void SetLevel(uint32_t level) override;
 
 private:
   LZ4_stream_t ctx;
   std::mutex mutex_;
+  uint32_t level_;
   const std::map<int, int> perfModes{
       {1, 50}, {2, 35}, {3, 15}, {4, 10}, {5, 6},
       {6, 5},  {7, 4},  {8, 3},  {9, 2},  {10, 1}}; // 1 - fastest, 10 - slowest
@@ -586,7 +661,9 @@ private:
 
 class ZSTDStreamCompressor : public StreamCompressor {
 public:
-  ZSTDStreamCompressor();
+  ZSTDStreamCompressor()
+      : ZSTDStreamCompressor(Configurator::Get().common.recorder.compression.level) {}
+  explicit ZSTDStreamCompressor(uint32_t level);
   ~ZSTDStreamCompressor();
   ZSTDStreamCompressor(const ZSTDStreamCompressor& other) = delete;
   ZSTDStreamCompressor& operator=(const ZSTDStreamCompressor& other) = delete;
@@ -599,10 +676,12 @@ public:
                               const uint64_t expectedUncompressedSize,
                               char* uncompressedData) override;
   virtual uint64_t MaxCompressedSize(const uint64_t dataSize) override;
+  virtual void SetLevel(uint32_t level) override;
 
 private:
   ZSTD_CCtx* ZSTDContext;
   std::mutex mutex_;
+  uint32_t level_;
   const std::map<int, int> perfModes{
       {1, -7}, {2, -5}, {3, -3}, {4, -1}, {5, 1},
       {6, 3},  {7, 5},  {8, 7},  {9, 9},  {10, 11}}; // 1 - fastest, 10 - slowest
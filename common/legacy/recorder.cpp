@@ -375,6 +375,10 @@ gits::CScheduler& gits::CRecorder::Scheduler() const {
     throw ENotInitialized(EXCEPTION_MESSAGE);
   }
 
+  // Tokens scheduled so far have to reach the scheduler before it is used directly.
+  if (_sequencer) {
+    _sequencer->Flush();
+  }
   return *_sc.scheduler;
 }
 
@@ -458,6 +462,11 @@ void gits::CRecorder::Register(std::unique_ptr<CBehavior> behavior) {
 #else
     _sc.scheduler.reset(new CScheduler(rec.tokenBurst, rec.tokenBurstNum));
 #endif
+    // High integrity mode needs tokens written before the API call returns.
+    if (rec.perThreadTokenBuffers && !rec.highIntegrity) {
+      _sequencer = std::make_unique<CTokenSequencer>(
+          [this](CToken* token) { _sc.scheduler->Register(token); });
+    }
   }
 
 #if defined GITS_PLATFORM_WINDOWS
@@ -487,6 +496,14 @@ void gits::CRecorder::Register(std::unique_ptr<CBehavior> behavior) {
     }
 
     Scheduler().Stream(_sc.oBinStream.get());
+    const auto journalPath = outputpath / StreamJournalFileName;
+    if (rec.highIntegrity && !rec.nullIO) {
+      Scheduler().Journal(std::make_unique<CStreamJournal>(journalPath, *_sc.oBinStream));
+    } else {
+      // Journal left by an earlier recording would describe some other stream.
+      std::error_code ec;
+      std::filesystem::remove(journalPath, ec);
+    }
     (*_sc.oBinStream) << CGits::Instance();
   }
 }
@@ -677,6 +694,8 @@ void gits::CRecorder::FrameEnd() {
         sleep_millisec(api3dIface.CfgRec_EndFrameSleep());
       }
 
+      telemetry::FrameEnd(inst.CurrentFrame());
+
       //frame end time stamp
       if (Configurator::Get().common.recorder.benchmark) {
         inst.TimeSheet().add_frame_time("stamp", inst.Timers().program.Get());
@@ -834,7 +853,11 @@ bool gits::CRecorder::Schedule(CToken* token, bool force /* = false */) {
   bool scheduled = false;
 
   if (!Behavior().CaptureFinished() || force) {
-    Scheduler().Register(token);
+    if (_sequencer) {
+      _sequencer->Schedule(token);
+    } else {
+      Scheduler().Register(token);
+    }
     scheduled = true;
   }
 
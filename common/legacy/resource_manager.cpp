@@ -99,6 +99,8 @@ CResourceManager2::CResourceManager2(
     : dirty_(false),
       index_filename_(gits::get(filename_mapping, RESOURCE_INDEX)),
       filenames_map_(filename_mapping),
+      pendingSize_(0),
+      loadedSize_(0),
       fakeHash_(0) {
   if (std::filesystem::exists(index_filename_)) {
     typedef std::unordered_map<uint64_t, TResourceHandle2> map64_t;
@@ -196,14 +198,28 @@ hash_t CResourceManager2::put(
   // Remember where data was put.
   index_[hash] = resource;
 
+  // Index entries reach the disk through the stream journal, complete index is written
+  // when the manager is destroyed.
   if (Configurator::Get().common.recorder.highIntegrity) {
-    append_map(index_filename_, hash, resource);
-    dirty_ = false;
+    pending_.emplace_back(hash, resource);
+    pendingSize_ += size;
   }
 
   return hash;
 }
 
+void CResourceManager2::flush_pending(std::vector<std::pair<hash_t, TResourceHandle2>>& entries,
+                                      std::map<uint32_t, uint64_t>& fileSizes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& writer : _fileWriter) {
+    writer.second->flush();
+    fileSizes[writer.first] = static_cast<uint64_t>(writer.second->tellp());
+  }
+  entries.insert(entries.end(), pending_.begin(), pending_.end());
+  pending_.clear();
+  pendingSize_ = 0;
+}
+
 std::vector<char> CResourceManager2::get(hash_t hash) {
   if (hash == EmptyHash) {
     return std::vector<char>();
@@ -216,6 +232,7 @@ std::vector<char> CResourceManager2::get(hash_t hash) {
     _fileReader[r.file_id]->InitializeCompression();
   }
   _data.resize(r.size);
+  loadedSize_ += r.size;
   _fileReader[r.file_id]->ReadWithOffset(_data.data(), r.size, r.offsetToStart,
                                          r.offsetInsideChunk);
   return std::move(_data);
@@ -13,6 +13,7 @@
  *
  */
 #include "scheduler.h"
+#include "compression_policy.h"
 #include "gits.h"
 #include "library.h"
 #include "function.h"
@@ -21,9 +22,12 @@
 #include "exception.h"
 #include "log.h"
 #include "pragmas.h"
+#include "telemetry.h"
 
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
+#include <numeric>
 
 //#define GITS_DEBUG_TOKEN_SIZE
 #ifdef GITS_DEBUG_TOKEN_SIZE
@@ -123,6 +127,7 @@ public:
         if (!queue.produce(tokenList)) {
           break;
         }
+        telemetry::QueueDepth(queue.size());
 
         if (stopLoading) {
           queue.break_pipe();
@@ -179,6 +184,8 @@ public:
       CScheduler::CTokenList tokenList;
 
       while (sync.consume(tokenList)) {
+        telemetry::QueueDepth(sync.size());
+        CCompressionPolicy::WriterQueueDepth(sync.size(), sync.capacity(), true);
         consume_tokens(tokenList, _sched);
       }
     } catch (std::exception& e) {
@@ -209,7 +216,11 @@ CScheduler::CScheduler(unsigned tokenLimit, unsigned tokenBurstNum)
       _tokenLimit(tokenLimit),
       _streamExhausted(false),
       _oBinStream(nullptr),
-      _iBinStream(nullptr) {
+      _iBinStream(nullptr),
+      _nextLoopToken(_loopTokens.end()),
+      _loopFrames(0),
+      _loopIteration(0),
+      _loopDone(false) {
   CGits::Instance().Timers().loading.Pause();
 }
 
@@ -217,6 +228,7 @@ CScheduler::~CScheduler() {
   try {
     // Delete any tokens owned by scheduler.
     Purge(_tokenList);
+    Purge(_loopTokens);
 
     // Wait for the shredder to dispose of any outstanding tokens.
     _tokenShredder.finish();
@@ -253,6 +265,36 @@ CScheduler::~CScheduler() {
  * @param function Function call wrapper to register.
  */
 void CScheduler::Register(CToken* token) {
+  // This mutex is necessary, because each recorded api (GL/CL/rs)
+  // has its own api-mutex and thus don't serialize access to scheduler
+  // for multi api applications. Tokens are also registered by the token
+  // sequencer thread, while recorder may register state restore tokens
+  // directly, so the whole token list update has to be guarded.
+  std::unique_lock<std::mutex> lock(_tokenRegisterMutex);
+  RegisterLocked(token);
+  telemetry::TokensProcessed(1);
+}
+
+void CScheduler::RegisterBatch(CScheduler& batch) {
+  std::unique_lock<std::mutex> lock(_tokenRegisterMutex);
+  // Tokens were already counted when they were registered to the batch.
+  for (auto token : batch._tokenList) {
+    RegisterLocked(token);
+  }
+  batch._tokenList.clear();
+}
+
+void CScheduler::WriteBatch(CBinOStream& stream, bool keep) {
+  std::unique_lock<std::mutex> lock(_tokenRegisterMutex);
+  for (auto token : _tokenList) {
+    token->Serialize(stream);
+  }
+  if (!keep) {
+    Purge(_tokenList);
+  }
+}
+
+void CScheduler::RegisterLocked(CToken* token) {
 #if defined GITS_PLATFORM_WINDOWS
   static bool isDirectX =
       (CGits::Instance().GetApi3D() == ApisIface::TApi::DirectX); // Static variable for the check
@@ -265,11 +307,6 @@ void CScheduler::Register(CToken* token) {
     WriteChunk();
   }
 
-  // This mutex is necessary, because each recorded api (GL/CL/rs)
-  // has its own api-mutex and thus don't serialize access to scheduler
-  // for multi api applications. Proper solution would require sharing
-  // single api-mutex among all recorded apis interceptors.
-  std::unique_lock<std::mutex> lock(_tokenRegisterMutex);
   _tokenList.push_back(token);
 #if defined GITS_PLATFORM_WINDOWS
   _currentChunkSize += token->Size();
@@ -279,6 +316,9 @@ void CScheduler::Register(CToken* token) {
 #if defined GITS_PLATFORM_WINDOWS
     _currentChunkSize = 0;
 #endif
+    if (_journal) {
+      _journal->Commit();
+    }
   }
 }
 
@@ -300,7 +340,14 @@ bool CScheduler::LoadChunk() {
     });
   }
   _tokenShredder.queue().produce(_tokenList);
+  // Playback waits for the loader when no burst is loaded ahead.
+  const bool stall = _streamLoader.queue().size() == 0;
+  Timer stallTimer;
   bool produced = _streamLoader.queue().consume(_tokenList);
+  if (stall) {
+    telemetry::LoaderStall(stallTimer.Get());
+  }
+  telemetry::QueueDepth(_streamLoader.queue().size());
   _nextToPlay = _tokenList.begin();
 
   // Skip first interval measured as the stream is not yet
@@ -323,14 +370,21 @@ void CScheduler::WriteChunk(bool purgeTokens) {
     }
 
     _streamWriter.queue().produce(_tokenList);
+    telemetry::QueueDepth(_streamWriter.queue().size());
+    CCompressionPolicy::WriterQueueDepth(_streamWriter.queue().size(),
+                                         _streamWriter.queue().capacity(), false);
   }
 }
 
 void CScheduler::WriteAll() {
+  std::unique_lock<std::mutex> lock(_tokenRegisterMutex);
   WriteChunk();
 #if defined GITS_PLATFORM_WINDOWS
   _currentChunkSize = 0;
 #endif
+  if (_journal) {
+    _journal->Close();
+  }
 }
 
 void CScheduler::Stream(CBinIStream* stream) {
@@ -338,8 +392,21 @@ void CScheduler::Stream(CBinIStream* stream) {
 }
 
 CToken* CScheduler::Token() {
+  if (!_loopTokens.empty()) {
+    return LoopToken();
+  }
+
   if (_nextToPlay != _tokenList.end()) {
     CToken* result = *_nextToPlay;
+    if (!_loopDone && result->Id() == CToken::ID_FRAME_START) {
+      const auto& frameLoop = Configurator::Get().common.player.frameLoop;
+      if (frameLoop.count == 0) {
+        _loopDone = true;
+      } else if (CGits::Instance().CurrentFrame() == frameLoop.begin) {
+        PrepareFrameLoop();
+        return Token();
+      }
+    }
     ++_nextToPlay;
     return result;
   }
@@ -351,12 +418,91 @@ CToken* CScheduler::Token() {
 
   return nullptr;
 }
+
+/**
+ * @brief Loads frames played in a loop
+ *
+ * Tokens of the frame range are taken over from the loaded bursts, so their
+ * arguments and resources are deserialized once and not released by the token
+ * shredder between iterations.
+ */
+void CScheduler::PrepareFrameLoop() {
+  const auto& frameLoop = Configurator::Get().common.player.frameLoop;
+  _loopDone = true;
+  if (frameLoop.end < frameLoop.begin) {
+    LOG_WARNING << "Frame loop end is lower than its begin, frame loop disabled.";
+    return;
+  }
+  if (CGits::Instance().apis.HasCompute()) {
+    // Compute APIs free host copies of token data once the driver executed them, the
+    // tokens could not be played again.
+    LOG_WARNING << "Frame loop is not supported for compute APIs, frame loop disabled.";
+    return;
+  }
+
+  LOG_INFO << "Loading frames " << frameLoop.begin << "-" << frameLoop.end << " for the loop ...";
+  CGits::Instance().Timers().loading.Resume();
+  unsigned frames = frameLoop.end - frameLoop.begin + 1;
+  while (frames > 0) {
+    if (_nextToPlay == _tokenList.end()) {
+      if (_streamExhausted) {
+        break;
+      }
+      _streamExhausted = LoadChunk();
+      CGits::Instance().Timers().loading.Resume();
+      continue;
+    }
+    CToken* token = *_nextToPlay;
+    *_nextToPlay = nullptr;
+    ++_nextToPlay;
+    _loopTokens.push_back(token);
+    if (token->Id() == CToken::ID_FRAME_END) {
+      --frames;
+    }
+  }
+  CGits::Instance().Timers().loading.Pause();
+
+  _loopFrames = frameLoop.end - frameLoop.begin + 1 - frames;
+  if (frames > 0) {
+    LOG_WARNING << "Stream ends before the end of frame loop, looping " << _loopFrames
+                << " frames.";
+  }
+  _loopIteration = 0;
+  _nextLoopToken = _loopTokens.begin();
+  _loopTimer.Restart();
+}
+
+CToken* CScheduler::LoopToken() {
+  if (_nextLoopToken == _loopTokens.end()) {
+    const int64_t time = _loopTimer.Get();
+    _loopTimeSheet.add_frame_time("time", time);
+    _loopTimeSheet.add_frame_data("fps", _loopFrames * 1e9 / std::max<int64_t>(time, 1));
+    ++_loopIteration;
+
+    if (_loopIteration == Configurator::Get().common.player.frameLoop.count) {
+      const auto& times = _loopTimeSheet.row_times("time");
+      const auto [fastest, slowest] = std::minmax_element(times.begin(), times.end());
+      const double average =
+          std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size());
+      LOG_INFO << "Frame loop played " << _loopIteration << " times, iteration time min "
+               << *fastest / 1e6 << "ms, avg " << average / 1e6 << "ms, max " << *slowest / 1e6
+               << "ms.";
+      Purge(_loopTokens);
+      return Token();
+    }
+    _nextLoopToken = _loopTokens.begin();
+    _loopTimer.Restart();
+  }
+  return *_nextLoopToken++;
+}
+
 bool CScheduler::Run(CAction& action) {
   auto& runner = CGits::Instance().Runner();
 
   while (auto result = Token()) {
     // run token
     runner(action, *result);
+    telemetry::TokensProcessed(1);
     // Give control to GITS framework on frame begin.
     const unsigned id = result->Id();
     if (id == CToken::ID_FRAME_END || id == CToken::ID_INIT_END) {
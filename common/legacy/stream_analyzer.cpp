@@ -0,0 +1,202 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_analyzer.cpp
+ *
+ * @brief Offline analysis of the size and content of recorded streams.
+ *
+ */
+
+#include "stream_analyzer.h"
+#include "stream_chunks.h"
+#include "streams.h"
+#include "function.h"
+#include "exception.h"
+#include "gits.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace gits {
+
+namespace {
+struct TFunctionCost {
+  std::string name;
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  uint64_t resourceBytes = 0;
+};
+
+struct TFrameCost {
+  uint64_t tokens = 0;
+  uint64_t bytes = 0;
+  uint64_t resourceBytes = 0;
+};
+
+const char* const writeTypeNames[] = {"STANDALONE", "PACKAGE", "LARGE_STANDALONE"};
+
+std::string TokenName(const CToken& token) {
+  if (token.Id() >= CToken::ID_OPENGL) {
+    return static_cast<const CFunction&>(token).Name();
+  }
+  return TryToDemangle(typeid(token).name()).name;
+}
+
+double Megabytes(uint64_t bytes) {
+  return bytes / (1024.0 * 1024.0);
+}
+} // namespace
+
+void AnalyzeStream(CBinIStream& stream, const CAnalyzeSettings& settings) {
+  const auto begin = std::chrono::steady_clock::now();
+
+  std::unique_ptr<CChunkDecoder> decoder;
+  if (!stream_older_than(GITS_TOKEN_COMPRESSION)) {
+    stream.InitializeCompression();
+    if (stream.GetCompressionType() != CompressionType::NONE) {
+      decoder = std::make_unique<CChunkDecoder>(stream.Path(), stream.tellg(),
+                                                stream.GetCompressionType(), settings.threads);
+      stream.SetChunkSource([&](std::vector<char>& data) { return decoder->Next(data); });
+    }
+  }
+
+  auto tokenCtor = [](CId id) -> CToken* { return CGits::Instance().TokenCreate(id); };
+  auto& resourceManager = CGits::Instance().ResourceManager2();
+  std::map<unsigned, TFunctionCost> functions;
+  std::vector<TFrameCost> frames(1);
+  uint64_t tokens = 0;
+  for (;;) {
+    const uint64_t bytesBefore = stream.BytesRead();
+    const uint64_t resourceBytesBefore = resourceManager.loaded_size();
+    std::unique_ptr<CToken> token(CToken::Deserialize(stream, tokenCtor));
+    if (!token) {
+      break;
+    }
+    const uint64_t bytes = stream.BytesRead() - bytesBefore;
+    const uint64_t resourceBytes = resourceManager.loaded_size() - resourceBytesBefore;
+    tokens++;
+
+    auto& function = functions[token->Id()];
+    if (function.count == 0) {
+      function.name = TokenName(*token);
+    }
+    function.count++;
+    function.bytes += bytes;
+    function.resourceBytes += resourceBytes;
+
+    auto& frame = frames.back();
+    frame.tokens++;
+    frame.bytes += bytes;
+    frame.resourceBytes += resourceBytes;
+    if (token->Id() == CToken::ID_FRAME_END) {
+      frames.emplace_back();
+    }
+  }
+  if (decoder) {
+    stream.SetChunkSource(nullptr);
+  }
+  if (frames.back().tokens == 0) {
+    frames.pop_back();
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  // Most expensive functions first.
+  std::vector<std::pair<unsigned, const TFunctionCost*>> sorted;
+  for (const auto& function : functions) {
+    sorted.emplace_back(function.first, &function.second);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second->bytes + a.second->resourceBytes > b.second->bytes + b.second->resourceBytes;
+  });
+
+  std::cout << "Analyzed " << tokens << " tokens in " << frames.size() << " frames in "
+            << seconds << " s." << std::endl;
+  std::cout << std::endl << "Functions:" << std::endl;
+  std::cout << std::left << std::setw(48) << "Name" << std::right << std::setw(8) << "Id"
+            << std::setw(12) << "Calls" << std::setw(14) << "Bytes" << std::setw(16)
+            << "Resource bytes" << std::endl;
+  for (const auto& [id, function] : sorted) {
+    std::cout << std::left << std::setw(48) << function->name << std::right << std::setw(8) << id
+              << std::setw(12) << function->count << std::setw(14) << function->bytes
+              << std::setw(16) << function->resourceBytes << std::endl;
+  }
+
+  if (!frames.empty()) {
+    const auto heaviest =
+        std::max_element(frames.begin(), frames.end(), [](const auto& a, const auto& b) {
+          return a.bytes + a.resourceBytes < b.bytes + b.resourceBytes;
+        });
+    const auto busiest =
+        std::max_element(frames.begin(), frames.end(),
+                         [](const auto& a, const auto& b) { return a.tokens < b.tokens; });
+    std::cout << std::endl
+              << "Frames: " << frames.size() << ", average " << tokens / frames.size()
+              << " tokens, most tokens in frame " << busiest - frames.begin() + 1 << " ("
+              << busiest->tokens << "), most data in frame " << heaviest - frames.begin() + 1
+              << " (" << Megabytes(heaviest->bytes + heaviest->resourceBytes) << " MB)."
+              << std::endl;
+  }
+
+  if (decoder) {
+    std::cout << std::endl << "Chunks:" << std::endl;
+    for (auto type : {WriteType::PACKAGE, WriteType::STANDALONE, WriteType::LARGE_STANDALONE}) {
+      const auto& stats = decoder->Stats(type);
+      std::cout << std::left << std::setw(18) << writeTypeNames[type] << std::right
+                << std::setw(10) << stats.count << " chunks " << std::setw(12) << std::fixed
+                << std::setprecision(2) << Megabytes(stats.size) << " MB, ratio "
+                << (stats.compressedSize ? (double)stats.size / stats.compressedSize : 0.0)
+                << std::defaultfloat << std::endl;
+    }
+  }
+
+  if (settings.jsonPath.empty()) {
+    return;
+  }
+  nlohmann::ordered_json report;
+  report["tokens"] = tokens;
+  for (const auto& [id, function] : sorted) {
+    report["functions"].push_back({{"id", id},
+                                   {"name", function->name},
+                                   {"calls", function->count},
+                                   {"bytes", function->bytes},
+                                   {"resourceBytes", function->resourceBytes}});
+  }
+  report["frames"] = nlohmann::ordered_json::array();
+  for (const auto& frame : frames) {
+    report["frames"].push_back({{"tokens", frame.tokens},
+                                {"bytes", frame.bytes},
+                                {"resourceBytes", frame.resourceBytes}});
+  }
+  if (decoder) {
+    for (auto type : {WriteType::PACKAGE, WriteType::STANDALONE, WriteType::LARGE_STANDALONE}) {
+      const auto& stats = decoder->Stats(type);
+      report["chunks"][writeTypeNames[type]] = {{"count", stats.count},
+                                                {"bytes", stats.size},
+                                                {"compressedBytes", stats.compressedSize}};
+    }
+  }
+  std::ofstream json(settings.jsonPath);
+  json << report.dump(2) << std::endl;
+  if (!json) {
+    throw std::runtime_error("Failed to write " + settings.jsonPath.string());
+  }
+  LOG_INFO << "Stream analysis written to " << settings.jsonPath;
+}
+
+} // namespace gits
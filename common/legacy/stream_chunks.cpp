@@ -0,0 +1,280 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_chunks.cpp
+ *
+ * @brief Reading and parallel decompression of compressed stream chunks.
+ *
+ */
+
+#include "stream_chunks.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace gits {
+
+namespace {
+template <class T>
+bool ReadValue(CBinIStream& in, T& value) {
+  return in.ReadHelper(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+template <class T>
+void ReadRequired(CBinIStream& in, T& value) {
+  if (!ReadValue(in, value)) {
+    throw std::runtime_error("Unexpected end of file " + in.Path().string());
+  }
+}
+
+void ReadPart(CBinIStream& in, uint64_t remaining, CChunkPart& part) {
+  uint64_t compressedSize = 0;
+  ReadRequired(in, compressedSize);
+  part.raw = (compressedSize & ChunkStoredRawFlag) != 0;
+  compressedSize &= ~ChunkStoredRawFlag;
+  if (compressedSize == 0 || compressedSize > remaining ||
+      (part.raw && compressedSize != part.size)) {
+    throw std::runtime_error("Corrupted chunk in " + in.Path().string());
+  }
+  part.data.resize(compressedSize);
+  if (!in.ReadHelper(part.data.data(), compressedSize)) {
+    throw std::runtime_error("Unexpected end of file " + in.Path().string());
+  }
+}
+} // namespace
+
+std::unique_ptr<StreamCompressor> CreateStreamCompressor(CompressionType type, uint32_t level) {
+  if (type == CompressionType::LZ4) {
+    return std::make_unique<LZ4StreamCompressor>(level);
+  } else if (type == CompressionType::ZSTD) {
+    return std::make_unique<ZSTDStreamCompressor>(level);
+  }
+  throw std::runtime_error("Unsupported compression type.");
+}
+
+bool ReadStreamChunk(CBinIStream& in, uint64_t fileSize, CStreamChunk& chunk) {
+  chunk.offset = in.tellg();
+  chunk.parts.clear();
+  if (chunk.offset >= fileSize || !ReadValue(in, chunk.size)) {
+    return false;
+  }
+  ReadRequired(in, chunk.type);
+  const uint64_t remaining = fileSize - chunk.offset;
+  if (chunk.type == WriteType::LARGE_STANDALONE) {
+    uint64_t partsNumber = 0;
+    ReadRequired(in, partsNumber);
+    if (partsNumber > chunk.size) {
+      throw std::runtime_error("Corrupted chunk in " + in.Path().string());
+    }
+    chunk.parts.resize(partsNumber);
+    uint64_t total = 0;
+    for (auto& part : chunk.parts) {
+      ReadRequired(in, part.size);
+      ReadPart(in, remaining, part);
+      total += part.size;
+    }
+    if (total != chunk.size) {
+      throw std::runtime_error("Corrupted chunk in " + in.Path().string());
+    }
+  } else if (chunk.type == WriteType::PACKAGE || chunk.type == WriteType::STANDALONE) {
+    chunk.parts.resize(1);
+    chunk.parts[0].size = chunk.size;
+    ReadPart(in, remaining, chunk.parts[0]);
+  } else {
+    throw std::runtime_error("Unknown chunk type in " + in.Path().string());
+  }
+  return true;
+}
+
+std::vector<CStreamChunk> ReadStreamChunks(CBinIStream& in) {
+  const uint64_t fileSize = std::filesystem::file_size(in.Path());
+  std::vector<CStreamChunk> chunks;
+  CStreamChunk chunk;
+  while (ReadStreamChunk(in, fileSize, chunk)) {
+    chunks.push_back(std::move(chunk));
+  }
+  return chunks;
+}
+
+void DecompressStreamPart(StreamCompressor& decompressor, const CChunkPart& part, char* data) {
+  if (part.raw) {
+    std::copy(part.data.begin(), part.data.end(), data);
+    return;
+  }
+  const auto size = decompressor.Decompress(part.data, part.data.size(), part.size, data);
+  if (size != part.size) {
+    throw std::runtime_error("Decompressed chunk size does not match its header.");
+  }
+}
+
+void DecompressStreamChunk(StreamCompressor& decompressor,
+                           const CStreamChunk& chunk,
+                           std::vector<char>& data) {
+  data.resize(chunk.size);
+  uint64_t offset = 0;
+  for (const auto& part : chunk.parts) {
+    DecompressStreamPart(decompressor, part, data.data() + offset);
+    offset += part.size;
+  }
+}
+
+CChunkDecoder::CChunkDecoder(const std::filesystem::path& path,
+                             uint64_t offset,
+                             CompressionType type,
+                             unsigned threads,
+                             unsigned window)
+    : _in(std::make_unique<CBinIStream>(path)),
+      _fileSize(std::filesystem::file_size(path)),
+      _type(type),
+      _readerDone(false),
+      _stop(false) {
+  if (_in->fileseek(nullptr, offset, SEEK_SET) != 0) {
+    throw std::runtime_error("Failed to seek the specified position in the file.");
+  }
+  Start(threads, window);
+}
+
+CChunkDecoder::CChunkDecoder(std::vector<CStreamChunk> chunks,
+                             CompressionType type,
+                             unsigned threads,
+                             unsigned window)
+    : _fileSize(0), _chunks(std::move(chunks)), _type(type), _readerDone(false), _stop(false) {
+  Start(threads, window);
+}
+
+void CChunkDecoder::Start(unsigned threads, unsigned window) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  _window = window != 0 ? window : threads * 4;
+  for (unsigned i = 0; i < threads; ++i) {
+    _workers.emplace_back(&CChunkDecoder::Work, this);
+  }
+  _reader = std::thread(&CChunkDecoder::Read, this);
+}
+
+CChunkDecoder::~CChunkDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _queued.notify_all();
+  _consumed.notify_all();
+  _reader.join();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+bool CChunkDecoder::ReadNext(CJob& job, size_t& index) {
+  if (_in) {
+    job.source = &job.chunk;
+    return ReadStreamChunk(*_in, _fileSize, job.chunk);
+  }
+  if (index == _chunks.size()) {
+    return false;
+  }
+  job.source = &_chunks[index++];
+  return true;
+}
+
+void CChunkDecoder::Read() {
+  try {
+    size_t index = 0;
+    for (;;) {
+      auto job = std::make_shared<CJob>();
+      if (!ReadNext(*job, index)) {
+        break;
+      }
+      std::unique_lock<std::mutex> lock(_mutex);
+      // Keep the amount of chunks in memory bounded.
+      _consumed.wait(lock, [&] { return _stop || _ordered.size() < _window; });
+      if (_stop) {
+        break;
+      }
+      _jobs.push_back(job);
+      _ordered.push_back(std::move(job));
+      lock.unlock();
+      _queued.notify_one();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _readerError = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _readerDone = true;
+  }
+  _queued.notify_all();
+  _finished.notify_all();
+}
+
+void CChunkDecoder::Work() {
+  // Compressors keep their contexts, so each worker has its own.
+  std::unique_ptr<StreamCompressor> decompressor;
+  for (;;) {
+    std::shared_ptr<CJob> job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _queued.wait(lock, [&] { return _stop || _readerDone || !_jobs.empty(); });
+      if (_stop || _jobs.empty()) {
+        return;
+      }
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+    }
+    try {
+      if (!decompressor) {
+        decompressor = CreateStreamCompressor(_type, 1);
+      }
+      DecompressStreamChunk(*decompressor, *job->source, job->data);
+    } catch (...) {
+      job->error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      job->done = true;
+    }
+    _finished.notify_all();
+  }
+}
+
+bool CChunkDecoder::Next(std::vector<char>& data) {
+  std::shared_ptr<CJob> job;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [&] {
+      return _ordered.empty() ? _readerDone : _ordered.front()->done;
+    });
+    if (_ordered.empty()) {
+      if (_readerError) {
+        std::rethrow_exception(_readerError);
+      }
+      return false;
+    }
+    job = std::move(_ordered.front());
+    _ordered.pop_front();
+  }
+  _consumed.notify_one();
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+
+  auto& stats = _stats[job->source->type];
+  stats.count++;
+  stats.size += job->source->size;
+  for (const auto& part : job->source->parts) {
+    stats.compressedSize += part.data.size();
+  }
+  data.swap(job->data);
+  return true;
+}
+
+} // namespace gits
@@ -0,0 +1,294 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_journal.cpp
+ *
+ * @brief Journal making streams recorded in high integrity mode recoverable after a crash.
+ *
+ */
+
+#include "stream_journal.h"
+#include "streams.h"
+#include "resource_manager.h"
+#include "key_value.h"
+#include "exception.h"
+#include "gits.h"
+#include "log.h"
+
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gits {
+
+const char* const StreamJournalFileName = "gitsJournal.dat";
+
+namespace {
+// Record layout: header followed by payload of payloadSize bytes. The checksum is
+// an XXH3 hash of the payload.
+const uint32_t journalRecordMagic = 0x4e524a47; // "GJRN"
+const uint32_t journalRecordClosed = 1U;
+
+struct JournalRecordHeader {
+  uint32_t magic;
+  uint32_t flags;
+  uint64_t payloadSize;
+  uint64_t checksum;
+};
+
+struct JournalRecord {
+  uint32_t flags = 0;
+  uint64_t sequence = 0;
+  uint64_t streamSize = 0;
+  std::map<uint32_t, uint64_t> fileSizes;
+  std::vector<std::pair<hash_t, TResourceHandle2>> entries;
+};
+
+template <class T>
+void Append(std::vector<char>& buffer, const T& value) {
+  const char* data = reinterpret_cast<const char*>(&value);
+  buffer.insert(buffer.end(), data, data + sizeof(value));
+}
+
+template <class T>
+bool Extract(const std::vector<char>& buffer, size_t& offset, T& value) {
+  if (buffer.size() - offset < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, buffer.data() + offset, sizeof(value));
+  offset += sizeof(value);
+  return true;
+}
+
+std::vector<char> EncodeRecord(const JournalRecord& record) {
+  std::vector<char> payload;
+  Append(payload, record.sequence);
+  Append(payload, record.streamSize);
+  Append(payload, static_cast<uint32_t>(record.fileSizes.size()));
+  for (const auto& fileSize : record.fileSizes) {
+    Append(payload, fileSize.first);
+    Append(payload, fileSize.second);
+  }
+  Append(payload, static_cast<uint64_t>(record.entries.size()));
+  for (const auto& entry : record.entries) {
+    Append(payload, entry.first);
+    Append(payload, entry.second.offsetToStart);
+    Append(payload, entry.second.offsetInsideChunk);
+    Append(payload, entry.second.file_id);
+    Append(payload, entry.second.size);
+  }
+
+  JournalRecordHeader header = {journalRecordMagic, record.flags, payload.size(),
+                                ComputeHash(payload.data(), payload.size(), THashType::XXH3_64)};
+  std::vector<char> data;
+  data.reserve(sizeof(header) + payload.size());
+  Append(data, header);
+  data.insert(data.end(), payload.begin(), payload.end());
+  return data;
+}
+
+bool DecodePayload(const std::vector<char>& payload, JournalRecord& record) {
+  size_t offset = 0;
+  uint32_t fileCount = 0;
+  if (!Extract(payload, offset, record.sequence) || !Extract(payload, offset, record.streamSize) ||
+      !Extract(payload, offset, fileCount)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < fileCount; ++i) {
+    uint32_t fileId = 0;
+    uint64_t size = 0;
+    if (!Extract(payload, offset, fileId) || !Extract(payload, offset, size)) {
+      return false;
+    }
+    record.fileSizes[fileId] = size;
+  }
+  uint64_t entryCount = 0;
+  if (!Extract(payload, offset, entryCount)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < entryCount; ++i) {
+    hash_t hash = 0;
+    TResourceHandle2 handle = {};
+    if (!Extract(payload, offset, hash) || !Extract(payload, offset, handle.offsetToStart) ||
+        !Extract(payload, offset, handle.offsetInsideChunk) ||
+        !Extract(payload, offset, handle.file_id) || !Extract(payload, offset, handle.size)) {
+      return false;
+    }
+    record.entries.emplace_back(hash, handle);
+  }
+  return offset == payload.size();
+}
+
+// Reads next record, returns false if the journal ends or the record is damaged.
+bool ReadRecord(std::ifstream& file, uint64_t remaining, JournalRecord& record) {
+  JournalRecordHeader header = {};
+  if (remaining < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  if (header.magic != journalRecordMagic || header.payloadSize > remaining - sizeof(header)) {
+    return false;
+  }
+  std::vector<char> payload(static_cast<size_t>(header.payloadSize));
+  if (!file.read(payload.data(), payload.size()) ||
+      ComputeHash(payload.data(), payload.size(), THashType::XXH3_64) != header.checksum) {
+    return false;
+  }
+  record.flags = header.flags;
+  return DecodePayload(payload, record);
+}
+
+void TruncateFile(const std::filesystem::path& path, uint64_t size) {
+  if (std::filesystem::exists(path) && std::filesystem::file_size(path) > size) {
+    LOG_INFO << "Truncating " << path << " to " << size << " bytes.";
+    std::filesystem::resize_file(path, size);
+  }
+}
+} // namespace
+
+CStreamJournal::CStreamJournal(const std::filesystem::path& fileName, CBinOStream& stream)
+    : _file(fileName, std::ios::binary | std::ios::trunc | std::ios::out),
+      _stream(stream),
+      _commitInterval(Configurator::Get().common.recorder.highIntegrityCommitInterval),
+      _commitSize(Configurator::Get().common.recorder.highIntegrityCommitSize),
+      _lastCommit(std::chrono::steady_clock::now()),
+      _committedStreamSize(0),
+      _sequence(0),
+      _closed(false) {
+  if (!_file.is_open()) {
+    CheckMinimumAvailableDiskSize();
+    throw std::runtime_error("couldn't create file: " + fileName.string());
+  }
+}
+
+void CStreamJournal::Commit(bool force) {
+  if (_closed) {
+    return;
+  }
+  const uint64_t pending = _stream.BytesWritten() - _committedStreamSize +
+                           CGits::Instance().ResourceManager2().pending_size();
+  const auto now = std::chrono::steady_clock::now();
+  if (!force && pending < _commitSize && now - _lastCommit < _commitInterval) {
+    return;
+  }
+  _lastCommit = now;
+  if (pending > 0 || force) {
+    WriteRecord(false);
+  }
+}
+
+void CStreamJournal::Close() {
+  if (!_closed) {
+    WriteRecord(true);
+    _closed = true;
+  }
+}
+
+void CStreamJournal::WriteRecord(bool closing) {
+  JournalRecord record;
+  record.flags = closing ? journalRecordClosed : 0U;
+  record.sequence = _sequence++;
+
+  // Data has to reach the files before the record describing it.
+  CGits::Instance().ResourceManager2().flush_pending(record.entries, record.fileSizes);
+  _stream.flush();
+  record.streamSize = static_cast<uint64_t>(_stream.tellp());
+  _committedStreamSize = _stream.BytesWritten();
+
+  const auto data = EncodeRecord(record);
+  _file.write(data.data(), data.size());
+  _file.flush();
+  if (!_file) {
+    throw std::runtime_error("Failed to write stream journal record.");
+  }
+}
+
+namespace {
+bool RecoverStream(const std::filesystem::path& streamPath, bool modify) {
+  const auto streamDir = streamPath.parent_path();
+  const auto journalPath = streamDir / StreamJournalFileName;
+  if (!std::filesystem::exists(journalPath)) {
+    return false;
+  }
+
+  // Find the last consistent record, index entries of all consistent records make up
+  // the resource index.
+  const uint64_t journalSize = std::filesystem::file_size(journalPath);
+  std::ifstream journal(journalPath, std::ios::binary);
+  std::unordered_map<hash_t, TResourceHandle2> index;
+  JournalRecord last;
+  uint64_t consistentSize = 0;
+  uint64_t sequence = 0;
+  for (;;) {
+    JournalRecord record;
+    if (!ReadRecord(journal, journalSize - consistentSize, record) ||
+        record.sequence != sequence) {
+      break;
+    }
+    for (const auto& entry : record.entries) {
+      index[entry.first] = entry.second;
+    }
+    consistentSize = static_cast<uint64_t>(journal.tellg());
+    last = std::move(record);
+    ++sequence;
+  }
+  journal.close();
+
+  if (sequence == 0) {
+    LOG_WARNING << "Stream journal " << journalPath << " has no consistent records.";
+    return false;
+  }
+  const auto filenames = resource_filenames(streamDir);
+  const auto& indexPath = gits::get(filenames, RESOURCE_INDEX);
+  if (last.flags & journalRecordClosed) {
+    // Process may still have been killed before writing the complete index.
+    if (index.empty() || std::filesystem::exists(indexPath)) {
+      return false;
+    }
+    if (!modify) {
+      return true;
+    }
+    LOG_WARNING << "Resource index of a closed stream is missing, rebuilding it from journal.";
+    write_map(indexPath, index);
+    return true;
+  }
+
+  if (!modify) {
+    return true;
+  }
+  LOG_WARNING << "Stream was not closed properly, recovering it to the state from "
+              << sequence << " journal commits.";
+  TruncateFile(streamPath, last.streamSize);
+  for (const auto& fileSize : last.fileSizes) {
+    TruncateFile(gits::get(filenames, fileSize.first), fileSize.second);
+  }
+  write_map(indexPath, index);
+
+  // Mark the journal as closed, so that the recovery is not repeated.
+  std::filesystem::resize_file(journalPath, consistentSize);
+  last.flags = journalRecordClosed;
+  last.sequence = sequence;
+  last.entries.clear();
+  const auto data = EncodeRecord(last);
+  std::ofstream file(journalPath, std::ios::binary | std::ios::app);
+  file.write(data.data(), data.size());
+  return true;
+}
+} // namespace
+
+bool RecoverJournaledStream(const std::filesystem::path& streamPath) {
+  return RecoverStream(streamPath, true);
+}
+
+bool JournaledStreamNeedsRecovery(const std::filesystem::path& streamPath) {
+  return RecoverStream(streamPath, false);
+}
+
+} // namespace gits
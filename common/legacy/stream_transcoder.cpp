@@ -0,0 +1,536 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   stream_transcoder.cpp
+ *
+ * @brief Offline recompression of recorded streams.
+ *
+ */
+
+#include "stream_transcoder.h"
+#include "stream_chunks.h"
+#include "stream_journal.h"
+#include "streams.h"
+#include "resource_manager.h"
+#include "key_value.h"
+#include "version.h"
+#include "gits.h"
+#include "tools.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gits {
+
+namespace {
+const uint64_t copyBlockSize = 8 * 1024 * 1024;
+
+// Consecutive source chunks written as a single output chunk.
+struct CTranscodeJob {
+  CompressionType sourceType;
+  WriteType type;
+  std::vector<CStreamChunk> chunks;
+  std::vector<CChunkPart> output;
+  bool done = false;
+  std::exception_ptr error;
+};
+
+// Where a source chunk landed in the output file, shift is its offset inside the
+// output chunk it was merged into.
+struct CChunkLocation {
+  uint64_t offset;
+  uint64_t shift;
+};
+typedef std::unordered_map<uint64_t, CChunkLocation> TChunkMap;
+
+template <class T>
+bool ReadValue(CBinIStream& in, T& value) {
+  return in.ReadHelper(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+template <class T>
+void ReadRequired(CBinIStream& in, T& value) {
+  if (!ReadValue(in, value)) {
+    throw std::runtime_error("Unexpected end of file " + in.Path().string());
+  }
+}
+
+class COutputFile {
+  std::filesystem::path _path;
+  std::vector<char> _buffer;
+  std::ofstream _file;
+  uint64_t _size;
+
+public:
+  explicit COutputFile(const std::filesystem::path& path)
+      : _path(path), _buffer(copyBlockSize), _size(0) {
+    _file.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
+    _file.open(path, std::ios::binary | std::ios::trunc | std::ios::out);
+    if (!_file.is_open()) {
+      CheckMinimumAvailableDiskSize();
+      throw std::runtime_error("couldn't create file: " + path.string());
+    }
+  }
+  void Write(const char* data, uint64_t size) {
+    _file.write(data, size);
+    if (!_file) {
+      throw std::runtime_error("Failed to write " + _path.string());
+    }
+    _size += size;
+  }
+  template <class T>
+  void WriteValue(const T& value) {
+    Write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  uint64_t Size() const {
+    return _size;
+  }
+};
+
+class CStreamTranscoder : private gits::noncopyable {
+  typedef std::unique_ptr<StreamCompressor> TDecompressors[3];
+
+  const CTranscodeSettings& _settings;
+  unsigned _threadCount;
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::condition_variable _finished;
+  std::deque<std::shared_ptr<CTranscodeJob>> _jobs;
+  bool _stop;
+  std::vector<std::thread> _workers;
+  uint64_t _bytesRead;
+  uint64_t _bytesWritten;
+
+  void Work();
+  void Process(CTranscodeJob& job, TDecompressors& decompressors, StreamCompressor* compressor);
+  void Submit(std::deque<std::shared_ptr<CTranscodeJob>>& window,
+              std::shared_ptr<CTranscodeJob>& job,
+              COutputFile& out,
+              TChunkMap* chunkMap);
+  void WriteJob(CTranscodeJob& job, COutputFile& out, TChunkMap* chunkMap);
+
+public:
+  explicit CStreamTranscoder(const CTranscodeSettings& settings);
+  ~CStreamTranscoder();
+  // Returns false if the file was copied without changes.
+  bool TranscodeFile(CBinIStream& in,
+                     const std::vector<char>& header,
+                     const std::filesystem::path& outPath,
+                     TChunkMap* chunkMap);
+  uint64_t BytesRead() const {
+    return _bytesRead;
+  }
+  uint64_t BytesWritten() const {
+    return _bytesWritten;
+  }
+};
+
+CStreamTranscoder::CStreamTranscoder(const CTranscodeSettings& settings)
+    : _settings(settings),
+      _threadCount(settings.threads),
+      _stop(false),
+      _bytesRead(0),
+      _bytesWritten(0) {
+  if (_threadCount == 0) {
+    _threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  for (unsigned i = 0; i < _threadCount; ++i) {
+    _workers.emplace_back(&CStreamTranscoder::Work, this);
+  }
+}
+
+CStreamTranscoder::~CStreamTranscoder() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _queued.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+void CStreamTranscoder::Work() {
+  // Compressors keep their contexts, so each worker has its own.
+  TDecompressors decompressors;
+  std::unique_ptr<StreamCompressor> compressor;
+  for (;;) {
+    std::shared_ptr<CTranscodeJob> job;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _queued.wait(lock, [&] { return _stop || !_jobs.empty(); });
+      if (_jobs.empty()) {
+        return;
+      }
+      job = std::move(_jobs.front());
+      _jobs.pop_front();
+    }
+    try {
+      if (!compressor && _settings.type != CompressionType::NONE) {
+        compressor = CreateStreamCompressor(_settings.type, _settings.level);
+      }
+      Process(*job, decompressors, compressor.get());
+    } catch (...) {
+      job->error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      job->done = true;
+    }
+    _finished.notify_all();
+  }
+}
+
+void CStreamTranscoder::Process(CTranscodeJob& job,
+                                TDecompressors& decompressors,
+                                StreamCompressor* compressor) {
+  auto& decompressor = decompressors[static_cast<size_t>(job.sourceType)];
+  if (!decompressor) {
+    decompressor = CreateStreamCompressor(job.sourceType, 1);
+  }
+
+  // Large chunks keep their parts, merged chunks become a single part.
+  std::vector<std::vector<char>> segments;
+  if (job.type == WriteType::LARGE_STANDALONE) {
+    for (const auto& part : job.chunks[0].parts) {
+      segments.emplace_back(part.size);
+    }
+  } else {
+    uint64_t size = 0;
+    for (const auto& chunk : job.chunks) {
+      size += chunk.size;
+    }
+    segments.emplace_back(size);
+  }
+
+  size_t segment = 0;
+  uint64_t offset = 0;
+  for (auto& chunk : job.chunks) {
+    for (auto& part : chunk.parts) {
+      DecompressStreamPart(*decompressor, part, segments[segment].data() + offset);
+      std::vector<char>().swap(part.data);
+      if (job.type == WriteType::LARGE_STANDALONE) {
+        ++segment;
+      } else {
+        offset += part.size;
+      }
+    }
+  }
+
+  job.output.resize(segments.size());
+  for (size_t i = 0; i < segments.size(); ++i) {
+    auto& output = job.output[i];
+    output.size = segments[i].size();
+    if (compressor == nullptr) {
+      output.data = std::move(segments[i]);
+      continue;
+    }
+
+    const auto checksum = ComputeHash(segments[i].data(), segments[i].size(), THashType::XXH3_64);
+    const auto compressedSize =
+        compressor->Compress(segments[i].data(), segments[i].size(), &output.data);
+    output.data.resize(compressedSize);
+
+    // Decompress the result again to prove that the payload did not change.
+    std::vector<char> check(output.size);
+    const auto checkSize =
+        compressor->Decompress(output.data, output.data.size(), output.size, check.data());
+    if (checkSize != output.size ||
+        ComputeHash(check.data(), check.size(), THashType::XXH3_64) != checksum) {
+      throw std::runtime_error("Checksum of recompressed chunk does not match the source.");
+    }
+  }
+}
+
+void CStreamTranscoder::WriteJob(CTranscodeJob& job, COutputFile& out, TChunkMap* chunkMap) {
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [&] { return job.done; });
+  }
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+
+  const bool compressed = _settings.type != CompressionType::NONE;
+  if (chunkMap != nullptr) {
+    // Uncompressed files are addressed by data offsets.
+    const uint64_t chunkOffset = out.Size();
+    uint64_t shift = 0;
+    for (const auto& chunk : job.chunks) {
+      if (compressed) {
+        (*chunkMap)[chunk.offset] = {chunkOffset, shift};
+      } else {
+        (*chunkMap)[chunk.offset] = {chunkOffset + shift, 0};
+      }
+      shift += chunk.size;
+    }
+  }
+
+  if (compressed) {
+    uint64_t size = 0;
+    for (const auto& part : job.output) {
+      size += part.size;
+    }
+    out.WriteValue(size);
+    out.WriteValue(job.type);
+    if (job.type == WriteType::LARGE_STANDALONE) {
+      out.WriteValue(static_cast<uint64_t>(job.output.size()));
+    }
+    for (const auto& part : job.output) {
+      if (job.type == WriteType::LARGE_STANDALONE) {
+        out.WriteValue(part.size);
+      }
+      out.WriteValue(static_cast<uint64_t>(part.data.size()));
+      out.Write(part.data.data(), part.data.size());
+    }
+  } else {
+    for (const auto& part : job.output) {
+      out.Write(part.data.data(), part.data.size());
+    }
+  }
+  job.output.clear();
+}
+
+void CStreamTranscoder::Submit(std::deque<std::shared_ptr<CTranscodeJob>>& window,
+                               std::shared_ptr<CTranscodeJob>& job,
+                               COutputFile& out,
+                               TChunkMap* chunkMap) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.push_back(job);
+  }
+  _queued.notify_one();
+  window.push_back(std::move(job));
+
+  // Keep the amount of chunks in memory bounded, output is written in source order.
+  while (window.size() > _threadCount * 4) {
+    WriteJob(*window.front(), out, chunkMap);
+    window.pop_front();
+  }
+}
+
+bool CStreamTranscoder::TranscodeFile(CBinIStream& in,
+                                      const std::vector<char>& header,
+                                      const std::filesystem::path& outPath,
+                                      TChunkMap* chunkMap) {
+  const uint64_t fileSize = std::filesystem::file_size(in.Path());
+  COutputFile out(outPath);
+  out.Write(header.data(), header.size());
+
+  CompressionType sourceType = CompressionType::NONE;
+  uint64_t sourceChunkSize = 0;
+  ReadRequired(in, sourceType);
+  ReadRequired(in, sourceChunkSize);
+
+  if (sourceType == CompressionType::NONE) {
+    // Boundaries of the recorded writes are not known, so chunks can't be created.
+    if (_settings.type != CompressionType::NONE) {
+      throw std::runtime_error(in.Path().string() +
+                               " was recorded without compression, it can't be compressed.");
+    }
+    out.WriteValue(sourceType);
+    out.WriteValue(sourceChunkSize);
+    std::vector<char> block(copyBlockSize);
+    for (uint64_t remaining = fileSize - in.tellg(); remaining > 0;) {
+      const uint64_t size = std::min<uint64_t>(remaining, block.size());
+      if (!in.ReadHelper(block.data(), size)) {
+        throw std::runtime_error("Unexpected end of file " + in.Path().string());
+      }
+      out.Write(block.data(), size);
+      remaining -= size;
+    }
+    _bytesRead += fileSize;
+    _bytesWritten += out.Size();
+    return false;
+  }
+
+  // Reader may see a read crossing at most two merged chunks only if chunks are never
+  // split, so the chunk size can only grow.
+  uint64_t chunkSize = 0;
+  if (_settings.type != CompressionType::NONE) {
+    chunkSize = _settings.chunkSize;
+    if (chunkSize < sourceChunkSize) {
+      LOG_WARNING << "Chunks of " << in.Path() << " can't be split, keeping chunk size of "
+                  << sourceChunkSize << " bytes.";
+      chunkSize = sourceChunkSize;
+    }
+  }
+  out.WriteValue(_settings.type);
+  out.WriteValue(chunkSize);
+
+  std::deque<std::shared_ptr<CTranscodeJob>> window;
+  std::shared_ptr<CTranscodeJob> group;
+  uint64_t groupSize = 0;
+  CStreamChunk chunk;
+  while (ReadStreamChunk(in, fileSize, chunk)) {
+    const bool mergeable = chunk.type == WriteType::PACKAGE &&
+                           (_settings.type == CompressionType::NONE || chunk.size < chunkSize);
+    if (group && (!mergeable || groupSize + chunk.size >= std::max(chunkSize, sourceChunkSize))) {
+      Submit(window, group, out, chunkMap);
+      group.reset();
+    }
+    if (!group) {
+      group = std::make_shared<CTranscodeJob>();
+      group->sourceType = sourceType;
+      group->type = chunk.type;
+      groupSize = 0;
+    }
+    groupSize += chunk.size;
+    group->chunks.push_back(std::move(chunk));
+    if (!mergeable) {
+      Submit(window, group, out, chunkMap);
+      group.reset();
+    }
+  }
+  if (group) {
+    Submit(window, group, out, chunkMap);
+  }
+  for (auto& job : window) {
+    WriteJob(*job, out, chunkMap);
+  }
+
+  _bytesRead += fileSize;
+  _bytesWritten += out.Size();
+  return true;
+}
+
+// Returns the header of the main stream preceding its compressed part.
+std::vector<char> ReadStreamHeader(CBinIStream& in) {
+  CVersion version;
+  in >> version;
+  if (version.version() < GITS_TOKEN_COMPRESSION) {
+    throw std::runtime_error("Stream recorded with " + std::to_string(version.version()) +
+                             " predates compressed streams, it can't be transcoded.");
+  }
+
+  uint32_t skipNum = 0;
+  ReadRequired(in, skipNum);
+  for (uint32_t i = 0; i < skipNum; ++i) {
+    uint32_t value = 0;
+    ReadRequired(in, value);
+    ReadRequired(in, value);
+  }
+  uint32_t propsLength = 0;
+  ReadRequired(in, propsLength);
+  if (propsLength > 0) {
+    std::vector<char> props(propsLength);
+    if (!in.ReadHelper(props.data(), props.size())) {
+      throw std::runtime_error("Unexpected end of file " + in.Path().string());
+    }
+  }
+  if (version.version() >= GITS_API_INFO) {
+    ApisIface::TApi api = ApisIface::TApi::ApiNotSet;
+    ReadRequired(in, api);
+    ReadRequired(in, api);
+    SchedulerVersion schedulerVersion = SchedulerVersion::VERSION_1_0;
+    ReadRequired(in, schedulerVersion);
+  }
+
+  // Header is copied as it is.
+  std::vector<char> header(in.tellg());
+  std::ifstream file(in.Path(), std::ios::binary);
+  if (!file.read(header.data(), header.size())) {
+    throw std::runtime_error("Unexpected end of file " + in.Path().string());
+  }
+  return header;
+}
+} // namespace
+
+void TranscodeStream(const std::filesystem::path& streamPath,
+                     const std::filesystem::path& outputDir,
+                     const CTranscodeSettings& settings) {
+  const auto sourceDir = std::filesystem::absolute(streamPath).parent_path();
+  if (std::filesystem::exists(outputDir) && std::filesystem::equivalent(sourceDir, outputDir)) {
+    throw std::runtime_error("Transcoded stream has to be written to a different directory.");
+  }
+  std::filesystem::create_directories(outputDir);
+
+  const auto begin = std::chrono::steady_clock::now();
+  CStreamTranscoder transcoder(settings);
+  {
+    CBinIStream in(streamPath);
+    const auto header = ReadStreamHeader(in);
+    transcoder.TranscodeFile(in, header, outputDir / streamPath.filename(), nullptr);
+  }
+
+  // Resources are addressed by chunk offsets, the index has to follow the new layout.
+  const auto sourceFiles = resource_filenames(sourceDir);
+  const auto outputFiles = resource_filenames(outputDir);
+  std::unordered_map<uint32_t, TChunkMap> chunkMaps;
+  for (const auto& file : sourceFiles) {
+    if (file.first == RESOURCE_INDEX || !std::filesystem::exists(file.second)) {
+      continue;
+    }
+    CBinIStream in(file.second);
+    TChunkMap chunkMap;
+    if (transcoder.TranscodeFile(in, {}, gits::get(outputFiles, file.first), &chunkMap)) {
+      chunkMaps[file.first] = std::move(chunkMap);
+    }
+  }
+
+  const auto& sourceIndex = gits::get(sourceFiles, RESOURCE_INDEX);
+  if (std::filesystem::exists(sourceIndex)) {
+    auto index = read_map<std::unordered_map<hash_t, TResourceHandle2>>(sourceIndex);
+    for (auto& entry : index) {
+      auto& handle = entry.second;
+      const auto chunkMap = chunkMaps.find(handle.file_id);
+      if (chunkMap == chunkMaps.end()) {
+        continue;
+      }
+      const auto location = chunkMap->second.find(handle.offsetToStart);
+      if (location == chunkMap->second.end()) {
+        throw std::runtime_error("Resource index does not match the resource files.");
+      }
+      if (settings.type == CompressionType::NONE) {
+        handle.offsetToStart = location->second.offset + handle.offsetInsideChunk;
+        handle.offsetInsideChunk = 0;
+      } else {
+        handle.offsetToStart = location->second.offset;
+        handle.offsetInsideChunk += location->second.shift;
+      }
+    }
+    write_map(gits::get(outputFiles, RESOURCE_INDEX), index);
+  }
+
+  // Remaining files of the stream are copied, the journal does not apply to the new files.
+  std::set<std::filesystem::path> transcoded = {streamPath.filename(), StreamJournalFileName};
+  for (const auto& file : sourceFiles) {
+    transcoded.insert(file.second.filename());
+  }
+  for (const auto& entry : std::filesystem::directory_iterator(sourceDir)) {
+    if (transcoded.count(entry.path().filename()) == 0) {
+      std::filesystem::copy(entry.path(), outputDir / entry.path().filename(),
+                            std::filesystem::copy_options::recursive |
+                                std::filesystem::copy_options::overwrite_existing);
+    }
+  }
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  const double megabytes = transcoder.BytesRead() / (1024.0 * 1024.0);
+  LOG_INFO << "Transcoded " << megabytes << " MB to "
+           << transcoder.BytesWritten() / (1024.0 * 1024.0) << " MB in " << seconds << " s ("
+           << (seconds > 0 ? megabytes / seconds : 0) << " MB/s).";
+}
+
+} // namespace gits
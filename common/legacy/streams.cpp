@@ -14,10 +14,13 @@
  */
 
 #include "streams.h"
+#include "compression_policy.h"
+#include "direct_file_buf.h"
 #include "tools.h"
 #include "exception.h"
 #include "gits.h"
 #include "log.h"
+#include "telemetry.h"
 
 #include <memory>
 #include <stdexcept>
@@ -31,6 +34,15 @@ std::streambuf* initialize_gits_streambuf(const std::filesystem::path& fileName,
     LOG_ERROR << "Expected stream file path, got a directory.";
     throw gits::EOperationFailed(EXCEPTION_MESSAGE);
   }
+#ifdef GITS_PLATFORM_LINUX
+  if (gits::Configurator::Get().common.recorder.directIO && (mode & std::ios::out)) {
+    std::streambuf* directBuf = gits::CDirectFileBuf::Open(fileName);
+    if (directBuf != nullptr) {
+      return directBuf;
+    }
+    LOG_WARNING << "Direct I/O is not supported for " << fileName << ", using buffered writes.";
+  }
+#endif
   std::filebuf* fileBuf = new std::filebuf;
   bool opened = fileBuf->open(fileName, mode);
   if (!opened) {
@@ -79,15 +91,56 @@ void HelperCopy(const char* dataToCopy,
   offset += dataToCopySize;
 }
 
+static uint64_t CompressChunk(const char* data,
+                              uint64_t size,
+                              std::vector<char>* compressedData) {
+  Timer timer;
+  uint64_t compressedSize =
+      gits::CGits::Instance().GitsStreamCompressor().Compress(data, size, compressedData);
+  gits::telemetry::Compressed(size, compressedSize, timer.Get());
+  return compressedSize;
+}
+
+static void DecompressChunk(const std::vector<char>& compressedData,
+                            uint64_t compressedSize,
+                            uint64_t size,
+                            char* data) {
+  Timer timer;
+  gits::CGits::Instance().GitsStreamCompressor().Decompress(compressedData, compressedSize, size,
+                                                            data);
+  gits::telemetry::Decompressed(compressedSize, size, timer.Get());
+}
+
+void gits::CBinOStream::WritePart(const char* data, uint64_t size, WriteType writeType) {
+  bool compress = !_policy || _policy->ShouldCompress(writeType);
+  uint64_t outputSize = 0;
+  if (compress) {
+    Timer timer;
+    outputSize = CompressChunk(data, size, &_compressedDataToStore);
+    if (_policy) {
+      compress = _policy->Compressed(writeType, size, outputSize, timer.Get());
+    }
+  } else {
+    _policy->StoredRaw(writeType, size);
+  }
+
+  if (compress) {
+    WriteToOstream(reinterpret_cast<char*>(&outputSize), sizeof(outputSize));
+    WriteToOstream(_compressedDataToStore.data(), outputSize);
+  } else {
+    // Incompressible data is stored as is, so that reading it doesn't cost decompression.
+    outputSize = size | ChunkStoredRawFlag;
+    WriteToOstream(reinterpret_cast<char*>(&outputSize), sizeof(outputSize));
+    WriteToOstream(data, size);
+  }
+}
+
 void gits::CBinOStream::HelperWriteCompressed(const char* dataToWrite,
                                               uint64_t size,
                                               WriteType writeType) {
   WriteToOstream(reinterpret_cast<char*>(&size), sizeof(size));
   WriteToOstream(reinterpret_cast<char*>(&writeType), sizeof(writeType));
-  uint64_t outputSize =
-      CGits::Instance().GitsStreamCompressor().Compress(dataToWrite, size, &_compressedDataToStore);
-  WriteToOstream(reinterpret_cast<char*>(&outputSize), sizeof(outputSize));
-  WriteToOstream(_compressedDataToStore.data(), outputSize);
+  WritePart(dataToWrite, size, writeType);
 }
 
 void gits::CBinOStream::HelperWriteCompressedLarge(const char* dataToWrite,
@@ -104,13 +157,10 @@ void gits::CBinOStream::HelperWriteCompressedLarge(const char* dataToWrite,
   // Iterate over each chunk, compress, and write it to the stream
   for (uint64_t i = 0; i < size; i += _standaloneMaxSize) {
     uint64_t currentChunkSize = std::min(_standaloneMaxSize, size - i);
-    uint64_t compressedSize = CGits::Instance().GitsStreamCompressor().Compress(
-        dataToWrite + i, currentChunkSize, &_compressedDataToStore);
 
     // Write the current chunk size and its compressed size before the actual compressed data
     WriteToOstream(reinterpret_cast<char*>(&currentChunkSize), sizeof(currentChunkSize));
-    WriteToOstream(reinterpret_cast<char*>(&compressedSize), sizeof(compressedSize));
-    WriteToOstream(_compressedDataToStore.data(), compressedSize);
+    WritePart(dataToWrite + i, currentChunkSize, writeType);
   }
 }
 
@@ -212,11 +262,8 @@ bool gits::CBinOStream::WriteCompressedAndGetOffset(const char* data,
 
 std::ostream& gits::CBinOStream::WriteToOstream(const char* data, uint64_t dataSize) {
   try {
-    auto& stream = std::ostream::write(data, dataSize);
-    if (Configurator::Get().common.recorder.highIntegrity) {
-      return std::ostream::flush();
-    }
-    return stream;
+    _bytesWritten += dataSize;
+    return std::ostream::write(data, dataSize);
   } catch (std::ostream::failure& e) {
     LOG_ERROR << "Failed to write to the stream. Probably not enough space on the disk.";
     LOG_ERROR << "Err code: " << e.code() << " Err msg: " << e.what();
@@ -235,7 +282,8 @@ gits::CBinOStream::CBinOStream(const std::filesystem::path& fileName)
       _offset(0),
       _initializedCompression(false),
       _chunkSize(0),
-      _standaloneMaxSize(268435456) {
+      _standaloneMaxSize(268435456),
+      _bytesWritten(0) {
   CheckMinimumAvailableDiskSize();
   std::ios::openmode mode = std::ios::binary | std::ios::trunc | std::ios::out;
   _buf = initialize_gits_streambuf(fileName, mode);
@@ -243,6 +291,9 @@ gits::CBinOStream::CBinOStream(const std::filesystem::path& fileName)
   exceptions(std::ostream::badbit | std::ostream::failbit);
   if (_compressionType != CompressionType::NONE) {
     _chunkSize = Configurator::Get().common.recorder.compression.chunkSize;
+    if (Configurator::Get().common.recorder.compression.adaptive) {
+      _policy = std::make_unique<CCompressionPolicy>(fileName.filename().string());
+    }
   }
 }
 
@@ -275,7 +326,9 @@ gits::CBinIStream::CBinIStream(const std::filesystem::path& fileName)
       _compressionType(CompressionType::NONE),
       _initializedCompression(false),
       _chunkSize(0),
-      _standaloneMaxSize(268435456) {
+      _standaloneMaxSize(268435456),
+      _bytesRead(0),
+      _chunkSourceExhausted(false) {
   _file = fopen(fileName.string().c_str(), "rb"
 #ifdef GITS_PLATFORM_WINDOWS
                                            "S"
@@ -319,6 +372,24 @@ bool gits::CBinIStream::LoadChunk() {
   if (eof()) {
     return false;
   }
+  if (writeType == WriteType::PACKAGE) {
+    _size = size;
+    _offset = 0;
+    ReadChunkData(compressedSize, _size, _decompressedData.data());
+    return true;
+  } else {
+    throw std::runtime_error(EXCEPTION_MESSAGE);
+  }
+}
+
+void gits::CBinIStream::ReadChunkData(uint64_t compressedSize, uint64_t size, char* data) {
+  if (compressedSize & ChunkStoredRawFlag) {
+    if ((compressedSize & ~ChunkStoredRawFlag) != size) {
+      throw std::runtime_error(EXCEPTION_MESSAGE);
+    }
+    ReadHelper(data, size);
+    return;
+  }
   if (compressedSize > _compressedData.max_size()) {
     throw std::runtime_error(EXCEPTION_MESSAGE);
   }
@@ -326,19 +397,34 @@ bool gits::CBinIStream::LoadChunk() {
     _compressedData.resize(compressedSize);
   }
   ReadHelper(_compressedData.data(), compressedSize);
-  if (writeType == WriteType::PACKAGE) {
-    _size = size;
-    _offset = 0;
-    CGits::Instance().GitsStreamCompressor().Decompress(_compressedData, compressedSize, _size,
-                                                        _decompressedData.data());
-    return true;
-  } else {
-    throw std::runtime_error(EXCEPTION_MESSAGE);
+  DecompressChunk(_compressedData, compressedSize, size, data);
+}
+
+bool gits::CBinIStream::ReadFromChunkSource(char* data, uint64_t dataSize) {
+  while (dataSize > 0) {
+    if (_offset >= _size) {
+      if (_chunkSourceExhausted || !_chunkSource(_decompressedData)) {
+        _chunkSourceExhausted = true;
+        return false;
+      }
+      _offset = 0;
+      _size = _decompressedData.size();
+      continue;
+    }
+    const uint64_t size = std::min(dataSize, _size - _offset);
+    memcpy(data, _decompressedData.data() + _offset, size);
+    _offset += size;
+    data += size;
+    dataSize -= size;
   }
+  return true;
 }
 
 bool gits::CBinIStream::ReadCompressed(char* data, uint64_t dataSize) {
   InitializeCompression();
+  if (_chunkSource) {
+    return ReadFromChunkSource(data, dataSize);
+  }
   uint64_t internalOffset = 0;
   if (_compressionType == CompressionType::NONE) {
     ReadHelper(data, dataSize);
@@ -381,17 +467,13 @@ bool gits::CBinIStream::ReadCompressed(char* data, uint64_t dataSize) {
         ReadHelper(reinterpret_cast<char*>(&currentCompressedChunkSize),
                    sizeof(currentCompressedChunkSize));
 
-        if (currentCompressedChunkSize > _compressedData.size()) {
+        if ((currentCompressedChunkSize & ~ChunkStoredRawFlag) > _compressedData.size()) {
           throw std::runtime_error(EXCEPTION_MESSAGE);
         }
 
-        // Read the compressed data for the current chunk
-        ReadHelper(_compressedData.data(), currentCompressedChunkSize);
-
-        // Decompress the current chunk
-        CGits::Instance().GitsStreamCompressor().Decompress(
-            _compressedData, currentCompressedChunkSize, currentChunkSize,
-            (char*)data + i * _standaloneMaxSize);
+        // Read and decompress the current chunk
+        ReadChunkData(currentCompressedChunkSize, currentChunkSize,
+                      (char*)data + i * _standaloneMaxSize);
       }
 
       // Reset offset and size after processing all chunks
@@ -403,24 +485,15 @@ bool gits::CBinIStream::ReadCompressed(char* data, uint64_t dataSize) {
       if (eof()) {
         return false;
       }
-      if (compressedSize > _compressedData.max_size()) {
-        throw std::runtime_error(EXCEPTION_MESSAGE);
-      }
-      if (compressedSize > _compressedData.size()) {
-        _compressedData.resize(compressedSize);
-      }
-      ReadHelper(_compressedData.data(), compressedSize);
       if (writeType == WriteType::PACKAGE) {
         _size = size;
         _offset = 0;
-        CGits::Instance().GitsStreamCompressor().Decompress(_compressedData, compressedSize, _size,
-                                                            _decompressedData.data());
+        ReadChunkData(compressedSize, _size, _decompressedData.data());
 
         memcpy((char*)data + internalOffset, _decompressedData.data() + _offset, dataSize);
         _offset += dataSize;
       } else {
-        CGits::Instance().GitsStreamCompressor().Decompress(_compressedData, compressedSize, size,
-                                                            data);
+        ReadChunkData(compressedSize, size, data);
         _offset = 0;
         _size = 0;
       }
@@ -462,6 +535,7 @@ bool gits::CBinIStream::ReadHelper(char* buf, size_t size) {
 }
 
 bool gits::CBinIStream::read(char* buf, size_t size) {
+  _bytesRead += size;
   if (stream_older_than(GITS_TOKEN_COMPRESSION)) {
     return ReadHelper(buf, size);
   } else {
@@ -469,11 +543,16 @@ bool gits::CBinIStream::read(char* buf, size_t size) {
   }
 }
 
-int gits::CBinIStream::tellg() const {
-  return ftell(_file);
+uint64_t gits::CBinIStream::tellg() const {
+#ifdef GITS_PLATFORM_WINDOWS
+  return _ftelli64(_file);
+#else
+  return ftello64(_file);
+#endif
 }
 
 int gits::CBinIStream::getc() {
+  ++_bytesRead;
   if (stream_older_than(GITS_TOKEN_COMPRESSION)) {
     return fgetc(_file);
   } else {
@@ -503,6 +582,9 @@ void gits::CBinIStream::get_delimited_string(std::string& s, char t) {
 }
 
 bool gits::CBinIStream::eof() const {
+  if (_chunkSource) {
+    return _chunkSourceExhausted;
+  }
   return feof(_file);
 }
 
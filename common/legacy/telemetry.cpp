@@ -0,0 +1,220 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   telemetry.cpp
+ *
+ * @brief Live player and recorder telemetry published in shared memory.
+ *
+ */
+
+#include "telemetry.h"
+#include "platform.h"
+#include "configurator.h"
+#include "log.h"
+
+#ifdef GITS_PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+
+namespace gits {
+namespace telemetry {
+
+namespace {
+// Published block, constant initialized so that the memory sniffer signal handler can read
+// it without triggering initialization. It is cleared when the publisher is destroyed.
+std::atomic<TTelemetryData*> publishedData(nullptr);
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+class CTelemetryPublisher {
+  TTelemetryData* _data;
+  std::string _name;
+  uint64_t _lastFrameEnd;
+
+public:
+  CTelemetryPublisher() : _data(nullptr), _lastFrameEnd(0) {
+#ifdef GITS_PLATFORM_LINUX
+    if (!Configurator::Get().common.shared.telemetry) {
+      return;
+    }
+
+    _name = "/" + std::string(TelemetryShmPrefix) + std::to_string(getpid());
+    int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd == -1) {
+      LOG_WARNING << "Telemetry: couldn't create shared memory " << _name << ": "
+                  << strerror(errno);
+      return;
+    }
+    void* ptr = MAP_FAILED;
+    if (ftruncate(fd, sizeof(TTelemetryData)) == 0) {
+      ptr = mmap(nullptr, sizeof(TTelemetryData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (ptr == MAP_FAILED) {
+      LOG_WARNING << "Telemetry: couldn't map shared memory " << _name << ": " << strerror(errno);
+      shm_unlink(_name.c_str());
+      return;
+    }
+
+    // Mapping is zero-filled, so all counters start at 0.
+    _data = new (ptr) TTelemetryData();
+    _data->pid = getpid();
+    _data->isRecorder = Configurator::IsRecorder() ? 1 : 0;
+    std::string processName;
+    std::ifstream comm("/proc/self/comm");
+    std::getline(comm, processName);
+    strncpy(_data->processName, processName.c_str(), sizeof(_data->processName) - 1);
+    _data->version = TelemetryVersion;
+    _data->updateTime.store(Now());
+    _data->phase.store(PHASE_STARTING);
+    // Magic is written last, readers ignore the block until it is set.
+    std::atomic_thread_fence(std::memory_order_release);
+    _data->magic = TelemetryMagic;
+    publishedData.store(_data);
+    LOG_INFO << "Telemetry published in /dev/shm" << _name;
+#endif
+  }
+
+  ~CTelemetryPublisher() {
+#ifdef GITS_PLATFORM_LINUX
+    if (_data != nullptr) {
+      publishedData.store(nullptr);
+      // Viewers keep their mapping of the removed block, so they can show the final values.
+      _data->phase.store(PHASE_FINISHED);
+      _data->updateTime.store(Now());
+      // Block is not unmapped, threads still running at exit may hold the pointer they got
+      // before it was cleared. Mapping is released with the process.
+      _data = nullptr;
+      shm_unlink(_name.c_str());
+    }
+#endif
+  }
+
+  uint64_t FrameTime(uint64_t now) {
+    const uint64_t time = _lastFrameEnd != 0 ? now - _lastFrameEnd : 0;
+    _lastFrameEnd = now;
+    return time;
+  }
+};
+
+CTelemetryPublisher& Publisher() {
+  static CTelemetryPublisher publisher;
+  return publisher;
+}
+} // namespace
+
+TTelemetryData* Data() {
+  Publisher();
+  return publishedData.load();
+}
+
+void FrameEnd(uint64_t frame) {
+  auto data = Data();
+  if (data == nullptr) {
+    return;
+  }
+  const uint64_t now = Now();
+  // First frame has no previous frame end to be measured from.
+  if (const uint64_t time = Publisher().FrameTime(now)) {
+    const uint64_t count = data->frameTimeCount.load(std::memory_order_relaxed);
+    data->frameTimes[count % FrameTimeRingSize].store(time, std::memory_order_relaxed);
+    data->frameTimeCount.store(count + 1, std::memory_order_release);
+  }
+  data->frame.store(frame, std::memory_order_relaxed);
+  if (data->phase.load(std::memory_order_relaxed) == PHASE_STARTING) {
+    data->phase.store(PHASE_RUNNING, std::memory_order_relaxed);
+  }
+  data->updateTime.store(now, std::memory_order_relaxed);
+}
+
+void TokensProcessed(uint64_t count) {
+  if (auto data = Data()) {
+    data->tokens.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void QueueDepth(uint64_t depth) {
+  if (auto data = Data()) {
+    data->queueDepth.store(depth, std::memory_order_relaxed);
+  }
+}
+
+void LoaderStall(uint64_t time) {
+  if (auto data = Data()) {
+    data->loaderStalls.fetch_add(1, std::memory_order_relaxed);
+    data->loaderStallTime.fetch_add(time, std::memory_order_relaxed);
+  }
+}
+
+void Compressed(uint64_t inBytes, uint64_t outBytes, uint64_t time) {
+  if (auto data = Data()) {
+    data->compressionInBytes.fetch_add(inBytes, std::memory_order_relaxed);
+    data->compressionOutBytes.fetch_add(outBytes, std::memory_order_relaxed);
+    data->compressionTime.fetch_add(time, std::memory_order_relaxed);
+  }
+}
+
+void Decompressed(uint64_t inBytes, uint64_t outBytes, uint64_t time) {
+  if (auto data = Data()) {
+    data->decompressionInBytes.fetch_add(inBytes, std::memory_order_relaxed);
+    data->decompressionOutBytes.fetch_add(outBytes, std::memory_order_relaxed);
+    data->decompressionTime.fetch_add(time, std::memory_order_relaxed);
+  }
+}
+
+void MemoryWriteFault() {
+  // Called from the memory sniffer signal handler, the publisher is created by Install.
+  if (auto data = publishedData.load()) {
+    data->memoryWriteFaults.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ShadowFlushed(uint64_t bytes) {
+  if (auto data = Data()) {
+    data->shadowFlushBytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+void StateRestoreStarted() {
+  if (auto data = Data()) {
+    const uint64_t now = Now();
+    data->stateRestoreTokenBase.store(data->tokens.load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
+    data->stateRestoreBegin.store(now, std::memory_order_relaxed);
+    data->stateRestoreTime.store(0, std::memory_order_relaxed);
+    data->phase.store(PHASE_STATE_RESTORE, std::memory_order_relaxed);
+    data->updateTime.store(now, std::memory_order_relaxed);
+  }
+}
+
+void StateRestoreFinished() {
+  if (auto data = Data()) {
+    const uint64_t now = Now();
+    data->stateRestoreTime.store(now - data->stateRestoreBegin.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+    data->phase.store(PHASE_RUNNING, std::memory_order_relaxed);
+    data->updateTime.store(now, std::memory_order_relaxed);
+  }
+}
+
+} // namespace telemetry
+} // namespace gits
@@ -12,6 +12,12 @@
 #include "log.h"
 #include <map>
 #include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+#include <smmintrin.h>
+#endif
 
 namespace gits {
 static const std::map<texel_type, std::string> texel_type_string = {
@@ -454,9 +460,10 @@ __pragma(warning(pop))
                                OutMin,
                                OutMax> {
   static OutT convert(InT input) {
+    // std::max returns its first argument for NaN input, which keeps NaN out of the cast.
     return static_cast<OutT>(
-        std::max(std::min(static_cast<InT>(OutMax) * input, static_cast<InT>(OutMax)),
-                 static_cast<InT>(OutMin)));
+        std::min(std::max(static_cast<InT>(OutMin), static_cast<InT>(OutMax) * input),
+                 static_cast<InT>(OutMax)));
   }
 };
 
@@ -1174,11 +1181,194 @@ __pragma(warning(pop))
                           Out::comp4_fmt::one_value>(ptr_in, ptr_out);
 }
 
+// Fast paths for the formats that dominate image dumps. The generic loop above converts texel by
+// texel through convert_texel; the specializations below handle whole spans and must produce
+// exactly the same bytes as the generic path.
+
+template <typename In, typename Out>
+void convert_texels(const uint8_t* input, uint8_t* output, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    convert_texel<In, Out>(input + i * In::size_in_bytes, output + i * Out::size_in_bytes);
+  }
+}
+
+// RGBA8 <-> BGRA8 swap the first and third byte of every texel.
+void swap_red_blue_8bit(const uint8_t* input, uint8_t* output, size_t count) {
+  size_t i = 0;
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+  const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  for (; i + 4 <= count; i += 4) {
+    __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4), _mm_shuffle_epi8(texels, mask));
+  }
+#endif
+  for (; i < count; ++i) {
+    output[i * 4 + 0] = input[i * 4 + 2];
+    output[i * 4 + 1] = input[i * 4 + 1];
+    output[i * 4 + 2] = input[i * 4 + 0];
+    output[i * 4 + 3] = input[i * 4 + 3];
+  }
+}
+
+// 10:10:10:2 unorm -> 8:8:8:8 unorm. In* are bit offsets of the 10-bit components in the packed
+// input, Out* are byte indices of the components in the output texel.
+template <int InR, int InG, int InB, int OutR, int OutG, int OutB, int OutA>
+void convert_10_10_10_2_unorm(const uint8_t* input, uint8_t* output, size_t count) {
+  size_t i = 0;
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  for (; i + 4 <= count; i += 4) {
+    __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 4));
+    __m128i r = _mm_and_si128(_mm_srli_epi32(texels, InR + 2), mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(texels, InG + 2), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(texels, InB + 2), mask);
+    __m128i a = _mm_slli_epi32(_mm_srli_epi32(texels, 30), 6);
+    __m128i result = _mm_or_si128(
+        _mm_or_si128(_mm_slli_epi32(r, OutR * 8), _mm_slli_epi32(g, OutG * 8)),
+        _mm_or_si128(_mm_slli_epi32(b, OutB * 8), _mm_slli_epi32(a, OutA * 8)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4), result);
+  }
+#endif
+  for (; i < count; ++i) {
+    uint32_t texel;
+    std::memcpy(&texel, input + i * 4, sizeof(texel));
+    output[i * 4 + OutR] = static_cast<uint8_t>((texel >> (InR + 2)) & 0xFF);
+    output[i * 4 + OutG] = static_cast<uint8_t>((texel >> (InG + 2)) & 0xFF);
+    output[i * 4 + OutB] = static_cast<uint8_t>((texel >> (InB + 2)) & 0xFF);
+    output[i * 4 + OutA] = static_cast<uint8_t>((texel >> 30) << 6);
+  }
+}
+
+// Half float -> unorm8 has only 65536 possible inputs, so it is cheaper to look the result up than
+// to decode every component.
+const uint8_t* half_to_unorm8_table() {
+  static const std::vector<uint8_t> table = [] {
+    std::vector<uint8_t> values(65536);
+    for (uint32_t i = 0; i < values.size(); ++i) {
+      values[i] = convert_component<float_16, unorm_8>(static_cast<uint16_t>(i));
+    }
+    return values;
+  }();
+  return table.data();
+}
+
+template <int OutR, int OutG, int OutB, int OutA>
+void convert_rgba16f_to_unorm8(const uint8_t* input, uint8_t* output, size_t count) {
+  const uint8_t* table = half_to_unorm8_table();
+  for (size_t i = 0; i < count; ++i) {
+    uint16_t texel[4];
+    std::memcpy(texel, input + i * 8, sizeof(texel));
+    output[i * 4 + OutR] = table[texel[0]];
+    output[i * 4 + OutG] = table[texel[1]];
+    output[i * 4 + OutB] = table[texel[2]];
+    output[i * 4 + OutA] = table[texel[3]];
+  }
+}
+
+// Index of the RGBA component that lands in the given byte of the output texel.
+constexpr int source_component(int byte, int out_g, int out_b, int out_a) {
+  return out_a == byte ? 3 : out_b == byte ? 2 : out_g == byte ? 1 : 0;
+}
+
+// Float -> unorm8 clamps 255 * value to [0, 255] and truncates, same as component_converter.
+// Max with zero goes first, _mm_max_ps returns its second operand for NaN, so NaN becomes 0.
+template <int OutR, int OutG, int OutB, int OutA>
+void convert_rgba32f_to_unorm8(const uint8_t* input, uint8_t* output, size_t count) {
+  size_t i = 0;
+#if !defined GITS_ARCH_ARM && !defined GITS_ARCH_A64
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 zero = _mm_setzero_ps();
+  auto load = [&](size_t texel) {
+    __m128 value = _mm_mul_ps(_mm_loadu_ps(reinterpret_cast<const float*>(input + texel * 16)),
+                              scale);
+    __m128i result = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(value, zero), scale));
+    return _mm_shuffle_epi32(result, _MM_SHUFFLE(source_component(3, OutG, OutB, OutA),
+                                                 source_component(2, OutG, OutB, OutA),
+                                                 source_component(1, OutG, OutB, OutA),
+                                                 source_component(0, OutG, OutB, OutA)));
+  };
+  for (; i + 4 <= count; i += 4) {
+    __m128i low = _mm_packs_epi32(load(i), load(i + 1));
+    __m128i high = _mm_packs_epi32(load(i + 2), load(i + 3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4), _mm_packus_epi16(low, high));
+  }
+#endif
+  for (; i < count; ++i) {
+    float texel[4];
+    std::memcpy(texel, input + i * 16, sizeof(texel));
+    output[i * 4 + OutR] = convert_component<float_32, unorm_8>(texel[0]);
+    output[i * 4 + OutG] = convert_component<float_32, unorm_8>(texel[1]);
+    output[i * 4 + OutB] = convert_component<float_32, unorm_8>(texel[2]);
+    output[i * 4 + OutA] = convert_component<float_32, unorm_8>(texel[3]);
+  }
+}
+
+template <>
+void convert_texels<rgba_8unorm, bgra_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  swap_red_blue_8bit(input, output, count);
+}
+template <>
+void convert_texels<bgra_8unorm, rgba_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  swap_red_blue_8bit(input, output, count);
+}
+template <>
+void convert_texels<rgba_8unorm, rgba_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  std::memcpy(output, input, count * 4);
+}
+template <>
+void convert_texels<bgra_8unorm, bgra_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  std::memcpy(output, input, count * 4);
+}
+template <>
+void convert_texels<rgb10a2_unorm, bgra_8unorm>(const uint8_t* input,
+                                                uint8_t* output,
+                                                size_t count) {
+  convert_10_10_10_2_unorm<0, 10, 20, 2, 1, 0, 3>(input, output, count);
+}
+template <>
+void convert_texels<rgb10a2_unorm, rgba_8unorm>(const uint8_t* input,
+                                                uint8_t* output,
+                                                size_t count) {
+  convert_10_10_10_2_unorm<0, 10, 20, 0, 1, 2, 3>(input, output, count);
+}
+template <>
+void convert_texels<bgr10a2_unorm, bgra_8unorm>(const uint8_t* input,
+                                                uint8_t* output,
+                                                size_t count) {
+  convert_10_10_10_2_unorm<20, 10, 0, 2, 1, 0, 3>(input, output, count);
+}
+template <>
+void convert_texels<bgr10a2_unorm, rgba_8unorm>(const uint8_t* input,
+                                                uint8_t* output,
+                                                size_t count) {
+  convert_10_10_10_2_unorm<20, 10, 0, 0, 1, 2, 3>(input, output, count);
+}
+template <>
+void convert_texels<rgba_16f, bgra_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  convert_rgba16f_to_unorm8<2, 1, 0, 3>(input, output, count);
+}
+template <>
+void convert_texels<rgba_16f, rgba_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  convert_rgba16f_to_unorm8<0, 1, 2, 3>(input, output, count);
+}
+template <>
+void convert_texels<rgba_32f, bgra_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  convert_rgba32f_to_unorm8<2, 1, 0, 3>(input, output, count);
+}
+template <>
+void convert_texels<rgba_32f, rgba_8unorm>(const uint8_t* input, uint8_t* output, size_t count) {
+  convert_rgba32f_to_unorm8<0, 1, 2, 3>(input, output, count);
+}
+
+// Images smaller than this are converted on the calling thread, spawning workers costs more.
+const size_t parallel_conversion_min_texels = 512 * 512;
+
 template <typename In, typename Out>
 void convert(const std::vector<uint8_t>& input_data,
              std::vector<uint8_t>& output_data,
              int width,
-             int height) {
+             int height,
+             unsigned thread_count) {
   auto input_texel_size = In::size_in_bytes;
   auto input_image_size = input_texel_size * width * height;
   auto output_texel_size = Out::size_in_bytes;
@@ -1197,8 +1387,38 @@ void convert(const std::vector<uint8_t>& input_data,
     throw std::runtime_error(EXCEPTION_MESSAGE);
   }
 
-  for (int i = 0, j = 0; i < input_image_size; i += input_texel_size, j += output_texel_size) {
-    convert_texel<In, Out>(&input_data[i], &output_data[j]);
+  const uint8_t* input = input_data.data();
+  uint8_t* output = output_data.data();
+  size_t texel_count = static_cast<size_t>(width) * height;
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  thread_count = static_cast<unsigned>(std::min<size_t>(
+      {thread_count, static_cast<size_t>(height), texel_count / parallel_conversion_min_texels}));
+  if (thread_count <= 1) {
+    convert_texels<In, Out>(input, output, texel_count);
+    return;
+  }
+
+  // Split the image into horizontal bands of whole rows, the calling thread takes the last one.
+  size_t rows_per_band = (height + thread_count - 1) / thread_count;
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count - 1);
+  for (size_t row = 0; row < (size_t)height; row += rows_per_band) {
+    size_t offset = row * width;
+    size_t count = std::min(rows_per_band, height - row) * width;
+    auto band = [=] {
+      convert_texels<In, Out>(input + offset * input_texel_size,
+                              output + offset * output_texel_size, count);
+    };
+    if (row + rows_per_band < (size_t)height) {
+      workers.emplace_back(band);
+    } else {
+      band();
+    }
+  }
+  for (auto& worker : workers) {
+    worker.join();
   }
 }
 
@@ -1206,7 +1426,8 @@ using conversion_type = std::pair<texel_type, texel_type>;
 using conversion_function = void (*)(const std::vector<uint8_t>& input_data,
                                      std::vector<uint8_t>& output_data,
                                      int width,
-                                     int height);
+                                     int height,
+                                     unsigned thread_count);
 
 std::map<conversion_type, conversion_function> converter_map = {
     // conversions to BGRA8 unsigned normalized:
@@ -1851,10 +2072,11 @@ void gits::convert_texture_data(texel_type input_type,
                                 texel_type output_type,
                                 std::vector<uint8_t>& output_data,
                                 int width,
-                                int height) {
+                                int height,
+                                unsigned thread_count) {
   texture_converter::conversion_function converter =
       texture_converter::get_converter(input_type, output_type);
-  converter(input_data, output_data, width, height);
+  converter(input_data, output_data, width, height, thread_count);
 }
 
 void gits::normalize_texture_data(texel_type type,
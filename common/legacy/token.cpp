@@ -87,6 +87,7 @@ static void OnFrameBeginImpl() {
 }
 
 static void OnFrameEndImpl() {
+  telemetry::FrameEnd(CGits::Instance().CurrentFrame());
   if (Configurator::Get().common.player.benchmark) {
     CGits::Instance().TimeSheet().add_frame_time("stamp", CGits::Instance().Timers().program.Get());
     CGits::Instance().TimeSheet().add_frame_time("cpu", CGits::Instance().Timers().frame.Get());
@@ -0,0 +1,182 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   token_sequencer.cpp
+ *
+ * @brief Per-thread buffering of recorded tokens merged in the global recording order.
+ *
+ */
+
+#include "token_sequencer.h"
+#include "tools.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace gits {
+
+namespace {
+std::atomic<uint64_t> nextSequencerId(1);
+
+// Releases the buffer of the current thread when the thread exits or starts recording
+// to another sequencer.
+template <class T>
+struct CThreadBufferOwner {
+  uint64_t sequencerId = 0;
+  std::shared_ptr<T> buffer;
+
+  void Reset(uint64_t id, std::shared_ptr<T> newBuffer) {
+    Release();
+    sequencerId = id;
+    buffer = std::move(newBuffer);
+  }
+  void Release() {
+    if (buffer) {
+      buffer->released = true;
+      buffer.reset();
+    }
+  }
+  ~CThreadBufferOwner() {
+    Release();
+  }
+};
+} // namespace
+
+CTokenSequencer::CTokenSequencer(TConsumer consumer)
+    : _consumer(std::move(consumer)),
+      _id(nextSequencerId++),
+      _nextSequence(0),
+      _delivered(0),
+      _appended(0),
+      _mergerWaiting(false),
+      _stop(false) {
+  _merger = std::thread(&CTokenSequencer::Merge, this);
+}
+
+CTokenSequencer::~CTokenSequencer() {
+  Flush();
+  {
+    std::lock_guard<std::mutex> lock(_wakeMutex);
+    _stop = true;
+  }
+  _wake.notify_one();
+  _merger.join();
+}
+
+CTokenSequencer::CThreadBuffer& CTokenSequencer::ThreadBuffer() {
+  // Sequencer id rather than address identifies the owner, a new sequencer may reuse
+  // the address of a destroyed one.
+  thread_local CThreadBufferOwner<CThreadBuffer> owner;
+  if (owner.sequencerId != _id) {
+    auto buffer = std::make_shared<CThreadBuffer>();
+    {
+      std::lock_guard<std::mutex> lock(_buffersMutex);
+      _buffers.push_back(buffer);
+    }
+    owner.Reset(_id, std::move(buffer));
+  }
+  return *owner.buffer;
+}
+
+void CTokenSequencer::Schedule(CToken* token) {
+  auto& buffer = ThreadBuffer();
+  {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.tokens.emplace_back(_nextSequence++, token);
+    ++_appended;
+  }
+  if (_mergerWaiting) {
+    std::lock_guard<std::mutex> lock(_wakeMutex);
+    _wake.notify_one();
+  }
+}
+
+void CTokenSequencer::Flush() {
+  if (std::this_thread::get_id() == _merger.get_id()) {
+    return;
+  }
+  const uint64_t target = _nextSequence;
+  if (_delivered >= target) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(_flushMutex);
+  _flushed.wait(lock, [&] { return _delivered >= target; });
+}
+
+void CTokenSequencer::Merge() {
+  // Tokens already collected from thread buffers, kept as a min-heap on sequence.
+  std::vector<TSequencedToken> pending;
+  std::vector<TSequencedToken> collected;
+  const auto later = [](const TSequencedToken& a, const TSequencedToken& b) {
+    return a.first > b.first;
+  };
+  uint64_t next = 0;
+  uint64_t collectedCount = 0;
+  try {
+    for (;;) {
+      {
+        // Sleeps until a thread appends a token, also when the token with the next
+        // sequence number is still being appended by its thread.
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _mergerWaiting = true;
+        _wake.wait(lock, [&] { return _stop || _appended != collectedCount; });
+        _mergerWaiting = false;
+        if (_stop && _appended == collectedCount && _nextSequence == next) {
+          break;
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> buffersLock(_buffersMutex);
+        for (auto it = _buffers.begin(); it != _buffers.end();) {
+          auto& buffer = **it;
+          // Read before draining, a released buffer gets no more tokens.
+          const bool released = buffer.released;
+          {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            collected.swap(buffer.tokens);
+          }
+          for (const auto& token : collected) {
+            pending.push_back(token);
+            std::push_heap(pending.begin(), pending.end(), later);
+          }
+          collectedCount += collected.size();
+          collected.clear();
+          it = released ? _buffers.erase(it) : it + 1;
+        }
+      }
+
+      const uint64_t first = next;
+      while (!pending.empty() && pending.front().first == next) {
+        CToken* token = pending.front().second;
+        std::pop_heap(pending.begin(), pending.end(), later);
+        pending.pop_back();
+        _consumer(token);
+        ++next;
+      }
+
+      if (next == first) {
+        continue;
+      }
+      _delivered = next;
+      {
+        std::lock_guard<std::mutex> lock(_flushMutex);
+      }
+      _flushed.notify_all();
+    }
+  } catch (std::exception& e) {
+    LOG_ERROR << "Error in token sequencer thread: " << e.what();
+    fast_exit(1);
+  } catch (...) {
+    LOG_ERROR << "Unknown error in token sequencer thread";
+    fast_exit(1);
+  }
+}
+
+} // namespace gits
@@ -17,15 +17,18 @@
 #include "MurmurHash3.h"
 #include "xxhash.h"
 
+#include <atomic>
 #include <cstdint>
 #include <regex>
 #include <fstream>
 
 #include "MemorySniffer.h"
+#include "telemetry.h"
 #include "token.h"
 #ifdef GITS_PLATFORM_WINDOWS
 #include <Windows.h>
 #include <process.h>
+#include <psapi.h>
 #else
 #include <sys/mman.h>
 #endif
@@ -89,6 +92,52 @@ void gits_assert(bool condition,
   }
 }
 
+namespace {
+XXH128_hash_t CombineChunkHashes(const std::vector<XXH128_hash_t>& chunkHashes, size_t size) {
+  return XXH3_128bits_withSeed(chunkHashes.data(), chunkHashes.size() * sizeof(XXH128_hash_t),
+                               size);
+}
+
+XXH128_hash_t ComputeParallelHash128(const void* data, size_t size) {
+  const char* cdata = static_cast<const char*>(data);
+  const size_t chunkCount = (size + ParallelHashChunkSize - 1) / ParallelHashChunkSize;
+  std::vector<XXH128_hash_t> chunkHashes(chunkCount);
+  std::atomic<size_t> nextChunk(0);
+  auto hashChunks = [&] {
+    for (size_t i = nextChunk++; i < chunkCount; i = nextChunk++) {
+      const size_t offset = i * ParallelHashChunkSize;
+      chunkHashes[i] = XXH3_128bits(cdata + offset, std::min(ParallelHashChunkSize, size - offset));
+    }
+  };
+
+  const size_t threadCount =
+      std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), chunkCount);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threadCount; ++i) {
+    workers.emplace_back(hashChunks);
+  }
+  hashChunks();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return CombineChunkHashes(chunkHashes, size);
+}
+
+XXH128_hash_t ComputeXXH3_128(const void* data, size_t size) {
+  if (size > ParallelHashThreshold) {
+    return ComputeParallelHash128(data, size);
+  }
+  return XXH3_128bits(data, size);
+}
+
+uint64_t ComputeXXH3_64(const void* data, size_t size) {
+  if (size > ParallelHashThreshold) {
+    return ComputeParallelHash128(data, size).low64;
+  }
+  return XXH3_64bits(data, size);
+}
+} // namespace
+
 uint64_t ComputeHash(const void* data,
                      size_t size,
                      THashType type,
@@ -101,10 +150,20 @@ uint64_t ComputeHash(const void* data,
     uint32_t u32[2];
   };
 
+  const bool isXXH3 = type == THashType::XXH3_64 || type == THashType::XXH3_128;
   if (type == THashType::INCREMENTAL_NUMBER) {
     // Use static int as hasing value.
     static uint64_t hash_val = 0;
     return ++hash_val;
+  } else if (hashPartially && size > partialHashCutoff && isXXH3) {
+    uint64_t hash = size;
+    const size_t chunk_size = size / (static_cast<size_t>(partialHashRatio) * partialHashChunks);
+    const size_t chunk_stride = size / partialHashChunks;
+    const char* cdata = (const char*)data;
+    for (uint32_t i = 0; i < partialHashChunks; ++i) {
+      hash = XXH3_64bits_withSeed(cdata + i * chunk_stride, chunk_size, hash);
+    }
+    return hash;
   } else if (hashPartially && size > partialHashCutoff) {
     // Derive hash from only part of data. We only hope that this
     // doesn't generate collisions. Should be used only when verified
@@ -133,6 +192,10 @@ uint64_t ComputeHash(const void* data,
     val.u32[0] = hash;
     val.u32[1] = hash2;
     return val.u64;
+  } else if (type == THashType::XXH3_64) {
+    return ComputeXXH3_64(data, size);
+  } else if (type == THashType::XXH3_128) {
+    return ComputeXXH3_128(data, size).low64;
   } else {
     u32u64 val;
     if (type == THashType::XX || type == THashType::XXCRC32) {
@@ -157,6 +220,102 @@ uint64_t ComputeHash(const void* data, size_t size, THashType type) {
   return ComputeHash(data, size, type, false, 0, 0, 0);
 }
 
+THash128 ComputeHash128(const void* data, size_t size) {
+  const auto hash = ComputeXXH3_128(data, size);
+  return {hash.low64, hash.high64};
+}
+
+// Data is hashed both as a whole and in ParallelHashChunkSize chunks until it exceeds
+// ParallelHashThreshold, from then on only chunk hashes are gathered, as ComputeHash does.
+struct CHashStream::Impl {
+  THashType type;
+  size_t size = 0;
+  XXH3_state_t* whole = nullptr;
+  XXH3_state_t* chunk = nullptr;
+  size_t chunkSize = 0;
+  std::vector<XXH128_hash_t> chunkHashes;
+};
+
+CHashStream::CHashStream(THashType type) : _impl(std::make_unique<Impl>()) {
+  if (type != THashType::XXH3_64 && type != THashType::XXH3_128) {
+    throw std::runtime_error("CHashStream supports only XXH3_64 and XXH3_128 hash types.");
+  }
+  _impl->type = type;
+  _impl->whole = XXH3_createState();
+  _impl->chunk = XXH3_createState();
+  if (_impl->whole == nullptr || _impl->chunk == nullptr) {
+    XXH3_freeState(_impl->whole);
+    XXH3_freeState(_impl->chunk);
+    throw std::bad_alloc();
+  }
+  Reset();
+}
+
+CHashStream::~CHashStream() {
+  XXH3_freeState(_impl->whole);
+  XXH3_freeState(_impl->chunk);
+}
+
+void CHashStream::Reset() {
+  _impl->size = 0;
+  _impl->chunkSize = 0;
+  _impl->chunkHashes.clear();
+  if (_impl->type == THashType::XXH3_64) {
+    XXH3_64bits_reset(_impl->whole);
+  } else {
+    XXH3_128bits_reset(_impl->whole);
+  }
+  XXH3_128bits_reset(_impl->chunk);
+}
+
+void CHashStream::Update(const void* data, size_t size) {
+  auto& impl = *_impl;
+  if (impl.size + size <= ParallelHashThreshold) {
+    if (impl.type == THashType::XXH3_64) {
+      XXH3_64bits_update(impl.whole, data, size);
+    } else {
+      XXH3_128bits_update(impl.whole, data, size);
+    }
+  }
+  impl.size += size;
+
+  const char* cdata = static_cast<const char*>(data);
+  while (size > 0) {
+    const size_t part = std::min(size, ParallelHashChunkSize - impl.chunkSize);
+    XXH3_128bits_update(impl.chunk, cdata, part);
+    impl.chunkSize += part;
+    cdata += part;
+    size -= part;
+    if (impl.chunkSize == ParallelHashChunkSize) {
+      impl.chunkHashes.push_back(XXH3_128bits_digest(impl.chunk));
+      XXH3_128bits_reset(impl.chunk);
+      impl.chunkSize = 0;
+    }
+  }
+}
+
+THash128 CHashStream::Digest128() const {
+  XXH128_hash_t hash;
+  if (_impl->size <= ParallelHashThreshold) {
+    if (_impl->type == THashType::XXH3_64) {
+      const uint64_t hash64 = XXH3_64bits_digest(_impl->whole);
+      return {hash64, 0};
+    }
+    hash = XXH3_128bits_digest(_impl->whole);
+  } else {
+    auto chunkHashes = _impl->chunkHashes;
+    if (_impl->chunkSize != 0) {
+      chunkHashes.push_back(XXH3_128bits_digest(_impl->chunk));
+    }
+    hash = CombineChunkHashes(chunkHashes, _impl->size);
+  }
+  return {hash.low64, hash.high64};
+}
+
+uint64_t CHashStream::Digest() const {
+  return Digest128().low;
+}
+
 std::string CommandOutput(const std::string& command, bool isRecorder) {
 #ifdef GITS_PLATFORM_WINDOWS
   // Windows can't handle popen correctly in non-console applications.
@@ -247,6 +406,14 @@ bool SavePng(const std::string& filename,
     png_set_sRGB(png_ptr, info_ptr, PNG_sRGB_INTENT_SATURATION);
   }
 
+  int compressionLevel =
+      static_cast<int>(std::min(Configurator::Get().common.shared.pngCompressionLevel, 9u));
+  png_set_compression_level(png_ptr, compressionLevel);
+  if (compressionLevel == 0) {
+    // Filtering only helps the compressor, skip it when data is stored as is.
+    png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+  }
+
   // build rows
   void** rows = (void**)png_malloc(
       png_ptr, ensure_unsigned32bit_representible<size_t>(sizeof(void*) * height));
@@ -439,6 +606,24 @@ std::string GetLinuxProcessNamePath() {
 #endif
 }
 
+uint64_t GetPeakMemoryUsage() {
+#if defined GITS_PLATFORM_WINDOWS
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return counters.PeakWorkingSetSize;
+  }
+#elif defined GITS_PLATFORM_LINUX
+  std::ifstream file("/proc/self/status");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+#endif
+  return 0;
+}
+
 unsigned int stoui(const std::string& str) {
   const unsigned long as_ulong = std::stoul(str, nullptr, 10);
   const unsigned int as_uint = as_ulong;
@@ -562,6 +747,46 @@ void gits::ShadowBuffer::Flush(size_t offset, size_t size) {
   shadowPtr = shadowPtr + offset;
   origPtr = origPtr + offset;
   memcpy(origPtr, shadowPtr, size);
+  telemetry::ShadowFlushed(size);
+}
+
+void gits::ShadowBuffer::Flush(const std::vector<std::pair<size_t, size_t>>& ranges) {
+  size_t totalSize = 0;
+  for (const auto& range : ranges) {
+    totalSize += range.second;
+  }
+  if (totalSize <= ParallelShadowFlushThreshold) {
+    for (const auto& range : ranges) {
+      Flush(range.first, range.second);
+    }
+    return;
+  }
+
+  // Ranges are split into chunks, so a single big range is spread over the threads too.
+  std::vector<std::pair<size_t, size_t>> chunks;
+  for (const auto& range : ranges) {
+    for (size_t pos = 0; pos < range.second; pos += ParallelShadowFlushChunkSize) {
+      chunks.push_back(
+          {range.first + pos, std::min(ParallelShadowFlushChunkSize, range.second - pos)});
+    }
+  }
+  std::atomic<size_t> nextChunk(0);
+  auto flushChunks = [&] {
+    for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+      Flush(chunks[i].first, chunks[i].second);
+    }
+  };
+
+  const size_t threadCount =
+      std::min<size_t>(std::clamp(std::thread::hardware_concurrency(), 1u, 8u), chunks.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threadCount; ++i) {
+    workers.emplace_back(flushChunks);
+  }
+  flushChunks();
+  for (auto& worker : workers) {
+    worker.join();
+  }
 }
 
 void gits::ShadowBuffer::UpdateShadow(size_t offset, size_t size) {
@@ -615,8 +840,10 @@ std::pair<const void*, size_t> gits::GetSubrangeOverlappingMemoryPages(
   return newRange;
 }
 
+// GetIntervalSetFromMemoryPages - returns sorted [begin, end) address intervals of the
+// pages clipped to the range. Intervals separated by no more than maxGap bytes are merged.
 std::vector<std::pair<uint64_t, uint64_t>> gits::GetIntervalSetFromMemoryPages(
-    std::pair<const void*, size_t> range, const std::set<const void*>& pages) {
+    std::pair<const void*, size_t> range, const std::set<const void*>& pages, uint64_t maxGap) {
   const void* ptr = range.first;
   size_t size = range.second;
   const void* ptrEnd = (void*)((char*)ptr + size);
@@ -630,7 +857,7 @@ std::vector<std::pair<uint64_t, uint64_t>> gits::GetIntervalSetFromMemoryPages(
 
     if (addr_begin < addr_end) {
       if ((pagesMap.size() > 0) && (addr_begin >= pagesMap.back().first) &&
-          (addr_begin <= pagesMap.back().second + 1)) {
+          (addr_begin <= pagesMap.back().second + std::max<uint64_t>(maxGap, 1))) {
         if (addr_end > pagesMap.back().second) {
           pagesMap.back().second = (uint64_t)addr_end;
         }
@@ -716,7 +943,7 @@ uint64_t gits::LZ4StreamCompressor::Compress(const char* uncompressedData,
   int returnedCompressedSize = LZ4_compress_fast_extState(
       &ctx, uncompressedData, compressedData->data(), static_cast<int32_t>(uncompressedDataSize),
       static_cast<int32_t>(lz4MaxCompressedSize),
-      perfModes.at(Configurator::Get().common.recorder.compression.level));
+      perfModes.at(level_));
   if (returnedCompressedSize <= 0) {
     LOG_ERROR << "LZ4 Compress failed.";
     throw EOperationFailed(EXCEPTION_MESSAGE);
@@ -752,7 +979,12 @@ uint64_t gits::LZ4StreamCompressor::MaxCompressedSize(const uint64_t dataSize) {
   return static_cast<uint64_t>(LZ4_compressBound(static_cast<int>(dataSize)));
 }
 
-gits::ZSTDStreamCompressor::ZSTDStreamCompressor() {
+void gits::LZ4StreamCompressor::SetLevel(uint32_t level) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  level_ = level;
+}
+
+gits::ZSTDStreamCompressor::ZSTDStreamCompressor(uint32_t level) : level_(level) {
   ZSTDContext = ZSTD_createCCtx();
 }
 
@@ -770,7 +1002,7 @@ uint64_t gits::ZSTDStreamCompressor::Compress(const char* uncompressedData,
   }
   uint64_t returnedCompressedSize = ZSTD_compressCCtx(
       ZSTDContext, compressedData->data(), zstdMaxCompressedSize, uncompressedData,
-      uncompressedDataSize, perfModes.at(Configurator::Get().common.recorder.compression.level));
+      uncompressedDataSize, perfModes.at(level_));
   if (ZSTD_isError(returnedCompressedSize)) {
     LOG_ERROR << "ZSTD Compress failed with error code:" << returnedCompressedSize;
     throw EOperationFailed(EXCEPTION_MESSAGE);
@@ -796,6 +1028,11 @@ uint64_t gits::ZSTDStreamCompressor::MaxCompressedSize(const uint64_t dataSize)
   return static_cast<uint64_t>(ZSTD_compressBound(dataSize));
 }
 
+void gits::ZSTDStreamCompressor::SetLevel(uint32_t level) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  level_ = level;
+}
+
 #if defined(GITS_PLATFORM_WINDOWS)
 std::string gits::GetRenderDocDllPath() {
   std::string dllpath = "";
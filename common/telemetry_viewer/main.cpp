@@ -0,0 +1,238 @@
+// ===================== begin_copyright_notice ============================
+//
+// Copyright (C) 2023-2025 Intel Corporation
+//
+// SPDX-License-Identifier: MIT
+//
+// ===================== end_copyright_notice ==============================
+
+/**
+ * @file   main.cpp
+ *
+ * @brief Console viewer of the live telemetry published by gitsPlayer and gitsRecorder.
+ *
+ */
+
+#include "telemetry.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gits::telemetry;
+
+namespace {
+
+struct TSample {
+  uint64_t time;
+  uint64_t tokens;
+  uint64_t loaderStalls;
+  uint64_t loaderStallTime;
+  uint64_t compressionInBytes;
+  uint64_t compressionOutBytes;
+  uint64_t compressionTime;
+  uint64_t decompressionOutBytes;
+  uint64_t decompressionTime;
+  uint64_t memoryWriteFaults;
+  uint64_t shadowFlushBytes;
+  uint64_t frameTimeCount;
+};
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+TSample Sample(const TTelemetryData& data) {
+  TSample sample;
+  sample.time = Now();
+  sample.tokens = data.tokens.load(std::memory_order_relaxed);
+  sample.loaderStalls = data.loaderStalls.load(std::memory_order_relaxed);
+  sample.loaderStallTime = data.loaderStallTime.load(std::memory_order_relaxed);
+  sample.compressionInBytes = data.compressionInBytes.load(std::memory_order_relaxed);
+  sample.compressionOutBytes = data.compressionOutBytes.load(std::memory_order_relaxed);
+  sample.compressionTime = data.compressionTime.load(std::memory_order_relaxed);
+  sample.decompressionOutBytes = data.decompressionOutBytes.load(std::memory_order_relaxed);
+  sample.decompressionTime = data.decompressionTime.load(std::memory_order_relaxed);
+  sample.memoryWriteFaults = data.memoryWriteFaults.load(std::memory_order_relaxed);
+  sample.shadowFlushBytes = data.shadowFlushBytes.load(std::memory_order_relaxed);
+  sample.frameTimeCount = data.frameTimeCount.load(std::memory_order_acquire);
+  return sample;
+}
+
+double MBps(uint64_t bytes, uint64_t time) {
+  return time == 0 ? 0.0 : bytes * 1e9 / time / (1024 * 1024);
+}
+
+void PrintSample(const TTelemetryData& data, const TSample& prev, const TSample& curr) {
+  const double seconds = std::max<uint64_t>(curr.time - prev.time, 1) / 1e9;
+
+  // Frames overwritten in the ring since the previous sample are skipped.
+  const uint64_t firstFrame =
+      std::max(prev.frameTimeCount, curr.frameTimeCount > FrameTimeRingSize
+                                        ? curr.frameTimeCount - FrameTimeRingSize
+                                        : uint64_t(0));
+  uint64_t frameTimeSum = 0;
+  uint64_t frameTimeMax = 0;
+  for (uint64_t i = firstFrame; i < curr.frameTimeCount; ++i) {
+    const uint64_t time = data.frameTimes[i % FrameTimeRingSize].load(std::memory_order_relaxed);
+    frameTimeSum += time;
+    frameTimeMax = std::max(frameTimeMax, time);
+  }
+  const uint64_t frames = curr.frameTimeCount - firstFrame;
+
+  std::printf("frame %6llu | %6.1f fps | frame avg %7.2f ms max %7.2f ms | %9.0f tokens/s",
+              (unsigned long long)data.frame.load(std::memory_order_relaxed),
+              (curr.frameTimeCount - prev.frameTimeCount) / seconds,
+              frames ? frameTimeSum / 1e6 / frames : 0.0, frameTimeMax / 1e6,
+              (curr.tokens - prev.tokens) / seconds);
+  std::printf(" | queue %2llu stalls %3llu (%6.1f ms)",
+              (unsigned long long)data.queueDepth.load(std::memory_order_relaxed),
+              (unsigned long long)(curr.loaderStalls - prev.loaderStalls),
+              (curr.loaderStallTime - prev.loaderStallTime) / 1e6);
+
+  const uint64_t compressionIn = curr.compressionInBytes - prev.compressionInBytes;
+  const uint64_t compressionOut = curr.compressionOutBytes - prev.compressionOutBytes;
+  if (data.isRecorder) {
+    std::printf(" | compress %7.1f MB/s ratio %4.2f",
+                MBps(compressionIn, curr.compressionTime - prev.compressionTime),
+                compressionOut ? (double)compressionIn / compressionOut : 0.0);
+  } else {
+    std::printf(" | decompress %7.1f MB/s",
+                MBps(curr.decompressionOutBytes - prev.decompressionOutBytes,
+                     curr.decompressionTime - prev.decompressionTime));
+  }
+  std::printf(" | write faults %6.0f/s shadow flush %7.1f MB/s",
+              (curr.memoryWriteFaults - prev.memoryWriteFaults) / seconds,
+              (curr.shadowFlushBytes - prev.shadowFlushBytes) / seconds / (1024 * 1024));
+
+  if (data.phase.load(std::memory_order_relaxed) == PHASE_STATE_RESTORE) {
+    std::printf(" | state restore %6.1f s, %llu tokens",
+                (curr.time - data.stateRestoreBegin.load(std::memory_order_relaxed)) / 1e9,
+                (unsigned long long)(curr.tokens -
+                                     data.stateRestoreTokenBase.load(std::memory_order_relaxed)));
+  } else if (const uint64_t restoreTime = data.stateRestoreTime.load(std::memory_order_relaxed)) {
+    std::printf(" | state restored in %.1f s", restoreTime / 1e9);
+  }
+  std::printf("\n");
+  std::fflush(stdout);
+}
+
+std::vector<unsigned> FindPublishers() {
+  std::vector<unsigned> pids;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.rfind(TelemetryShmPrefix, 0) == 0) {
+      pids.push_back(std::strtoul(name.c_str() + std::strlen(TelemetryShmPrefix), nullptr, 10));
+    }
+  }
+  std::sort(pids.begin(), pids.end());
+  return pids;
+}
+
+const TTelemetryData* Attach(unsigned pid) {
+  const std::string name = "/" + std::string(TelemetryShmPrefix) + std::to_string(pid);
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    std::fprintf(stderr, "Couldn't open %s: %s\n", name.c_str(), std::strerror(errno));
+    return nullptr;
+  }
+  void* ptr = mmap(nullptr, sizeof(TTelemetryData), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    std::fprintf(stderr, "Couldn't map %s: %s\n", name.c_str(), std::strerror(errno));
+    return nullptr;
+  }
+  const auto data = static_cast<const TTelemetryData*>(ptr);
+  // Publisher initializes the block before setting its magic.
+  for (int i = 0; i < 100 && data->magic != TelemetryMagic; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (data->magic != TelemetryMagic || data->version != TelemetryVersion) {
+    std::fprintf(stderr, "%s is not a compatible telemetry block.\n", name.c_str());
+    munmap(ptr, sizeof(TTelemetryData));
+    return nullptr;
+  }
+  return data;
+}
+
+void Usage() {
+  std::printf("Usage: gitsTelemetry [pid] [--interval <ms>] [--count <n>]\n"
+              "Shows live telemetry of a gitsPlayer or a recorded application run with the\n"
+              "telemetry option. Without pid, attaches to the only running publisher.\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  unsigned pid = 0;
+  unsigned interval = 1000;
+  unsigned count = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--interval" && i + 1 < argc) {
+      interval = std::max(std::strtoul(argv[++i], nullptr, 10), 1ul);
+    } else if (arg == "--count" && i + 1 < argc) {
+      count = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "-h" || arg == "--help") {
+      Usage();
+      return EXIT_SUCCESS;
+    } else if (std::isdigit((unsigned char)arg[0])) {
+      pid = std::strtoul(arg.c_str(), nullptr, 10);
+    } else {
+      Usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (pid == 0) {
+    const auto pids = FindPublishers();
+    if (pids.size() != 1) {
+      std::fprintf(stderr, pids.empty() ? "No telemetry publishers found in /dev/shm.\n"
+                                        : "Several telemetry publishers found, select pid:\n");
+      for (auto publisher : pids) {
+        std::fprintf(stderr, "  %u\n", publisher);
+      }
+      return EXIT_FAILURE;
+    }
+    pid = pids[0];
+  }
+
+  const TTelemetryData* data = Attach(pid);
+  if (data == nullptr) {
+    return EXIT_FAILURE;
+  }
+  std::printf("Attached to %s %s (pid %u)\n", data->isRecorder ? "recorder in" : "player",
+              data->processName, data->pid);
+
+  TSample prev = Sample(*data);
+  for (unsigned i = 0; count == 0 || i < count; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    const TSample curr = Sample(*data);
+    PrintSample(*data, prev, curr);
+    prev = curr;
+
+    // Process may crash without marking the block as finished.
+    if (data->phase.load(std::memory_order_relaxed) == PHASE_FINISHED || kill(pid, 0) != 0) {
+      std::printf("Process %u finished.\n", pid);
+      break;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -45,6 +45,8 @@ private:
   bool _interactive; /**< @brief defines if player is running in interactive mode */
   StreamingContext _sc;
 
+  void PreloadCompressedStream();
+
 public:
   CPlayer();
   ~CPlayer();
@@ -63,6 +65,7 @@ public:
   void GLResourceCleanup();
   void GLContextsCleanup();
   void StatisticsPrint() const;
+  void AnalysisPrint() const;
   void NotSupportedFunctionsPrint() const;
 };
 } // namespace gits
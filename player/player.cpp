@@ -17,6 +17,8 @@
 #include "stateDynamic.h"
 #include "openglTools.h"
 #include "statistics.h"
+#include "stream_analyzer.h"
+#include "stream_chunks.h"
 #include "function.h"
 #include "gits.h"
 #include "streams.h"
@@ -75,10 +77,57 @@ void gits::CPlayer::Load(const std::filesystem::path& fileName) {
   gits::CGits& inst = gits::CGits::Instance();
   (*_sc.iBinStream) >> inst;
 
+  if (Configurator::Get().common.player.preloadCompressedStream) {
+    PreloadCompressedStream();
+  }
+
   // load function call wrappers to the scheduler
   _sc.scheduler->Stream(_sc.iBinStream.get());
 }
 
+/**
+ * @brief Keeps the compressed stream in memory
+ *
+ * Method reads all compressed chunks of the stream to memory. The stream then
+ * takes its data from a decoder that decompresses the chunks in memory on
+ * separate threads, at most preloadDecodedWindow chunks ahead of the loader.
+ * Resource files are not preloaded, CResourceManager2 still reads them from disk.
+ */
+void gits::CPlayer::PreloadCompressedStream() {
+  const auto& cfgPlayer = Configurator::Get().common.player;
+  auto& stream = *_sc.iBinStream;
+  if (cfgPlayer.loadWholeStreamBeforePlayback) {
+    LOG_WARNING << "preloadCompressedStream is ignored with loadWholeStreamBeforePlayback.";
+    return;
+  }
+  if (stream_older_than(GITS_TOKEN_COMPRESSION)) {
+    LOG_WARNING << "Stream doesn't support compression, preloadCompressedStream is ignored.";
+    return;
+  }
+  stream.InitializeCompression();
+  if (stream.GetCompressionType() == CompressionType::NONE) {
+    LOG_WARNING << "Stream is not compressed, preloadCompressedStream is ignored.";
+    return;
+  }
+
+  Timer timer;
+  auto chunks = ReadStreamChunks(stream);
+  uint64_t compressedSize = 0;
+  uint64_t size = 0;
+  for (const auto& chunk : chunks) {
+    size += chunk.size;
+    for (const auto& part : chunk.parts) {
+      compressedSize += part.data.size();
+    }
+  }
+  LOG_INFO << "Preloaded " << chunks.size() << " compressed chunks (" << compressedSize / 1048576
+           << " MB, " << size / 1048576 << " MB decompressed) in " << timer.Get() / 1e6 << "ms";
+
+  auto decoder = std::make_shared<CChunkDecoder>(std::move(chunks), stream.GetCompressionType(),
+                                                 0, cfgPlayer.preloadDecodedWindow);
+  stream.SetChunkSource([decoder](std::vector<char>& data) { return decoder->Next(data); });
+}
+
 /**
  * @brief Plays loaded function calls wrappers
  *
@@ -155,6 +204,11 @@ void gits::CPlayer::StatisticsPrint() const {
   stats.Print();
 }
 
+void gits::CPlayer::AnalysisPrint() const {
+  const auto& analyze = Configurator::Get().common.player.analyze;
+  AnalyzeStream(*_sc.iBinStream, {analyze.jsonPath, analyze.threads});
+}
+
 void gits::CPlayer::NotSupportedFunctionsPrint() const {
   const CFile::CSkippedCalls& skippedCalls = gits::CGits::Instance().FilePlayer().SkippedCalls();
 
@@ -50,6 +50,8 @@
 #include "timer.h"
 #include "runner.h"
 #include "sequentialExecutor.h"
+#include "stream_journal.h"
+#include "stream_transcoder.h"
 #include "pragmas.h"
 #include "playerOptions.h"
 #include "message_pump.h"
@@ -302,6 +304,28 @@ int MainBody(int argc, char* argv[]) {
     CPlayer player;
     LOG_INFO << "Loading...";
 
+    // streams recorded in high integrity mode may need to be cut back to the last commit
+    if (cfg.common.player.recoverJournaledStream) {
+      if (RecoverJournaledStream(cfg.common.player.streamPath)) {
+        LOG_INFO << "Stream was recovered from journal, it ends at the last commit done "
+                    "before the recorded application crashed.";
+      } else {
+        LOG_INFO << "Stream doesn't need recovery.";
+      }
+      return 0;
+    }
+    if (JournaledStreamNeedsRecovery(cfg.common.player.streamPath)) {
+      LOG_WARNING << "Stream recording did not finish, or the stream is still being recorded. "
+                     "Use --recoverJournaledStream to cut it back to the last journal commit.";
+    }
+
+    const auto& transcode = cfg.common.player.transcode;
+    if (!transcode.outputDir.empty()) {
+      TranscodeStream(cfg.common.player.streamPath, transcode.outputDir,
+                      {transcode.type, transcode.level, transcode.chunkSize, transcode.threads});
+      return 0;
+    }
+
     // load function calls from a file
     player.Load(cfg.common.player.streamPath);
 #if defined WITH_DIRECTX
@@ -323,6 +347,11 @@ int MainBody(int argc, char* argv[]) {
       return 0;
     }
 
+    if (cfg.common.player.analyze.enabled) {
+      player.AnalysisPrint();
+      return 0;
+    }
+
     // register tokens executor
     if (cfg.common.player.faithfulThreading) {
       player.Register(std::make_unique<CSequentialExecutor>());
@@ -382,6 +411,9 @@ int MainBody(int argc, char* argv[]) {
     LOG_INFO << "Stalled loading: " << loadingTime / 1e6 << "ms";
     LOG_INFO << "Played back in: " << playbackTime / 1e6 << "ms";
     LOG_INFO << "Total runtime: " << programTime / 1e6 << "ms";
+    if (const uint64_t peakMemory = GetPeakMemoryUsage()) {
+      LOG_INFO << "Peak memory usage: " << peakMemory / 1048576 << "MB";
+    }
 
     if (gits::CGits::Instance().apis.HasCompute()) {
       gits::CGits::Instance().apis.IfaceCompute().PrintMaxLocalMemoryUsage();
@@ -396,6 +428,12 @@ int MainBody(int argc, char* argv[]) {
       outBench /= "benchmark.csv";
       std::ofstream timeDataFile(outBench, std::ios::binary | std::ios::out);
       CGits::Instance().TimeSheet().OutputTimeData(timeDataFile, true);
+
+      if (cfg.common.player.frameLoop.count > 0) {
+        std::ofstream loopDataFile(outBench.replace_filename("benchmarkLoop.csv"),
+                                   std::ios::binary | std::ios::out);
+        player.Scheduler().FrameLoopTimeSheet().OutputTimeData(loopDataFile, false);
+      }
     }
 
     // Close OpenGL programs zip file